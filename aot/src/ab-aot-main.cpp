@@ -0,0 +1,110 @@
+#include <Ab/Config.hpp>
+#include <Ab/Aot.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/Runtime.hpp>
+#include <Ab/VirtualMachine.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fmt/format.h>
+#include <string>
+
+const char* prog_name = nullptr;
+
+/// Default output name: the input, with it's extension replaced by .so
+///
+std::string default_output(const std::string& input) {
+	auto slash = input.rfind('/');
+	auto dot   = input.rfind('.');
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+		return input + ".so";
+	}
+	return input.substr(0, dot) + ".so";
+}
+
+/// Compile an on-disk abx module to a native shared object.
+///
+int aot_file(const std::string& input, const std::string& output, const Ab::AotConfig& config) {
+	Ab::Runtime runtime;
+	Ab::VirtualMachine vm(&runtime);
+	Ab::Context cx(&vm);
+
+	try {
+		auto module = Ab::compile(cx, input);
+		Ab::build_aot_artifact(*module, output, config);
+	} catch (const std::runtime_error& e) {
+		fmt::print(stderr, "Error compiling module: '{}'\n", input);
+		fmt::print(stderr, "Native Exception: {}\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
+
+void print_usage(FILE* out = stderr) {
+	fmt::print(
+		out, "Usage: {} [<option>...] [--] <abx> [<out>]\n"
+		     "Options:\n"
+		     "  --cc <compiler>       C compiler used to build the shared object.\n"
+		     "  --keep-source <file>  Write the generated C source to <file>.\n",
+		prog_name);
+}
+
+void print_help(FILE* out = stderr) { print_usage(out); }
+
+extern "C" int main(int argc, char* argv[]) {
+	prog_name = argv[0];
+	int i     = 1;
+
+	Ab::AotConfig config;
+
+	while (i < argc) {
+		const char* arg = argv[i];
+
+		if (strcmp(arg, "--") == 0) {
+			++i;
+			break;
+		} else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+			print_help();
+			exit(0);
+		} else if (strcmp(arg, "--cc") == 0 || strcmp(arg, "--keep-source") == 0) {
+			if (i + 1 == argc) {
+				fmt::print(stderr, "Error: missing argument to '{}'\n", arg);
+				print_usage();
+				exit(1);
+			}
+			if (strcmp(arg, "--cc") == 0) {
+				config.cc = argv[i + 1];
+			} else {
+				config.source = argv[i + 1];
+			}
+			++i;
+		} else if (arg[0] == '-') {
+			fmt::print("Error: unrecognized option: '{}'\n", arg);
+			print_usage();
+			exit(1);
+		} else {
+			break;
+		}
+
+		++i;
+	}
+
+	switch (argc - i) {
+	case 0:
+		fmt::print(stderr, "Error: missing <abx>\n");
+		exit(1);
+		break;
+	case 1:
+		return aot_file(argv[i], default_output(argv[i]), config);
+	case 2:
+		return aot_file(argv[i], argv[i + 1], config);
+	default:
+		fmt::print(stderr, "Error: unexpected argument '{}'\n", argv[i + 2]);
+		print_usage();
+		exit(1);
+		break;
+	}
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include <Ab/Config.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Opcode.hpp>
+#include <Ab/Runtime.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+#include <tuple>
+#include <vector>
+
+/// Run a function of loads from a memory64 in the interpreter, `[r+0]`, `[r+4]`, ... `[r+4n-4]`,
+/// summing the words. Run it with the checked `i32.load.a64`, which checks every access
+/// explicitly, and with `i32.load.a64.unchecked`, as if every access were proven in bounds. Report
+/// the mean time per load for several run lengths.
+///
+/// Usage: BenchBoundsCheck [<MiB>] [<loads>]
+///
+
+using namespace Ab;
+
+namespace {
+
+const std::size_t RUN_LENGTHS[] = {4, 16, 64, 256};
+
+constexpr std::size_t BATCH_SIZE = 4096;
+
+/// A module with one memory64 of `pages` pages, and the function sum (addr i64) -> i32, which sums
+/// the `run` words from addr. The address is read from r0 and r1.
+///
+absl::Span<Byte> make_sum_module(std::uint64_t pages, std::size_t run) {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{pages, pages, false, true});
+	mod.types.push_back(FuncType{{ValType::I64}, {ValType::I32}});
+
+	FuncNode& sum = push(mod.funcs);
+	sum.type_idx  = 0;
+	sum.nregs     = 4;
+	sum.push<I32LoadInsnNode>(2, 0, 0);
+	for (std::size_t i = 1; i < run; ++i) {
+		sum.push<I32LoadInsnNode>(3, 0, std::uint32_t(i * 4));
+		sum.push<I32AddInsnNode>(2, 2, 3);
+	}
+	sum.push<X32ReturnInsnNode>(2);
+	return mod.write();
+}
+
+/// Rewrite every load of sum to it's unchecked form. Every address the benchmark passes is in
+/// bounds.
+///
+void uncheck_every_load(absl::Span<Byte> body, std::size_t run) {
+	std::size_t offset = 0;
+	for (std::size_t i = 0; i < run; ++i) {
+		body[offset] = Byte(Opcode::I32_LOAD_A64_UNCHECKED);
+		offset += I32_LOAD_A64_SIZEOF + (i == 0 ? 0 : I32_ADD_SIZEOF);
+	}
+}
+
+double nanoseconds_per_load(
+	Context& cx, ModuleInst* inst, std::size_t run, std::size_t loads, std::uint64_t& sum) {
+	std::uint64_t span  = inst->memory(0)->size() - run * 4;
+	std::uint64_t state = 0x9e3779b97f4a7c15;
+	std::vector<std::tuple<std::int64_t>> args(BATCH_SIZE);
+	for (auto& arg : args) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		arg = std::int64_t((state % span) & ~std::uint64_t(3));
+	}
+	std::vector<std::tuple<std::int32_t>> results(BATCH_SIZE);
+
+	std::size_t batches = loads / (run * BATCH_SIZE) + 1;
+	auto start          = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < batches; ++i) {
+		batch_call<std::int32_t>(
+			cx, inst, 0, absl::Span<const std::tuple<std::int64_t>>(args),
+			absl::MakeSpan(results));
+		sum += std::uint32_t(std::get<0>(results[i % BATCH_SIZE]));
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() * 1e9 / double(batches * BATCH_SIZE * run);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	std::size_t mebibytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+	std::size_t loads     = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100'000'000;
+	std::uint64_t pages   = (mebibytes << 20) / LinearMemory::page_size();
+
+	Runtime runtime;
+	VirtualMachine vm(&runtime);
+	Context cx(&vm);
+
+	std::uint64_t sum = 0;
+	fmt::print("{:>8} {:>12} {:>12}\n", "run", "checked ns", "unchecked ns");
+	for (auto run : RUN_LENGTHS) {
+		ModuleInst* checked   = instantiate(cx, make_sum_module(pages, run));
+		ModuleInst* unchecked = instantiate(cx, make_sum_module(pages, run));
+		uncheck_every_load(unchecked->shared_module()->func_table()[0].body_bytes(), run);
+
+		// Touch every page up front, so page faults are not measured.
+		for (auto* inst : {checked, unchecked}) {
+			std::memset(inst->memory(0)->address(), 1, inst->memory(0)->size());
+		}
+
+		auto checked_ns   = nanoseconds_per_load(cx, checked, run, loads, sum);
+		auto unchecked_ns = nanoseconds_per_load(cx, unchecked, run, loads, sum);
+		fmt::print("{:>8} {:>12.3f} {:>12.3f}\n", run, checked_ns, unchecked_ns);
+	}
+	fmt::print("(sum {})\n", sum);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#include <Ab/Config.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// Read random words from a large linear memory, backed by regular pages, transparent huge pages,
+/// and explicit huge pages. Report the mean time per read, and the data TLB misses per read when
+/// the kernel lets us count them.
+///
+/// Explicit huge pages need a pool, for example: `echo 1024 > /proc/sys/vm/nr_hugepages`. Without
+/// one, the explicit run falls back to transparent huge pages, as shown in the "backing" column.
+///
+/// Usage: BenchLinearMemory [<MiB>] [<reads>]
+///
+
+using namespace Ab;
+
+namespace {
+
+const char* name(HugePagePolicy policy) {
+	switch (policy) {
+	case HugePagePolicy::NONE:
+		return "none";
+	case HugePagePolicy::TRANSPARENT:
+		return "transparent";
+	case HugePagePolicy::EXPLICIT:
+		return "explicit";
+	}
+	return "?";
+}
+
+/// A counter of data TLB read misses for the calling thread. Invalid if perf events are
+/// unavailable, e.g. in a container, or with a high `perf_event_paranoid`.
+///
+class TlbMissCounter {
+public:
+	TlbMissCounter() {
+		perf_event_attr attr = {};
+		attr.type            = PERF_TYPE_HW_CACHE;
+		attr.size            = sizeof(attr);
+		attr.config          = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+					  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attr.disabled        = 1;
+		attr.exclude_kernel  = 1;
+		attr.exclude_hv      = 1;
+		fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+
+	TlbMissCounter(const TlbMissCounter&) = delete;
+
+	~TlbMissCounter() {
+		if (valid()) {
+			close(fd_);
+		}
+	}
+
+	bool valid() const noexcept { return fd_ >= 0; }
+
+	void start() noexcept {
+		if (valid()) {
+			ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+
+	std::uint64_t stop() noexcept {
+		std::uint64_t count = 0;
+		if (valid()) {
+			ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+				count = 0;
+			}
+		}
+		return count;
+	}
+
+private:
+	int fd_;
+};
+
+void bench(HugePagePolicy policy, std::size_t size, std::size_t reads) {
+	LinearMemoryConfig config;
+	config.page_count_min = size / LinearMemory::page_size();
+	config.page_count_max = config.page_count_min;
+	config.huge_pages     = policy;
+	config.memory64       = size > LinearMemoryConfig::MAX_SIZE_32;
+	LinearMemory memory(config);
+
+	// Touch every page up front, so page faults are not measured.
+	std::memset(memory.address(), 1, memory.size());
+
+	auto words          = memory.size() / sizeof(std::uint64_t);
+	auto base           = to_ptr<std::uint64_t>(memory.address());
+	std::uint64_t state = 0x9e3779b97f4a7c15;
+	std::uint64_t sum   = 0;
+
+	TlbMissCounter counter;
+	counter.start();
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < reads; ++i) {
+		// xorshift64, with the previous read folded in, so reads can't be overlapped freely.
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		sum += base[(state + (sum & 1)) % words];
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	auto misses                           = counter.stop();
+
+	auto misses_per_read = counter.valid() ? fmt::format("{:.3f}", double(misses) / reads) : "n/a";
+	fmt::print(
+		"{:<12} {:<12} {:>10.2f} {:>12} (sum {})\n", name(policy), name(memory.huge_pages()),
+		elapsed.count() * 1e9 / reads, misses_per_read, sum);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	std::size_t mebibytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+	std::size_t reads     = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50'000'000;
+	std::size_t size      = mebibytes << 20;
+
+	fmt::print("{:<12} {:<12} {:>10} {:>12}\n", "policy", "backing", "ns/read", "misses/read");
+	for (auto policy :
+		 {HugePagePolicy::NONE, HugePagePolicy::TRANSPARENT, HugePagePolicy::EXPLICIT}) {
+		bench(policy, size, reads);
+	}
+	return EXIT_SUCCESS;
+}
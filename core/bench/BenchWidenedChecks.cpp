@@ -0,0 +1,130 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Opcode.hpp>
+#include <Ab/Runtime.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+#include <tuple>
+#include <vector>
+
+/// Run a function of ascending loads in the interpreter, `[r+0]`, `[r+4]`, ... `[r+4n-4]`, summing
+/// the words. Run it as loaded, where `eliminate_bounds_checks` widens the first check of each
+/// 255 byte window over the loads after it, and with the pass undone, where every load is checked.
+/// Report the mean time per load for several run lengths.
+///
+/// Usage: BenchWidenedChecks [<loads>]
+///
+
+using namespace Ab;
+
+namespace {
+
+const std::size_t RUN_LENGTHS[] = {4, 16, 64, 256};
+
+constexpr std::size_t BATCH_SIZE = 4096;
+
+/// A module with one memory of 16 pages, and the function sum (addr i32) -> i32, which sums the
+/// `run` words from addr.
+///
+absl::Span<Byte> make_sum_module(std::size_t run) {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{16, 16});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+
+	FuncNode& sum = push(mod.funcs);
+	sum.type_idx  = 0;
+	sum.nregs     = 3;
+	sum.push<I32LoadInsnNode>(1, 0, 0);
+	for (std::size_t i = 1; i < run; ++i) {
+		sum.push<I32LoadInsnNode>(2, 0, std::uint32_t(i * 4));
+		sum.push<I32AddInsnNode>(1, 1, 2);
+	}
+	sum.push<X32ReturnInsnNode>(1);
+	return mod.write();
+}
+
+/// Undo `eliminate_bounds_checks` on the body of sum, so every load is checked.
+///
+void check_every_load(absl::Span<Byte> body, std::size_t run) {
+	std::size_t offset = 0;
+	for (std::size_t i = 0; i < run; ++i) {
+		std::uint32_t immediate;
+		std::memcpy(&immediate, &body[offset + I32_LOAD_OFFSET_OFFSET], sizeof(immediate));
+		immediate &= WIDE_OFFSET_MASK;
+		std::memcpy(&body[offset + I32_LOAD_OFFSET_OFFSET], &immediate, sizeof(immediate));
+		body[offset] = Byte(Opcode::I32_LOAD);
+		offset += I32_LOAD_SIZEOF + (i == 0 ? 0 : I32_ADD_SIZEOF);
+	}
+}
+
+/// The number of loads of sum that check their bounds.
+///
+std::size_t count_checks(absl::Span<const Byte> body, std::size_t run) {
+	std::size_t count  = 0;
+	std::size_t offset = 0;
+	for (std::size_t i = 0; i < run; ++i) {
+		count += Opcode(body[offset]) != Opcode::I32_LOAD_UNCHECKED;
+		offset += I32_LOAD_SIZEOF + (i == 0 ? 0 : I32_ADD_SIZEOF);
+	}
+	return count;
+}
+
+double nanoseconds_per_load(
+	Context& cx, ModuleInst* inst, std::size_t run, std::size_t loads, std::uint64_t& sum) {
+	std::uint32_t span  = std::uint32_t(inst->memory(0)->size() - run * 4);
+	std::uint64_t state = 0x9e3779b97f4a7c15;
+	std::vector<std::tuple<std::int32_t>> args(BATCH_SIZE);
+	for (auto& arg : args) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		arg = std::int32_t((state % span) & ~std::uint64_t(3));
+	}
+	std::vector<std::tuple<std::int32_t>> results(BATCH_SIZE);
+
+	std::size_t batches = loads / (run * BATCH_SIZE) + 1;
+	auto start          = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < batches; ++i) {
+		batch_call<std::int32_t>(
+			cx, inst, 0, absl::Span<const std::tuple<std::int32_t>>(args),
+			absl::MakeSpan(results));
+		sum += std::uint32_t(std::get<0>(results[i % BATCH_SIZE]));
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() * 1e9 / double(batches * BATCH_SIZE * run);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	std::size_t loads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+
+	Runtime runtime;
+	VirtualMachine vm(&runtime);
+	Context cx(&vm);
+
+	std::uint64_t sum = 0;
+	fmt::print(
+		"{:>8} {:>10} {:>12} {:>10} {:>12}\n", "run", "checks", "checked ns", "checks",
+		"widened ns");
+	for (auto run : RUN_LENGTHS) {
+		ModuleInst* checked = instantiate(cx, make_sum_module(run));
+		ModuleInst* widened = instantiate(cx, make_sum_module(run));
+		auto checked_body   = checked->shared_module()->func_table()[0].body_bytes();
+		auto widened_body   = widened->shared_module()->func_table()[0].body_bytes();
+		check_every_load(checked_body, run);
+
+		auto checked_ns = nanoseconds_per_load(cx, checked, run, loads, sum);
+		auto widened_ns = nanoseconds_per_load(cx, widened, run, loads, sum);
+		fmt::print(
+			"{:>8} {:>10} {:>12.3f} {:>10} {:>12.3f}\n", run, count_checks(checked_body, run),
+			checked_ns, count_checks(widened_body, run), widened_ns);
+	}
+	fmt::print("(sum {})\n", sum);
+	return EXIT_SUCCESS;
+}
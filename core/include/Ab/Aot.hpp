@@ -0,0 +1,83 @@
+#ifndef AB_AOT_HPP_
+#define AB_AOT_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Context.hpp>
+#include <Ab/Module.hpp>
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Ab {
+
+/// Ahead-of-time compilation.
+///
+/// An AOT artifact is an ELF shared object, produced by `ab aot`. The artifact carries a copy of
+/// the abx module it was built from, plus a table of native entry points, one per function in the
+/// module. Loading an artifact is a single dlopen: the embedded module is decoded as normal, and
+/// each function is bound to it's native code. Nothing is compiled at runtime.
+///
+/// A function with an instruction that has no native translation has a null entry, and is
+/// interpreted. Translated and interpreted functions call each other freely.
+///
+/// Every native entry point follows the NativeFn contract, which is the same ABI used by
+/// static_call to enter the interpreter.
+
+class AotError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/// Version of the artifact ABI. Artifacts with a different version are rejected at load time.
+///
+constexpr unsigned int AOT_ABI_VERSION = 2;
+
+/// Symbols exported by an AOT artifact.
+///
+constexpr const char* const AOT_ABI_VERSION_SYMBOL = "ab_aot_abi_version";
+constexpr const char* const AOT_MODULE_SYMBOL      = "ab_aot_module";
+constexpr const char* const AOT_MODULE_SIZE_SYMBOL = "ab_aot_module_size";
+constexpr const char* const AOT_FUNCS_SYMBOL       = "ab_aot_funcs";
+constexpr const char* const AOT_FUNC_COUNT_SYMBOL  = "ab_aot_func_count";
+
+/// Runtime entry points used by an artifact, filled in when it is loaded.
+///
+constexpr const char* const AOT_CALL_SYMBOL      = "ab_aot_call";
+constexpr const char* const AOT_IN_BOUNDS_SYMBOL = "ab_aot_in_bounds";
+
+struct AotConfig {
+	/// The C compiler used to build the shared object.
+	std::string cc = "cc";
+
+	/// Extra flags passed to the C compiler.
+	std::vector<std::string> cflags = {"-O2"};
+
+	/// When set, the generated C source is written here and kept.
+	/// Otherwise, the source is written to a temporary file and removed after the build.
+	std::string source;
+};
+
+/// Translate a compiled module to C source for an AOT artifact.
+/// Functions containing an instruction with no native translation are left to the interpreter.
+///
+void write_aot_source(std::ostream& out, const Module& module);
+
+/// Translate a module to native code, and link it into a shared object at `output`.
+///
+void build_aot_artifact(const Module& module, const std::string& output, const AotConfig& config);
+
+/// True if the file looks like an AOT artifact, ie, it's an ELF object.
+///
+bool is_aot_artifact(const std::string& filename);
+
+/// Load an AOT artifact, and produce a module whose functions are bound to native code.
+///
+/// The shared object is never unloaded: the module's bytes and code live in the artifact.
+///
+std::shared_ptr<Module> load_aot_artifact(Context& cx, const std::string& filename);
+
+}  // namespace Ab
+
+#endif  // AB_AOT_HPP_
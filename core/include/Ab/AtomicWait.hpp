@@ -0,0 +1,30 @@
+#ifndef AB_ATOMICWAIT_HPP_
+#define AB_ATOMICWAIT_HPP_
+
+#include <Ab/Config.hpp>
+#include <cstdint>
+
+namespace Ab {
+
+/// The result of memory.atomic.wait, as seen by the program.
+///
+enum class WaitResult : std::uint32_t { OK = 0, NOT_EQUAL = 1, TIMED_OUT = 2 };
+
+/// Block until notified, if the value at `address` equals `expected`.
+///
+/// Waiters are queued in a process-wide table keyed by address, so a waiter may be woken by a
+/// notify from any thread. Each waiter sleeps on a futex of it's own, see Synchronic. A negative
+/// timeout, in nanoseconds, never expires.
+///
+WaitResult atomic_wait(std::uint32_t* address, std::uint32_t expected, std::int64_t timeout);
+
+WaitResult atomic_wait(std::uint64_t* address, std::uint64_t expected, std::int64_t timeout);
+
+/// Wake up to `count` threads waiting on `address`, in the order they began waiting.
+/// @returns the number of threads woken.
+///
+std::uint32_t atomic_notify(const void* address, std::uint32_t count);
+
+}  // namespace Ab
+
+#endif  // AB_ATOMICWAIT_HPP_
@@ -0,0 +1,58 @@
+#ifndef AB_BOUNDSCHECK_HPP_
+#define AB_BOUNDSCHECK_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Bytes.hpp>
+#include <absl/types/span.h>
+#include <cstddef>
+
+namespace Ab {
+
+class Module;
+
+/// Rewrite the loads and stores of a function body that are proven in bounds to their unchecked
+/// forms. Returns the number of unchecked accesses.
+///
+/// An access is proven in bounds by an earlier, checked access that:
+///  - is off the same address register, to the same memory, in the same address width,
+///  - ends at or after the later access, counting it's constant offset and width,
+///  - comes before the later access with no branch target in between, so it runs on every path,
+///  - and is not followed by a write to any slot of the address register, or a call, before the
+///    later access. A 64-bit write to a register also writes the next one, and a 64-bit address
+///    is read from two registers.
+///
+/// Over a straight-line run, the check of a memory-0 load is widened to cover the later accesses
+/// off it's address, so `[r+0]`, `[r+4]`, `[r+8]` is checked once, for 12 bytes. The run ends at
+/// a store, a call, a branch or it's target, or any instruction with an effect beyond it's
+/// registers, such as a global write. Only loads and pure instructions run between a widened check
+/// and the accesses it covers, so trapping at the check can't be told apart from trapping later.
+/// A check covers at most 255 bytes, of a load whose offset fits in 24 bits. Memories only shrink
+/// while idle, so a proven access stays in bounds.
+///
+/// The unchecked and widened opcodes have the layout of their checked forms, so a body is
+/// rewritten in place, and rewriting a body twice changes nothing. A widened load is rewritten to
+/// it's plain form before it is widened again. An unchecked access that the pass can't prove is
+/// rewritten to it's checked form, so a module can't skip a check by using the unchecked opcode
+/// itself. Every instruction of the body must be decoded for that to hold, so a body with an
+/// unknown opcode, a truncated instruction, or a branch outside the body or into the middle of an
+/// instruction, is rejected.
+///
+/// @throws DecodeError if the body can't be fully decoded.
+///
+std::size_t eliminate_bounds_checks(absl::Span<Byte> body);
+
+/// Eliminate the bounds checks of every function in a module. Returns the number of unchecked
+/// accesses.
+///
+/// Every instruction is decoded anyway, so the immediates that index into the module are validated
+/// here too. The interpreter trusts them. A global must exist, be accessed with the width of it's
+/// type, and be mutable to be set. Call targets, `call_indirect` types, and data segments must
+/// exist.
+///
+/// @throws DecodeError if any function body can't be fully decoded, or has an invalid immediate.
+///
+std::size_t eliminate_bounds_checks(Module& module);
+
+}  // namespace Ab
+
+#endif  // AB_BOUNDSCHECK_HPP_
@@ -3,9 +3,13 @@
 
 #include <Ab/Config.hpp>
 #include <Ab/Address.hpp>
+#include <Ab/Assert.hpp>
+#include <Ab/TypeRegistry.hpp>
 #include <Ab/Types.hpp>
 #include <absl/types/span.h>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -13,18 +17,95 @@ namespace Ab {
 
 class Func;
 class FuncInst;
+class LinearMemory;
+struct ExecState;
 
-struct FuncRef {};
+/// Native entry point for a function.
+///
+/// Follows the same contract as `enter_interpreter`: the arguments have been written into the
+/// register window `regs` by the caller, and the result is a pointer to the register holding the
+/// return value, or nullptr when there is nothing to return.
+///
+using NativeFn = Byte* (*)(ExecState* state, Byte* regs);
+
+/// Primitive entry point for a host function, called by `call_primitive`.
+///
+/// The arguments are read from the register window `regs`, and the results are written back over
+/// them, starting at the first register. See HostFunc.hpp for typed trampolines.
+///
+using PrimitiveFn = void (*)(ExecState* state, Byte* regs);
+
+/// A slot in a table: a function, and the canonical id of it's type. An empty slot holds null,
+/// with the null type id. Slots are 16 bytes, so `call_indirect` reads one in a single load.
+///
+struct alignas(16) FuncRef {
+	FuncInst* func = nullptr;
+	TypeId type_id = NULL_TYPE_ID;
+};
+
+static_assert(sizeof(FuncRef) == 16);
 
 struct InterModuleFuncRef {};
 
 struct IntraModuleFuncRef {};
 
-struct RefTable {};
+/// A table of function references, held in one contiguous array of slots.
+///
+class RefTable {
+public:
+	explicit RefTable(std::size_t size = 0) : refs_(size) {}
+
+	/// The number of slots in the table.
+	///
+	std::size_t size() const noexcept { return refs_.size(); }
+
+	FuncRef* data() noexcept { return refs_.data(); }
+
+	const FuncRef* data() const noexcept { return refs_.data(); }
+
+	FuncRef& operator[](std::size_t index) noexcept {
+		AB_ASSERT(index < refs_.size());
+		return refs_[index];
+	}
+
+	const FuncRef& operator[](std::size_t index) const noexcept {
+		AB_ASSERT(index < refs_.size());
+		return refs_[index];
+	}
+
+	/// Empty every slot.
+	///
+	void clear() noexcept { std::fill(refs_.begin(), refs_.end(), FuncRef()); }
+
+private:
+	std::vector<FuncRef> refs_;
+};
 
 /// Instantiated and fully resolved set of constants.
 ///
+/// A pool is owned by a module instance, and shared by all of it's functions. Each function holds
+/// a pointer to the pool, so the constants are one load away from the interpreter's `fn`.
+///
 struct ConstPool {
+	/// The instance's globals, one 8-byte slot each. The pool is constant, the globals are not.
+	std::uint64_t* globals = nullptr;
+
+	/// The instance's passive data segments. A dropped segment is empty.
+	absl::Span<const Byte>* data = nullptr;
+
+	/// The instance's memory 0, or null if the instance has no memory. The common single-memory
+	/// case reaches it's memory in one load.
+	LinearMemory* memory = nullptr;
+
+	/// Every memory of the instance, in memory index order.
+	absl::Span<LinearMemory* const> memories;
+
+	/// Every table of the instance, in table index order.
+	absl::Span<RefTable> tables;
+
+	/// The canonical id of each of the module's types, by type index.
+	const TypeId* type_ids = nullptr;
+
 	std::vector<FuncInst*> func_table;
 	std::vector<float> f32_table;
 	std::vector<double> f64_table;
@@ -35,13 +116,15 @@ struct ConstPool {
 ///
 class Func {
 public:
-	Func(const FuncType* type, Byte* body, std::size_t var_nregs) noexcept
+	Func(const FuncType* type, absl::Span<Byte> body, std::size_t var_nregs) noexcept
 		: type_(type)
 		, var_nregs_(var_nregs)
 		, arg_nregs_(type->arg_nregs())
 		, ret_nregs_(type->ret_nregs())
 		, nregs_(var_nregs_ + arg_nregs_)
-		, body_(body, std::size_t(0)) {}
+		, body_(body)
+		, native_(nullptr)
+		, primitive_(nullptr) {}
 
 	/// Pointer to the underlying type of the function.
 	///
@@ -71,6 +154,32 @@ public:
 	///
 	Byte* body() const noexcept { return body_.data(); }
 
+	/// The size of the function body, in bytes.
+	///
+	std::size_t body_size() const noexcept { return body_.size(); }
+
+	/// The function body, as a span of bytes.
+	///
+	absl::Span<Byte> body_bytes() const noexcept { return body_; }
+
+	/// Native code for this function, or nullptr if the function must be interpreted.
+	///
+	NativeFn native() const noexcept { return native_; }
+
+	Func& native(NativeFn fn) noexcept {
+		native_ = fn;
+		return *this;
+	}
+
+	/// Primitive entry point, or nullptr if the function can not be a `call_primitive` target.
+	///
+	PrimitiveFn primitive() const noexcept { return primitive_; }
+
+	Func& primitive(PrimitiveFn fn) noexcept {
+		primitive_ = fn;
+		return *this;
+	}
+
 private:
 	const FuncType* type_;
 	std::uint32_t var_nregs_;
@@ -78,38 +187,30 @@ private:
 	std::uint32_t ret_nregs_;
 	std::uint32_t nregs_;
 	absl::Span<Byte> body_;
+	NativeFn native_;
+	PrimitiveFn primitive_;
 };
 
 /// An instantiated function.
 /// The runtime data associated with a function.
 ///
-class FuncInst {
+/// A FuncInst is the hot half of a function: exactly what a call needs, packed into 32 bytes and
+/// aligned so it never straddles a cache line. A module instance keeps it's FuncInsts in one dense
+/// array, indexed by function index. Everything else, the type, the native entry points and the
+/// body's extent, is cold, and stays in the shared Func.
+///
+class alignas(32) FuncInst {
 public:
-	FuncInst(Func* base) noexcept
+	FuncInst(const Func* base, const ConstPool* const_pool = nullptr) noexcept
 		: base_(base)
-		, arg_nregs_(base->arg_nregs())
-		, ret_nregs_(base->ret_nregs())
-		, var_nregs_(base->var_nregs())
+		, const_pool_(const_pool)
+		, body_(base->native() == nullptr ? base->body() : nullptr)
 		, nregs_(base->nregs())
-		, body_(base->body()) {}
-
-	FuncInst(Func* base, const ConstPool& const_pool) noexcept
-		: base_(base)
-		, arg_nregs_(base->arg_nregs())
-		, ret_nregs_(base->ret_nregs())
-		, var_nregs_(base->var_nregs())
-		, nregs_(base->nregs())
-		, body_(base->body())
-		, const_pool_(const_pool) {}
-
-	FuncInst(Func* base, ConstPool&& const_pool) noexcept
-		: base_(base)
-		, arg_nregs_(base->arg_nregs())
-		, ret_nregs_(base->ret_nregs())
-		, var_nregs_(base->var_nregs())
-		, nregs_(base->nregs())
-		, body_(base->body())
-		, const_pool_(std::move(const_pool)) {}
+		, arg_nregs_(std::uint16_t(base->arg_nregs()))
+		, ret_nregs_(std::uint16_t(base->ret_nregs())) {
+		AB_ASSERT(base->arg_nregs() <= UINT16_MAX);
+		AB_ASSERT(base->ret_nregs() <= UINT16_MAX);
+	}
 
 	/// Pointer to the underlying function data, which is shared across instances.
 	///
@@ -129,7 +230,7 @@ public:
 
 	/// Number of local x32 registers in function, for use as temporaries.
 	///
-	std::uint32_t var_nregs() const noexcept { return var_nregs_; }
+	std::uint32_t var_nregs() const noexcept { return nregs_ - arg_nregs_; }
 
 	/// Total number of registers in function frame, arg + var register count.
 	///
@@ -139,44 +240,136 @@ public:
 	///
 	std::uint32_t nreg_bytes() const noexcept { return nregs_ * 4; }
 
-	/// Pointer to the beginning of the function bytecodes.
+	/// Pointer to the beginning of the function bytecodes, or nullptr if the function is native.
 	///
 	Byte* body() const noexcept { return body_; }
 
-	ConstPool& const_pool() noexcept { return const_pool_; }
+	/// True if the function has native code, and must not be interpreted.
+	///
+	bool is_native() const noexcept { return body_ == nullptr; }
+
+	/// Native entry point, or nullptr if the function is interpreted.
+	///
+	NativeFn native() const noexcept { return base_->native(); }
 
-	const ConstPool& const_pool() const noexcept { return const_pool_; }
+	/// Primitive entry point, or nullptr.
+	///
+	PrimitiveFn primitive() const noexcept { return base_->primitive(); }
 
+	/// The constants of the function's module instance. Null for host functions.
+	///
+	const ConstPool* const_pool() const noexcept { return const_pool_; }
+
+	FuncInst& const_pool(const ConstPool* const_pool) noexcept {
+		const_pool_ = const_pool;
+		return *this;
+	}
+
+	/// The nth function of the module's function index space. Unchecked: call targets are
+	/// validated when the module is loaded.
+	///
 	FuncInst* func_const(std::size_t index) const noexcept {
-		return const_pool_.func_table[index];
+		return const_pool_->func_table[index];
 	}
 
-private:
-	/// Pointer into the shared func object
+	/// The nth data segment of the function's module instance. Unchecked: the index is validated
+	/// when the module is loaded.
 	///
-	const Func* base_;
+	absl::Span<const Byte>& data_segment(std::size_t index) const noexcept {
+		return const_pool_->data[index];
+	}
 
-	/// Number of registers initialized with arguments. Cached for locality.
+	/// Memory 0 of the function's module instance, or null.
 	///
-	std::uint32_t arg_nregs_;
+	LinearMemory* memory() const noexcept { return const_pool_->memory; }
 
-	/// Number of registers taken by return result. Cached for locality.
+	/// The nth memory of the function's module instance, or null if there is no such memory.
 	///
-	std::uint32_t ret_nregs_;
+	LinearMemory* memory(std::size_t index) const noexcept {
+		auto memories = const_pool_->memories;
+		return index < memories.size() ? memories[index] : nullptr;
+	}
 
-	/// Number of registers dedicated to local variables. Cached for locality.
+	/// The nth table of the function's module instance, or null if there is no such table.
 	///
-	std::uint32_t var_nregs_;
+	RefTable* table(std::size_t index) const noexcept {
+		auto tables = const_pool_->tables;
+		return index < tables.size() ? &tables[index] : nullptr;
+	}
+
+	/// The canonical id of the nth type of the function's module. Unchecked: the index is
+	/// validated when the module is loaded.
+	///
+	TypeId type_id(std::size_t index) const noexcept { return const_pool_->type_ids[index]; }
+
+	/// The slot of the nth global of the function's module instance. Unchecked: the index is
+	/// validated when the module is loaded, see `eliminate_bounds_checks`.
+	///
+	std::uint64_t* global_slot(std::size_t index) const noexcept {
+		return const_pool_->globals + index;
+	}
+
+private:
+	/// Pointer into the shared func object, which holds the cold data.
+	///
+	const Func* base_;
+
+	/// Shared constants of the module instance.
+	///
+	const ConstPool* const_pool_;
+
+	/// Pointer into the code section, after the declaration of the registers. Null if the function
+	/// is native, so a call can pick the path without touching the cold data.
+	///
+	Byte* body_;
 
 	/// Total number of local registers, nargs + nvars; Cached for locality.
 	///
 	std::uint32_t nregs_;
 
-	/// Pointer into the code section, after the declaration of the registers.
+	/// Number of registers initialized with arguments. Cached for locality.
 	///
-	Byte* body_;
+	std::uint16_t arg_nregs_;
+
+	/// Number of registers taken by return result. Cached for locality.
+	///
+	std::uint16_t ret_nregs_;
+};
+
+static_assert(sizeof(FuncInst) == 32);
+
+/// A function implemented by the host, with it's type and instance.
+///
+/// A host function is a FuncInst, like any other. It can be defined in a resolver, bound to a
+/// module's imports, and called from the interpreter with `call` or `call_primitive`. See
+/// HostFunc.hpp for binding a C++ function to typed entry points.
+///
+class HostFunc {
+public:
+	HostFunc(FuncType&& type, NativeFn native, PrimitiveFn primitive)
+		: type_(std::move(type)), func_(bind(&type_, native, primitive)), inst_(&func_) {}
+
+	HostFunc(const HostFunc&) = delete;
+
+	HostFunc& operator=(const HostFunc&) = delete;
+
+	const FuncType& type() const noexcept { return type_; }
+
+	FuncInst* inst() noexcept { return &inst_; }
+
+	const FuncInst* inst() const noexcept { return &inst_; }
+
+private:
+	static Func bind(const FuncType* type, NativeFn native, PrimitiveFn primitive) noexcept {
+		Func func(type, absl::Span<Byte>(), 0);
+		func.native(native);
+		func.primitive(primitive);
+		return func;
+	}
 
-	ConstPool const_pool_;
+	FuncType type_;
+	Func func_;
+	FuncInst inst_;
 };
 
 }  // namespace Ab
@@ -0,0 +1,123 @@
+#ifndef AB_HOSTFUNC_HPP_
+#define AB_HOSTFUNC_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Func.hpp>
+#include <Ab/Types.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Ab {
+
+/// The signature of a host function, given as a function pointer type.
+///
+/// A host function takes and returns VM types: `std::int32_t`, `std::int64_t`, their unsigned
+/// equivalents, `float` and `double`. It may return nothing. It may also take the calling
+/// thread's `ExecState*` as it's first parameter, to inspect memory or raise a trap.
+///
+template <typename F>
+struct HostSignature;
+
+template <typename R, typename... As>
+struct HostSignature<R (*)(As...)> {
+	using Result = R;
+
+	static FuncType type() {
+		if constexpr (std::is_void_v<R>) {
+			return FuncType{{to_val_type_v<As>...}, {}};
+		} else {
+			return FuncType{{to_val_type_v<As>...}, {to_val_type_v<R>}};
+		}
+	}
+
+	/// Read the arguments out of the register window, and invoke F.
+	///
+	template <auto F>
+	static R call(ExecState*, Byte* regs) {
+		return std::apply([](As... as) { return F(as...); }, get_stack_elements<As...>(regs));
+	}
+};
+
+template <typename R, typename... As>
+struct HostSignature<R (*)(ExecState*, As...)> {
+	using Result = R;
+
+	static FuncType type() {
+		if constexpr (std::is_void_v<R>) {
+			return FuncType{{to_val_type_v<As>...}, {}};
+		} else {
+			return FuncType{{to_val_type_v<As>...}, {to_val_type_v<R>}};
+		}
+	}
+
+	template <auto F>
+	static R call(ExecState* state, Byte* regs) {
+		return std::apply(
+			[state](As... as) { return F(state, as...); }, get_stack_elements<As...>(regs));
+	}
+};
+
+/// Typed primitive trampoline for the host function F.
+///
+/// The trampoline is generated per function at compile time. Arguments are loaded straight from
+/// the register window, and the result is stored straight back, with no boxing.
+///
+template <auto F>
+void primitive_trampoline(ExecState* state, Byte* regs) {
+	using Signature = HostSignature<decltype(F)>;
+	using Result    = typename Signature::Result;
+
+	if constexpr (std::is_void_v<Result>) {
+		Signature::template call<F>(state, regs);
+	} else {
+		set_stack_element<Result>(regs, Signature::template call<F>(state, regs));
+	}
+}
+
+/// Typed native trampoline for the host function F, used when F is the target of a `call`, or is
+/// called with `static_call`.
+///
+template <auto F>
+Byte* native_trampoline(ExecState* state, Byte* regs) {
+	primitive_trampoline<F>(state, regs);
+	if constexpr (std::is_void_v<typename HostSignature<decltype(F)>::Result>) {
+		return nullptr;
+	} else {
+		return regs;
+	}
+}
+
+/// Create a standalone host function for F.
+///
+template <auto F>
+std::unique_ptr<HostFunc> make_host_func() {
+	return std::make_unique<HostFunc>(
+		HostSignature<decltype(F)>::type(), &native_trampoline<F>, &primitive_trampoline<F>);
+}
+
+/// Register the host function F with a VM, as `module.symbol`. The host function is owned by the
+/// VM. Modules instantiated into the VM afterwards may import it.
+///
+/// Example:
+///   ```
+///   std::int32_t add(std::int32_t x, std::int32_t y) { return x + y; }
+///   define_host<&add>(vm, "env", "add");
+///   ```
+///
+/// @returns the host function's instance.
+///
+template <auto F>
+FuncInst* define_host(VirtualMachine& vm, std::string_view module, std::string_view symbol) {
+	FuncInst* inst = vm.new_host_func(
+		HostSignature<decltype(F)>::type(), &native_trampoline<F>, &primitive_trampoline<F>);
+	vm.resolver().define(module, symbol, inst);
+	return inst;
+}
+
+}  // namespace Ab
+
+#endif  // AB_HOSTFUNC_HPP_
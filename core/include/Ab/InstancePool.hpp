@@ -0,0 +1,131 @@
+#ifndef AB_INSTANCEPOOL_HPP_
+#define AB_INSTANCEPOOL_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/Module.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Ab {
+
+/// A module instance with private memories, handed out by an InstancePool.
+///
+class PooledInstance {
+public:
+	PooledInstance(const ModuleInst& prototype, const MemorySnapshots& snapshots)
+		: prototype_(&prototype), inst_(prototype, snapshots) {}
+
+	ModuleInst* inst() noexcept { return &inst_; }
+
+	/// The instance's memory 0. The instance must have a memory.
+	///
+	LinearMemory& memory() noexcept { return *inst_.memory(0); }
+
+	/// Return the instance to it's initial state.
+	///
+	void reset() {
+		for (std::size_t i = 0; i < inst_.memory_count(); ++i) {
+			inst_.memory(i)->reset();
+		}
+		inst_.restore(*prototype_);
+	}
+
+private:
+	const ModuleInst* prototype_;
+	ModuleInst inst_;
+};
+
+/// A pool of pre-initialized module instances, for running each request in a fresh instance.
+///
+/// The pool captures a prototype instance once: the function table, globals and data segments
+/// are copied, and each of the prototype's memories is snapshotted into a sealed file. New
+/// instances map the snapshots copy-on-write, so creating one costs a table copy and an mmap per
+/// memory, not a replay of the module's initialization. Released instances are reset by
+/// discarding their dirty pages, and are reused by the next acquire.
+///
+/// Example:
+///   ```
+///   InstancePool pool(prototype);
+///   auto lease = pool.acquire();
+///   static_call<std::int32_t>(cx, lease->inst(), 0);
+///   ```
+///
+/// Thread safe. Each lease must only be used by one thread at a time.
+///
+class InstancePool {
+public:
+	/// Returns a leased instance to it's pool.
+	///
+	class Releaser {
+	public:
+		Releaser() noexcept : pool_(nullptr) {}
+
+		explicit Releaser(InstancePool* pool) noexcept : pool_(pool) {}
+
+		void operator()(PooledInstance* inst) const { pool_->release(inst); }
+
+	private:
+		InstancePool* pool_;
+	};
+
+	/// A pooled instance, which goes back to the pool when the lease is dropped.
+	///
+	using Lease = std::unique_ptr<PooledInstance, Releaser>;
+
+	/// The default number of idle instances held by the pool.
+	///
+	static constexpr std::size_t DEFAULT_CAPACITY = 16;
+
+	/// Capture a prototype instance and it's initialized memories. The memories are snapshotted
+	/// immediately, so later writes to them are not seen by pooled instances.
+	///
+	explicit InstancePool(const ModuleInst& prototype, std::size_t capacity = DEFAULT_CAPACITY);
+
+	InstancePool(const InstancePool&) = delete;
+
+	/// All leases must be returned before the pool is destroyed.
+	///
+	~InstancePool() noexcept;
+
+	InstancePool& operator=(const InstancePool&) = delete;
+
+	/// Take an instance from the pool, creating one if the pool is empty.
+	///
+	Lease acquire();
+
+	/// Create instances until `count` are idle in the pool.
+	///
+	void prewarm(std::size_t count);
+
+	/// The number of idle instances held by the pool.
+	///
+	std::size_t idle_count() const noexcept;
+
+	/// The number of outstanding leases.
+	///
+	std::size_t lease_count() const noexcept;
+
+	/// The snapshots of the prototype's memories, in memory index order.
+	///
+	const MemorySnapshots& snapshots() const noexcept { return snapshots_; }
+
+private:
+	std::unique_ptr<PooledInstance> make_instance() const;
+
+	void release(PooledInstance* inst);
+
+	const MemorySnapshots snapshots_;
+	const ModuleInst prototype_;
+	const std::size_t capacity_;
+
+	mutable std::mutex lock_;
+	std::vector<std::unique_ptr<PooledInstance>> idle_;
+	std::size_t lease_count_ = 0;
+};
+
+}  // namespace Ab
+
+#endif  // AB_INSTANCEPOOL_HPP_
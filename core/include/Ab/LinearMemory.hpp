@@ -7,7 +7,11 @@
 #include <Ab/Bytes.hpp>
 #include <Ab/Page.hpp>
 #include <Ab/Result.hpp>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace Ab {
 
@@ -15,25 +19,148 @@ class LinearMemoryError : public std::runtime_error {
 	using std::runtime_error::runtime_error;
 };
 
+/// How a linear memory is backed by huge pages. Huge pages map more memory per TLB entry, which
+/// cuts TLB misses in programs that access a large memory at random.
+///
+enum class HugePagePolicy {
+	/// Regular pages only.
+	NONE,
+
+	/// Ask the kernel for transparent huge pages. The memory is aligned to huge pages, and the
+	/// kernel backs it with huge pages when it can, and with regular pages when it can't.
+	TRANSPARENT,
+
+	/// Back the memory with huge pages reserved from the kernel's huge page pool. The whole
+	/// reservation is taken up front. Falls back to TRANSPARENT if the pool is too small, or if
+	/// the memory is created from a snapshot.
+	EXPLICIT,
+};
+
+/// Where a linear memory's pages are placed on a NUMA system.
+///
+enum class NumaPolicy {
+	/// Leave placement to the kernel.
+	NONE,
+
+	/// Place pages on the NUMA node of the thread using the memory. A memory starts on the node
+	/// of the thread that creates it. An unshared memory held by a pooled instance follows the
+	/// lease, and it's pages are migrated when a thread on another node acquires it. A shared
+	/// memory stays on the node it was created on.
+	LOCAL,
+};
+
+/// How pages released from a linear memory are returned to the system.
+///
+enum class PageRelease {
+	/// Free the pages at once, with `MADV_DONTNEED`. The memory's resident size drops immediately.
+	IMMEDIATE,
+
+	/// Let the kernel reclaim the pages when it runs short of memory, with `MADV_FREE`. Cheaper
+	/// than an immediate release when memory is plentiful. Falls back to an immediate release
+	/// where unsupported.
+	LAZY,
+};
+
 struct LinearMemoryConfig {
 	MutAddress address         = nullptr;
 	std::size_t page_count_min = 1;
 	std::size_t page_count_max = 4;
 
+	/// A shared memory may be accessed by many threads at once, and is the only kind of memory
+	/// that supports atomic waits.
+	bool shared = false;
+
+	HugePagePolicy huge_pages = HugePagePolicy::NONE;
+
+	NumaPolicy numa = NumaPolicy::NONE;
+
+	/// A memory64 memory is addressed with 64-bit addresses, and may grow past 4 GiB. Other
+	/// memories are addressed with 32-bit addresses, and are limited to 4 GiB.
+	bool memory64 = false;
+
+	/// The largest size of a memory with 32-bit addresses.
+	static constexpr std::uint64_t MAX_SIZE_32 = std::uint64_t(1) << 32;
+
+	/// The largest size of a memory64 memory. Memories are reserved up front, and no machine
+	/// addresses more than 2^48 bytes.
+	static constexpr std::uint64_t MAX_SIZE_64 = std::uint64_t(1) << 48;
+
+	/// The largest page count of a memory, so the byte size of any valid limit can't overflow.
+	///
+	static std::uint64_t max_page_count(bool memory64) noexcept {
+		return (memory64 ? MAX_SIZE_64 : MAX_SIZE_32) / Page::size();
+	}
+
 	void verify() const {
 		if (page_count_max < page_count_min) {
 			throw LinearMemoryError(
 				"LinearMemoryConfig validation error: minPageCount greater than "
 				"max");
 		}
+		if (!memory64 && page_count_max > max_page_count(false)) {
+			throw LinearMemoryError(
+				"LinearMemoryConfig validation error: a 32-bit memory can't exceed 4 GiB");
+		}
+		if (memory64 && page_count_max > max_page_count(true)) {
+			throw LinearMemoryError(
+				"LinearMemoryConfig validation error: a memory64 can't exceed 256 TiB");
+		}
 	}
 };
 
+class LinearMemory;
+
+/// An immutable image of a linear memory's contents, held in an anonymous, sealed file.
+///
+/// Memories created from a snapshot map the file copy-on-write, so a new memory costs a single
+/// mmap, and only the pages a program writes are ever copied. Any number of memories may share a
+/// snapshot.
+///
+class MemorySnapshot {
+public:
+	/// Copy the active pages of a memory into a new snapshot.
+	///
+	static std::shared_ptr<const MemorySnapshot> capture(const LinearMemory& memory);
+
+	MemorySnapshot(const MemorySnapshot&) = delete;
+
+	~MemorySnapshot() noexcept;
+
+	MemorySnapshot& operator=(const MemorySnapshot&) = delete;
+
+	/// The file descriptor of the backing file.
+	///
+	int fd() const noexcept { return fd_; }
+
+	/// The number of pages held in the snapshot.
+	///
+	std::size_t page_count() const noexcept { return page_count_; }
+
+	/// The size of the snapshot, in bytes.
+	///
+	std::size_t size() const noexcept;
+
+private:
+	MemorySnapshot(int fd, std::size_t page_count) noexcept : fd_(fd), page_count_(page_count) {}
+
+	int fd_;
+	std::size_t page_count_;
+};
+
+/// The snapshots of every memory in a module instance, in memory index order.
+///
+using MemorySnapshots = std::vector<std::shared_ptr<const MemorySnapshot>>;
+
 /// The contiguous memory subsystem.
 ///
 /// web assembly gives programs low level access to a contiguous region of memory.
-/// The LinearMemory class manages that giant blob of memory. Per the spec, LinearMemory can be
-/// grown, but does not shrink.
+/// The LinearMemory class manages that giant blob of memory. Per the spec, programs can grow a
+/// LinearMemory, but not shrink it. Hosts may shrink it, to reclaim memory from an idle instance.
+///
+/// The full range of `page_count_max` pages is reserved up front, and growing only changes page
+/// permissions. The memory never moves, so growing is safe while other threads are accessing the
+/// memory. Concurrent grows are serialized, and the new size is published after the pages are
+/// accessible.
 ///
 class LinearMemory {
 public:
@@ -45,15 +172,22 @@ public:
 	LinearMemory(const LinearMemoryConfig& config)
 		: address_(nullptr), page_count_(0), config_(config) {
 		config_.verify();
-		address_ = reserve(config.address, config.page_count_max);
+		reserve(config_.huge_pages);
 		grow(config.page_count_min);
 	}
 
+	/// Bring up a memory whose initial contents are a copy-on-write view of a snapshot. The memory
+	/// starts with at least as many pages as the snapshot.
+	///
+	LinearMemory(const LinearMemoryConfig& config, std::shared_ptr<const MemorySnapshot> snapshot);
+
 	/// Bring up the memory subsystem with the default config.
 	///
 	LinearMemory() : LinearMemory(LinearMemoryConfig()) {}
 
-	~LinearMemory() { release(address_, max_size()); }
+	LinearMemory(const LinearMemory&) = delete;
+
+	~LinearMemory() { Page::unmap(address_, reserved_size_); }
 
 	/// The address.
 
@@ -62,59 +196,191 @@ public:
 
 	/// The size of the currently allocated memory.
 	///
-	std::size_t size() const noexcept { return page_count_ * page_size(); }
+	std::size_t size() const noexcept {
+		return page_count_.load(std::memory_order_acquire) * page_size();
+	}
+
+	/// The number of currently allocated pages.
+	///
+	std::size_t page_count() const noexcept { return page_count_.load(std::memory_order_acquire); }
+
+	/// True if this memory may be shared between threads.
+	///
+	bool shared() const noexcept { return config_.shared; }
+
+	/// True if this memory is addressed with 64-bit addresses.
+	///
+	bool memory64() const noexcept { return config_.memory64; }
 
 	/// The maximum size the memory can grow to.
 	///
 	std::size_t max_size() const noexcept { return config_.page_count_max; }
 
-	/// Grow the memory by n pages.
+	/// The number of times the memory has changed size. An interpreter caches the size of the
+	/// memory it is running against, and compares epochs at call boundaries to tell when the cache
+	/// is stale. The epoch changes after the new size is published.
 	///
-	void grow(std::size_t n = 1) {
-		// TODO: worry about overflow / underflow
-		if (config_.page_count_max - page_count_ < n) {
+	std::uint64_t epoch() const noexcept { return epoch_.load(std::memory_order_acquire); }
+
+	/// Grow the memory by n pages. Thread safe.
+	///
+	/// @returns the number of pages before the memory grew.
+	///
+	std::size_t grow(std::size_t n = 1) {
+		std::lock_guard<std::mutex> guard(grow_lock_);
+		std::size_t page_count = page_count_.load(std::memory_order_relaxed);
+		if (config_.page_count_max - page_count < n) {
 			throw LinearMemoryError("Failed to grow, not enough reserved pages.");
 		}
-		activate(address_ + (page_count_ * page_size()), n);
-		page_count_ += n;
+		std::size_t offset = page_count * page_size();
+		// Lazily released pages may still hold their old contents. Clear them before reuse.
+		if (lazy_end_ > offset) {
+			Page::discard(address_ + offset, lazy_end_ - offset);
+			lazy_end_ = offset;
+		}
+		activate(address_ + offset, n);
+		publish_page_count(page_count + n);
+		return page_count;
 	}
 
-	/// Shrink the memory by n pages.
+	/// Shrink the memory by n pages, and return them to the system. The pages read as zero if the
+	/// memory grows again. A memory created from a snapshot can't shrink below the snapshot.
+	///
+	/// Not thread safe: no other thread may access the released pages.
+	///
+	void shrink(std::size_t n = 1, PageRelease release = PageRelease::IMMEDIATE);
+
+	/// Copy `size` bytes into the memory at `offset`, e.g. to initialize it from a data segment.
+	/// The range must be in bounds.
+	///
+	/// If the bytes are also held in a file, open as `fd` at `file_offset`, the whole pages of the
+	/// range that line up with pages of the file are mapped from the file copy-on-write instead.
+	/// They are shared with the page cache, and cost no memory until they are written. The rest
+	/// of the range is copied. Memories of explicit huge pages, or created from a snapshot, are
+	/// always copied into. The file must not change while it is mapped.
+	///
+	/// Not thread safe: no other thread may access the range.
+	///
+	/// @returns the number of bytes mapped from the file.
+	///
+	std::size_t load(
+		std::size_t offset, const Byte* data, std::size_t size, int fd = -1,
+		std::uint64_t file_offset = 0);
+
+	/// The number of bytes committed to the memory: it's accessible pages, rounded up to whole
+	/// commit granules.
+	///
+	std::size_t committed_size() const noexcept { return commit_boundary(size()); }
+
+	/// The number of bytes of the memory resident in physical memory. Lazily released pages count
+	/// until the kernel reclaims them.
+	///
+	std::size_t resident_size() const { return Page::resident(address_, reserved_size_); }
+
+	/// Return the memory to it's initial state. Pages are discarded rather than cleared, so the
+	/// cost is proportional to the pages that were touched. Memories created from a snapshot
+	/// return to the snapshot's contents, other memories to zeroes. Grown pages are released.
+	///
+	/// Not thread safe: no other thread may access the memory during a reset.
+	///
+	void reset();
+
+	const LinearMemoryConfig& config() const noexcept { return config_; }
+
+	/// The huge page policy in effect, which is weaker than the configured policy when huge pages
+	/// are unavailable.
+	///
+	HugePagePolicy huge_pages() const noexcept { return huge_pages_; }
+
+	/// The NUMA node the memory is bound to, or -1 if it is unbound.
+	///
+	int numa_node() const noexcept { return numa_node_.load(std::memory_order_relaxed); }
+
+	/// Place the memory on a NUMA node, migrating resident pages. Thread safe.
+	///
+	/// @returns false if the system doesn't support NUMA placement.
 	///
-	void shrink(std::size_t n = 1) {
-		if (page_count_ < n) {
-			throw LinearMemoryError("Failed to shrink: not enough active pages.");
+	bool bind_to_node(int node) noexcept;
+
+	/// Apply the LOCAL NUMA policy: move an unshared memory to the calling thread's node. Does
+	/// nothing under other policies. Called when a thread takes over the memory, e.g. when an
+	/// InstancePool lease is acquired.
+	///
+	void bind_to_current_node() noexcept {
+		if (config_.numa == NumaPolicy::LOCAL && !config_.shared) {
+			bind_to_node(Process::numa_node());
 		}
-		/// TODO: Deactivate region
 	}
 
-	const LinearMemoryConfig& config() const noexcept { return config_; }
+	/// The snapshot this memory was created from, or null.
+	///
+	const std::shared_ptr<const MemorySnapshot>& snapshot() const noexcept { return snapshot_; }
 
 private:
-	MutAddress reserve(const MutAddress address, std::size_t n) {
-		return Page::map(address, n * page_size());
+	/// Reserve the address range for `page_count_max` pages, under a huge page policy, and apply
+	/// the NUMA policy to it.
+	///
+	void reserve(HugePagePolicy policy);
+
+	/// Replace the pages mapped from a file at or above `offset` with anonymous pages. Discarding
+	/// them would read them back from the file, rather than as zero.
+	///
+	void unmap_file_pages(std::size_t offset, int permissions);
+
+	/// The unit memory is committed in. Explicit huge pages can only be committed whole.
+	///
+	std::size_t commit_granule() const noexcept {
+		return huge_pages_ == HugePagePolicy::EXPLICIT ? Page::HUGE_SIZE : page_size();
+	}
+
+	/// Round an offset into the memory up to a multiple of the commit granule.
+	///
+	std::size_t commit_boundary(std::size_t offset) const noexcept {
+		return (offset + commit_granule() - 1) / commit_granule() * commit_granule();
+	}
+
+	/// Publish a new size, then advance the epoch. Called with the grow lock held, or while the
+	/// memory is being constructed.
+	///
+	void publish_page_count(std::size_t page_count) noexcept {
+		page_count_.store(page_count, std::memory_order_release);
+		epoch_.fetch_add(1, std::memory_order_release);
 	}
 
 	void activate(const MutAddress address, const std::size_t n) {
-		// activate the memory region by requesting read/write permissions.
-		auto permissions = PagePermission::READ | PagePermission::WRITE;
-		Page::set_permissions(address, n * Page::size(), permissions);
+		// activate the memory region by requesting read/write permissions. The region is widened
+		// to whole commit granules. The part below it's start is already active.
+		std::size_t offset = address - address_;
+		auto begin         = address_ + (offset - offset % commit_granule());
+		auto end           = address_ + commit_boundary(offset + n * page_size());
+		auto permissions   = PagePermission::READ | PagePermission::WRITE;
+		Page::set_permissions(begin, end - begin, permissions);
 	}
 
 	void deactivate(const MutAddress address, const std::size_t n) {
 		// deactivate the memory region by disabling all permissions. this should hopefully
-		// cause the OS to unmap the memory.
-		auto permissions = PagePermission::NONE;
-		Page::set_permissions(address, n * Page::size(), permissions);
-	}
-
-	void release(const MutAddress address, const std::size_t n) {
-		Page::unmap(address, n * Page::size());
+		// cause the OS to unmap the memory. A commit granule straddling the start of the region
+		// stays active.
+		std::size_t offset = address - address_;
+		auto begin         = address_ + commit_boundary(offset);
+		auto end           = address_ + commit_boundary(offset + n * page_size());
+		if (begin < end) {
+			Page::set_permissions(begin, end - begin, PagePermission::NONE);
+		}
 	}
 
 	MutAddress address_;
-	std::size_t page_count_;
+	std::size_t reserved_size_ = 0;
+	std::size_t lazy_end_      = 0;
+	std::size_t mapped_begin_  = 0;
+	std::size_t mapped_end_    = 0;
+	HugePagePolicy huge_pages_ = HugePagePolicy::NONE;
+	std::atomic<int> numa_node_{-1};
+	std::atomic<std::size_t> page_count_;
+	std::atomic<std::uint64_t> epoch_{0};
+	std::mutex grow_lock_;
 	const LinearMemoryConfig config_;
+	std::shared_ptr<const MemorySnapshot> snapshot_;
 };
 
 }  // namespace Ab
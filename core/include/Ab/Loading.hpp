@@ -8,9 +8,18 @@
 #include <Ab/VirtualMachine.hpp>
 #include <absl/types/span.h>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 namespace Ab {
 
+/// Thrown when a module is malformed.
+///
+class DecodeError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
 /// Compile a storage buffer into a module.
 ///
 /// Ownership of the storage is moved into the module.
@@ -26,18 +35,29 @@ inline std::shared_ptr<Module> compile(Context& cx, absl::Span<Byte> bytes) {
 	return compile(cx, ModuleStorage(bytes));
 }
 
+/// Compile a module file.
+///
+/// The file may either be an abx module, or a native artifact produced by `ab aot`. Functions in
+/// an artifact are bound to their native code, and are never interpreted.
+///
+/// An abx module is mapped from the file, rather than read, and the pages of it's active data
+/// segments are mapped into the memories of it's instances. See `LinearMemory::load`.
+///
+std::shared_ptr<Module> compile(Context& cx, const std::string& filename);
+
 /// Instantiate a compiled module.
 ///
-/// The instantiation is owned by the VM.
-/// When the VM is destroyed, the module instance will be destroyed.
+/// The module's imports are bound against the VM's resolver.
+/// The instantiation is owned by the VM's store, and is published in the VM's module snapshot.
+/// When the VM is destroyed, the module instance will be destroyed. Instances that should be freed
+/// sooner are created with `VirtualMachine::instantiate`, which returns a handle to destroy.
+/// Many threads may instantiate modules into a shared VM concurrently.
 /// @returns a pointer to the newly instantiated module instance
+/// @throws LinkError if an import is unresolved, or has the wrong type.
 ///
 inline ModuleInst* instantiate(Context& cx, const std::shared_ptr<Module>& module) {
-	return new ModuleInst(module);
-}
-
-inline ModuleInst* instantiate(Context& cx, std::shared_ptr<Module>&& module) {
-	return new ModuleInst(std::move(module));
+	VirtualMachine* vm = cx.vm();
+	return vm->instance(vm->instantiate(module));
 }
 
 /// Instantiate a byte buffer.
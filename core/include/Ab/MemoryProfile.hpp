@@ -0,0 +1,160 @@
+#ifndef AB_MEMORYPROFILE_HPP_
+#define AB_MEMORYPROFILE_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Assert.hpp>
+#include <absl/types/span.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Ab {
+
+class LinearMemory;
+
+enum class MemoryAccess : std::uint8_t {
+	LOAD,
+	STORE,
+};
+
+/// One sampled access to a linear memory.
+///
+struct MemorySample {
+	const LinearMemory* memory;
+	std::uint64_t address;
+	std::uint32_t size;
+	MemoryAccess access;
+};
+
+/// The sampled loads and stores of one linear memory, counted per page.
+///
+class HeatMap {
+public:
+	/// Count an access to the page holding `address`.
+	///
+	void add(std::uint64_t address, MemoryAccess access);
+
+	/// One past the hottest page with any accesses.
+	///
+	std::size_t page_count() const noexcept { return loads_.size(); }
+
+	std::uint64_t loads(std::size_t page) const noexcept {
+		return page < loads_.size() ? loads_[page] : 0;
+	}
+
+	std::uint64_t stores(std::size_t page) const noexcept {
+		return page < stores_.size() ? stores_[page] : 0;
+	}
+
+	std::uint64_t count(std::size_t page) const noexcept { return loads(page) + stores(page); }
+
+	/// The total of every page.
+	///
+	std::uint64_t total() const noexcept;
+
+	/// The counts of regions of `granule` bytes, a multiple of the page size. With a granule of
+	/// `Page::HUGE_SIZE`, shows which parts of a memory are worth backing with huge pages.
+	///
+	std::vector<std::uint64_t> regions(std::size_t granule) const;
+
+	/// The indices of the `n` hottest pages, hottest first. Pages without accesses are left out.
+	///
+	std::vector<std::size_t> hottest(std::size_t n) const;
+
+private:
+	std::vector<std::uint64_t> loads_;
+	std::vector<std::uint64_t> stores_;
+};
+
+/// A sampling profile of the linear memory accesses made by one context.
+///
+/// Every `period`th load or store is recorded into a ring buffer. When the ring fills, it's
+/// samples are folded into a page-level heat map of each memory they touched, and the ring starts
+/// over. Recording is a countdown and a store, so a profile is cheap enough to leave on while a
+/// program is tuned.
+///
+/// The interpreter only records accesses when built with `AB_MEMORY_PROFILE`. Otherwise, the hooks
+/// compile to nothing, and profiles stay empty.
+///
+/// Heat maps are keyed by memory. A heat map outlives it's memory, until the profile is cleared.
+///
+class MemoryProfile {
+public:
+	static constexpr std::uint32_t DEFAULT_PERIOD = 64;
+
+	static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+	explicit MemoryProfile(
+		std::uint32_t period = DEFAULT_PERIOD, std::size_t capacity = DEFAULT_CAPACITY)
+		: period_(period), countdown_(period), samples_(capacity) {
+		AB_ASSERT(period != 0);
+		AB_ASSERT(capacity != 0);
+	}
+
+	MemoryProfile(const MemoryProfile&) = delete;
+
+	MemoryProfile& operator=(const MemoryProfile&) = delete;
+
+	/// Count an access, and sample it if it's the period'th since the last sample.
+	///
+	void record(
+		const LinearMemory* memory, std::uint64_t address, std::uint32_t size,
+		MemoryAccess access) {
+		if (--countdown_ != 0) {
+			return;
+		}
+		countdown_        = period_;
+		samples_[head_++] = MemorySample{memory, address, size, access};
+		if (head_ == samples_.size()) {
+			flush();
+		}
+	}
+
+	/// The number of accesses between samples.
+	///
+	std::uint32_t period() const noexcept { return period_; }
+
+	/// Change the sampling period. The next access is sampled after `period` more.
+	///
+	void period(std::uint32_t period) noexcept {
+		AB_ASSERT(period != 0);
+		period_    = period;
+		countdown_ = period;
+	}
+
+	/// The samples in the ring, that are not yet folded into the heat maps, oldest first.
+	///
+	absl::Span<const MemorySample> samples() const noexcept {
+		return absl::MakeConstSpan(samples_.data(), head_);
+	}
+
+	/// The number of samples taken since the profile was cleared.
+	///
+	std::uint64_t sample_count() const noexcept { return flushed_ + head_; }
+
+	/// Fold the samples in the ring into the heat maps, and empty the ring.
+	///
+	void flush();
+
+	/// The heat map of a memory, including the samples still in the ring, or null if the memory
+	/// was never sampled.
+	///
+	const HeatMap* heat_map(const LinearMemory* memory);
+
+	/// Drop every sample and heat map.
+	///
+	void clear() noexcept;
+
+private:
+	std::uint32_t period_;
+	std::uint32_t countdown_;
+	std::vector<MemorySample> samples_;
+	std::size_t head_      = 0;
+	std::uint64_t flushed_ = 0;
+	std::unordered_map<const LinearMemory*, HeatMap> heat_maps_;
+};
+
+}  // namespace Ab
+
+#endif  // AB_MEMORYPROFILE_HPP_
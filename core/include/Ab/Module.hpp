@@ -6,22 +6,206 @@
 #include <Ab/Assert.hpp>
 #include <Ab/Bytes.hpp>
 #include <Ab/Func.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/ModuleConstants.hpp>
 #include <Ab/VectorUtilities.hpp>
 #include <absl/types/span.h>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Ab {
 
+/// A function required by a module, to be bound by a linker before the module is called.
+///
+/// Imported functions come first in a module's function index space, in import order, followed
+/// by the functions defined in the module.
+///
+struct ImportEntry {
+	std::string module;
+	std::string name;
+	ExternalKind kind      = ExternalKind::FUNC;
+	std::uint32_t type_idx = 0;
+};
+
+using ImportTable = std::vector<ImportEntry>;
+
+/// A linear memory defined by a module. Each instance of the module gets it's own memory, sized
+/// in LinearMemory pages. A module may define several memories, per the multi-memory proposal.
+/// A memory64 memory is indexed by 64-bit addresses, and may be larger than 4 GiB.
+///
+struct MemoryEntry {
+	std::uint64_t page_count_min = 0;
+	std::uint64_t page_count_max = 0;
+	bool shared                  = false;
+	bool memory64                = false;
+};
+
+using MemoryTable = std::vector<MemoryEntry>;
+
+/// A table of function references defined by a module. Each instance gets it's own table, of
+/// `size_min` slots, filled from the module's element segments when the instance is linked.
+///
+struct TableEntry {
+	std::uint32_t size_min = 0;
+	std::uint32_t size_max = 0;
+};
+
+using TableTable = std::vector<TableEntry>;
+
+/// An active element segment. When an instance is linked, the functions are written into it's
+/// table, starting at `offset`. Functions are given by their index in the module's function index
+/// space.
+///
+struct ElementSegment {
+	std::uint32_t table  = 0;
+	std::uint32_t offset = 0;
+	std::vector<std::uint32_t> funcs;
+};
+
+using ElementTable = std::vector<ElementSegment>;
+
+/// A global variable defined by a module.
+///
+/// Every global takes one 8-byte slot in it's instance, whatever it's type. The initial value is
+/// held as raw bits: 32-bit values are zero extended.
+///
+struct GlobalEntry {
+	ValType type       = ValType::I32;
+	bool is_mutable    = false;
+	std::uint64_t init = 0;
+};
+
+using GlobalTable = std::vector<GlobalEntry>;
+
+/// The data segments of a module, the sources of `memory.init`. Each segment is a view into the
+/// module's bytes.
+///
+using DataTable = std::vector<absl::Span<const Byte>>;
+
+/// An active data segment, copied into a memory when the module is instantiated. The segment is
+/// dropped once it is copied.
+///
+struct ActiveDataEntry {
+	std::uint32_t segment = 0;
+	std::uint32_t memory  = 0;
+	std::uint64_t offset  = 0;
+};
+
+using ActiveDataTable = std::vector<ActiveDataEntry>;
+
 struct ExportEntry {
 	std::string name;
 	std::size_t index;
+	ExternalKind kind = ExternalKind::FUNC;
 };
 
 using ExportTable = std::vector<ExportEntry>;
 
+/// An open-addressing hash index over an export table, mapping names to entries.
+///
+/// The index is built once, when a module is compiled. Each slot caches the full hash of it's
+/// name, so a probe only compares strings when the hashes match. The table is kept at most half
+/// full, so lookups usually touch a single slot.
+///
+class ExportIndex {
+public:
+	ExportIndex() noexcept = default;
+
+	/// Index a table. Returns false if two entries share a name.
+	///
+	bool build(const ExportTable& table) {
+		std::size_t capacity = 2;
+		while (capacity < table.size() * 2) {
+			capacity *= 2;
+		}
+		slots_.assign(capacity, Slot());
+		mask_ = capacity - 1;
+
+		for (std::size_t i = 0; i < table.size(); ++i) {
+			std::uint64_t h = hash_name(table[i].name);
+			std::size_t pos = h & mask_;
+			while (slots_[pos].entry != EMPTY) {
+				if (slots_[pos].hash == h && table[slots_[pos].entry].name == table[i].name) {
+					return false;
+				}
+				pos = (pos + 1) & mask_;
+			}
+			slots_[pos] = Slot{h, std::uint32_t(i)};
+		}
+		return true;
+	}
+
+	/// Find an entry by name. The table must be the one the index was built from.
+	///
+	const ExportEntry* find(const ExportTable& table, std::string_view name) const noexcept {
+		if (slots_.empty()) {
+			return nullptr;
+		}
+		std::uint64_t h = hash_name(name);
+		for (std::size_t pos = h & mask_; slots_[pos].entry != EMPTY; pos = (pos + 1) & mask_) {
+			if (slots_[pos].hash == h && table[slots_[pos].entry].name == name) {
+				return &table[slots_[pos].entry];
+			}
+		}
+		return nullptr;
+	}
+
+	/// 64-bit FNV-1a.
+	///
+	static std::uint64_t hash_name(std::string_view name) noexcept {
+		std::uint64_t h = 0xcbf29ce484222325;
+		for (char c : name) {
+			h ^= std::uint8_t(c);
+			h *= 0x100000001b3;
+		}
+		return h;
+	}
+
+private:
+	static constexpr std::uint32_t EMPTY = std::numeric_limits<std::uint32_t>::max();
+
+	struct Slot {
+		std::uint64_t hash  = 0;
+		std::uint32_t entry = EMPTY;
+	};
+
+	std::vector<Slot> slots_;
+	std::size_t mask_ = 0;
+};
+
+/// A pre-resolved exported function.
+///
+/// Resolving a name hashes it once. Calls through the handle index the function table directly,
+/// and never touch the name. A handle is valid for every instance of the module it was resolved
+/// against.
+///
+class FuncHandle {
+public:
+	constexpr FuncHandle() noexcept : index_(INVALID) {}
+
+	constexpr explicit FuncHandle(std::uint32_t index) noexcept : index_(index) {}
+
+	constexpr bool valid() const noexcept { return index_ != INVALID; }
+
+	constexpr explicit operator bool() const noexcept { return valid(); }
+
+	/// The index of the function in it's module's function index space.
+	///
+	constexpr std::uint32_t index() const noexcept { return index_; }
+
+private:
+	static constexpr std::uint32_t INVALID = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint32_t index_;
+};
+
 using FuncInstTable = std::vector<FuncInst*>;
 
 /// A manager for the raw bytes that make up a module's data.
@@ -31,6 +215,9 @@ using FuncInstTable = std::vector<FuncInst*>;
 /// This class allows users to specify a deleter function, in the case where
 /// the backing data must be released through special means.
 ///
+/// Storage mapped from a file keeps the file open, so that data segments can be mapped from the
+/// file into an instance's memories. See `LinearMemory::load`.
+///
 class ModuleStorage {
 public:
 	using Deleter = void (*)(void*);
@@ -41,18 +228,27 @@ public:
 	ModuleStorage(absl::Span<Byte> bytes, Deleter deleter) noexcept
 		: bytes_(bytes), deleter_(deleter) {}
 
+	/// Map an entire module file copy-on-write. Falls back to reading the file into a malloc'd
+	/// buffer if it can't be mapped, e.g. if it is a pipe.
+	///
+	static ModuleStorage map_file(const std::string& filename);
+
 	ModuleStorage(const ModuleStorage&) = delete;
 
 	ModuleStorage(ModuleStorage&& other) noexcept {
 		bytes_   = other.bytes_;
 		deleter_ = other.deleter_;
+		fd_      = other.fd_;
 
 		other.bytes_   = absl::Span<Byte>();
 		other.deleter_ = nullptr;
+		other.fd_      = -1;
 	}
 
 	~ModuleStorage() noexcept {
-		if (address() && deleter_) {
+		if (fd_ >= 0) {
+			unmap_file(bytes_, fd_);
+		} else if (address() && deleter_) {
 			deleter_(address());
 		}
 	}
@@ -67,9 +263,19 @@ public:
 
 	absl::Span<Byte> bytes() const noexcept { return bytes_; }
 
+	/// The file the bytes are mapped from, or -1. The bytes start at the beginning of the file.
+	///
+	int fd() const noexcept { return fd_; }
+
 private:
+	ModuleStorage(absl::Span<Byte> bytes, int fd) noexcept
+		: bytes_(bytes), deleter_(nullptr), fd_(fd) {}
+
+	static void unmap_file(absl::Span<Byte> bytes, int fd) noexcept;
+
 	absl::Span<Byte> bytes_;
 	Deleter deleter_;
+	int fd_ = -1;
 };
 
 using FuncTable = std::vector<Func>;
@@ -100,6 +306,12 @@ public:
 
 	const std::vector<FuncType>& type_table() const noexcept { return type_table_; }
 
+	/// The canonical id of each type in the type table. See TypeRegistry.
+	///
+	std::vector<TypeId>& type_ids() noexcept { return type_ids_; }
+
+	const std::vector<TypeId>& type_ids() const noexcept { return type_ids_; }
+
 	std::vector<std::uint32_t>& func_types() noexcept { return func_types_; }
 
 	const std::vector<std::uint32_t>& func_types() const noexcept { return func_types_; }
@@ -111,21 +323,155 @@ public:
 		return type_table_.at(typeidx);
 	}
 
+	ImportTable& import_table() noexcept { return import_table_; }
+
+	const ImportTable& import_table() const noexcept { return import_table_; }
+
+	/// The number of functions in the module's function index space, imported and defined.
+	///
+	std::size_t func_count() const noexcept { return import_table_.size() + func_types_.size(); }
+
+	/// The canonical type id of the nth function in the module's function index space.
+	///
+	TypeId func_type_id(std::size_t index) const noexcept {
+		if (index < import_table_.size()) {
+			return type_ids_[import_table_[index].type_idx];
+		}
+		return type_ids_[func_types_[index - import_table_.size()]];
+	}
+
+	TableTable& table_table() noexcept { return table_table_; }
+
+	const TableTable& table_table() const noexcept { return table_table_; }
+
+	ElementTable& element_table() noexcept { return element_table_; }
+
+	const ElementTable& element_table() const noexcept { return element_table_; }
+
+	MemoryTable& memory_table() noexcept { return memory_table_; }
+
+	const MemoryTable& memory_table() const noexcept { return memory_table_; }
+
+	GlobalTable& global_table() noexcept { return global_table_; }
+
+	const GlobalTable& global_table() const noexcept { return global_table_; }
+
+	DataTable& data_table() noexcept { return data_table_; }
+
+	const DataTable& data_table() const noexcept { return data_table_; }
+
+	ActiveDataTable& active_data_table() noexcept { return active_data_table_; }
+
+	const ActiveDataTable& active_data_table() const noexcept { return active_data_table_; }
+
+	ExportTable& export_table() noexcept { return export_table_; }
+
+	const ExportTable& export_table() const noexcept { return export_table_; }
+
+	/// Build the export index. Must be called after the export table is complete, and before any
+	/// lookups. Returns false if two exports share a name.
+	///
+	bool index_exports() { return export_index_.build(export_table_); }
+
+	/// Find an export by name, or null.
+	///
+	const ExportEntry* find_export(std::string_view name) const noexcept {
+		return export_index_.find(export_table_, name);
+	}
+
+	/// Resolve an exported function's name to a handle. The handle is invalid if there is no
+	/// such function.
+	///
+	FuncHandle resolve_func(std::string_view name) const noexcept {
+		const ExportEntry* entry = find_export(name);
+		if (entry == nullptr || entry->kind != ExternalKind::FUNC) {
+			return FuncHandle();
+		}
+		return FuncHandle(std::uint32_t(entry->index));
+	}
+
 private:
 	ModuleStorage storage_;
 	FuncTable func_table_;
 	std::vector<FuncType> type_table_;
+	std::vector<TypeId> type_ids_;
 	std::vector<std::uint32_t> func_types_;
+	ImportTable import_table_;
+	TableTable table_table_;
+	ElementTable element_table_;
+	MemoryTable memory_table_;
+	GlobalTable global_table_;
+	DataTable data_table_;
+	ActiveDataTable active_data_table_;
+	ExportTable export_table_;
+	ExportIndex export_index_;
 };
 
 /// Module Instance.
 /// An instantiated module, the runtime-side of a module.
 ///
+/// An instance with imports must be linked before it is called: each import is bound to a
+/// function instance, then `link` writes the complete function index space into the instance's
+/// constant pool, which every function in the instance shares. Calls, local or imported, are then
+/// a single load from the pool. An instance without imports is linked on construction.
+///
+/// The instance's globals are held in one contiguous block of 8-byte slots, which the pool points
+/// at, so `get_global` and `set_global` are a single load or store through the pool. The pool
+/// also points at the instance's view of the module's data segments, which `data.drop` empties.
+///
+/// The instance owns it's memories, so instances of different modules in one VM never share a
+/// heap. The pool holds memory 0 apart from the others, for the memory-0 load and store handlers.
+///
+/// The instance owns it's tables too. Linking fills them from the module's element segments, with
+/// each function's canonical type id alongside it, so `call_indirect` checks a signature without
+/// leaving the slot.
+///
 class ModuleInst {
 public:
-	ModuleInst(const std::shared_ptr<Module>& module) : module_(module) { initialize(); }
+	/// Instantiate a module. The module's memories take their huge page and NUMA policies from
+	/// `memory_config`, and their sizes from the module.
+	///
+	ModuleInst(const std::shared_ptr<Module>& module, const LinearMemoryConfig& memory_config = {})
+		: module_(module) {
+		initialize(memory_config);
+	}
 
-	ModuleInst(std::shared_ptr<Module>&& module) : module_(std::move(module)) { initialize(); }
+	ModuleInst(std::shared_ptr<Module>&& module, const LinearMemoryConfig& memory_config = {})
+		: module_(std::move(module)) {
+		initialize(memory_config);
+	}
+
+	/// Create another instance of the prototype's module, copying the prototype's function table
+	/// and import bindings rather than resolving them again. The globals and data segments start
+	/// in the prototype's current state, and the memories start as copies of the prototype's.
+	///
+	explicit ModuleInst(const ModuleInst& prototype)
+		: ModuleInst(prototype, prototype.capture_memories()) {}
+
+	/// Create another instance of the prototype's module, with memories mapped copy-on-write from
+	/// snapshots of the prototype's memories. See `capture_memories`.
+	///
+	ModuleInst(const ModuleInst& prototype, const MemorySnapshots& snapshots)
+		: module_(prototype.module_),
+		  func_inst_table_(prototype.func_inst_table_),
+		  imports_(prototype.imports_),
+		  globals_(prototype.globals_),
+		  data_(prototype.data_),
+		  linked_(false) {
+		AB_ASSERT(snapshots.size() == prototype.memories_.size());
+		for (FuncInst& func : func_inst_table_) {
+			func.const_pool(&const_pool_);
+		}
+		const_pool_.globals = globals_.data();
+		const_pool_.data    = data_.data();
+		initialize_tables();
+		for (std::size_t i = 0; i < snapshots.size(); ++i) {
+			add_memory(std::make_unique<LinearMemory>(prototype.memory(i)->config(), snapshots[i]));
+		}
+		if (prototype.linked()) {
+			link();
+		}
+	}
 
 	/// Obtain the underlying, stateless representation of the module.
 	/// Note that the module may be shared by multiple instantiations.
@@ -154,50 +500,240 @@ public:
 		return &func_inst_table_[index];
 	}
 
-#if 0  /////////////////////////////////////////////////////////////////////////
+	/// Grab a function by it's index in the module's function index space, which starts with the
+	/// imported functions. Imports are null until bound.
+	///
+	FuncInst* func(std::size_t index) const noexcept {
+		if (index < imports_.size()) {
+			return imports_[index];
+		}
+		return const_cast<FuncInst*>(func_inst(index - imports_.size()));
+	}
+
+	/// Helper to grab a function instance by a pre-resolved handle.
+	///
+	FuncInst* func_inst(FuncHandle handle) noexcept { return func(handle.index()); }
+
+	const FuncInst* func_inst(FuncHandle handle) const noexcept { return func(handle.index()); }
 
-	/// Find an function by name.
+	/// The number of imported functions.
 	///
-	Func* find_function(std::string_view name) noexcept {
-		for (const auto& entry : export_table_) {
-			if (entry.name == name) {
-				return function_for(entry);
+	std::size_t import_count() const noexcept { return imports_.size(); }
+
+	/// Bind the nth import to a function instance. The function must outlive this instance.
+	///
+	void bind_import(std::size_t index, FuncInst* func) noexcept {
+		AB_ASSERT(!linked_);
+		AB_ASSERT(index < imports_.size());
+		imports_[index] = func;
+	}
+
+	/// Publish the function index space to every function in the instance. All imports must be
+	/// bound.
+	///
+	void link() {
+		FuncInstTable& table = const_pool_.func_table;
+		table.clear();
+		table.reserve(module_->func_count());
+		for (FuncInst* import : imports_) {
+			AB_ASSERT(import != nullptr);
+			table.push_back(import);
+		}
+		for (FuncInst& func : func_inst_table_) {
+			table.push_back(&func);
+		}
+		for (const auto& segment : module_->element_table()) {
+			RefTable& refs = tables_[segment.table];
+			for (std::size_t i = 0; i < segment.funcs.size(); ++i) {
+				std::uint32_t index      = segment.funcs[i];
+				refs[segment.offset + i] = FuncRef{table[index], module_->func_type_id(index)};
 			}
 		}
-		return nullptr;
+		linked_ = true;
 	}
 
-	const Func* find_function(std::string_view name) const noexcept {
-		for (const auto& entry : export_table_) {
-			if (entry.name == name) {
-				return function_for(entry);
-			}
+	/// The constants shared by every function in the instance.
+	///
+	const ConstPool& const_pool() const noexcept { return const_pool_; }
+
+	/// The number of globals in the instance.
+	///
+	std::size_t global_count() const noexcept { return globals_.size(); }
+
+	/// Read the nth global. T must be the size of the global's type.
+	///
+	template <typename T>
+	T global(std::size_t index) const noexcept {
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+		AB_ASSERT(index < globals_.size());
+		T value;
+		std::memcpy(&value, &globals_[index], sizeof(T));
+		return value;
+	}
+
+	/// Write the nth global. 32-bit values are zero extended to fill the slot.
+	///
+	template <typename T>
+	void global(std::size_t index, T value) noexcept {
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+		AB_ASSERT(index < globals_.size());
+		globals_[index] = 0;
+		std::memcpy(&globals_[index], &value, sizeof(T));
+	}
+
+	/// The number of memories in the instance.
+	///
+	std::size_t memory_count() const noexcept { return memories_.size(); }
+
+	/// The nth memory of the instance.
+	///
+	LinearMemory* memory(std::size_t index) const noexcept {
+		AB_ASSERT(index < memories_.size());
+		return memories_[index].get();
+	}
+
+	/// The number of tables in the instance.
+	///
+	std::size_t table_count() const noexcept { return tables_.size(); }
+
+	/// The nth table of the instance. The table is empty until the instance is linked.
+	///
+	RefTable& table(std::size_t index) noexcept {
+		AB_ASSERT(index < tables_.size());
+		return tables_[index];
+	}
+
+	const RefTable& table(std::size_t index) const noexcept {
+		AB_ASSERT(index < tables_.size());
+		return tables_[index];
+	}
+
+	/// Snapshot every memory of the instance, for creating copies. See MemorySnapshot.
+	///
+	MemorySnapshots capture_memories() const {
+		MemorySnapshots snapshots;
+		snapshots.reserve(memories_.size());
+		for (const auto& memory : memories_) {
+			snapshots.push_back(MemorySnapshot::capture(*memory));
 		}
-		return nullptr;
+		return snapshots;
 	}
 
-	/// Get the function corresponding to an entry in the module's export table.
+	/// True if the nth data segment has been dropped.
 	///
-	Func* function_for(const ExportEntry& entry) noexcept {
-		return func_table_.at(entry.index);
+	bool data_dropped(std::size_t index) const noexcept {
+		AB_ASSERT(index < data_.size());
+		return data_[index].data() == nullptr;
 	}
 
-	const Func* function_for(const ExportEntry& entry) const noexcept {
-		return func_table_.at(entry.index);
+	/// Reset the globals and data segments to the state of another instance of the same module.
+	/// The memories are not touched, see `LinearMemory::reset`.
+	///
+	void restore(const ModuleInst& other) noexcept {
+		AB_ASSERT(other.module_ == module_);
+		std::copy(other.globals_.begin(), other.globals_.end(), globals_.begin());
+		std::copy(other.data_.begin(), other.data_.end(), data_.begin());
 	}
 
-#endif  ////////////////////////////////////////////////////////////////////////
+	/// True once every import is bound, and the instance can be called.
+	///
+	bool linked() const noexcept { return linked_; }
+
+	/// Find an exported function by name, or null. Hot callers should resolve the name to a
+	/// handle once, with `Module::resolve_func`, rather than calling this per call.
+	///
+	FuncInst* find_function(std::string_view name) noexcept {
+		FuncHandle handle = module_->resolve_func(name);
+		return handle ? func_inst(handle) : nullptr;
+	}
+
+	const FuncInst* find_function(std::string_view name) const noexcept {
+		FuncHandle handle = module_->resolve_func(name);
+		return handle ? func_inst(handle) : nullptr;
+	}
+
+	/// Resolve an exported function's name to a handle.
+	///
+	FuncHandle resolve_func(std::string_view name) const noexcept {
+		return module_->resolve_func(name);
+	}
 
 	const std::shared_ptr<Module> module_;
 	std::vector<FuncInst> func_inst_table_;
 
 private:
-	void initialize() {
+	void initialize(const LinearMemoryConfig& memory_config) {
 		func_inst_table_.reserve(module_->func_table().size());
 		for (auto& func : module_->func_table()) {
-			func_inst_table_.emplace_back(&func);
+			func_inst_table_.emplace_back(&func, &const_pool_);
+		}
+		globals_.reserve(module_->global_table().size());
+		for (const auto& global : module_->global_table()) {
+			globals_.push_back(global.init);
+		}
+		const_pool_.globals = globals_.data();
+		data_               = module_->data_table();
+		const_pool_.data    = data_.data();
+		initialize_tables();
+		for (const auto& entry : module_->memory_table()) {
+			LinearMemoryConfig config = memory_config;
+			config.address            = nullptr;
+			config.page_count_min     = entry.page_count_min;
+			config.page_count_max     = entry.page_count_max;
+			config.shared             = entry.shared;
+			config.memory64           = entry.memory64;
+			add_memory(std::make_unique<LinearMemory>(config));
+		}
+		initialize_memories();
+		imports_.assign(module_->import_table().size(), nullptr);
+		linked_ = false;
+		if (imports_.empty()) {
+			link();
 		}
 	}
+
+	/// Create the instance's empty tables, and publish them and the module's type ids in the pool.
+	///
+	void initialize_tables() {
+		tables_.reserve(module_->table_table().size());
+		for (const auto& entry : module_->table_table()) {
+			tables_.emplace_back(entry.size_min);
+		}
+		const_pool_.tables   = absl::MakeSpan(tables_);
+		const_pool_.type_ids = module_->type_ids().data();
+	}
+
+	/// Copy the active data segments into the memories, mapping them from the module file where
+	/// they line up with it's pages, and drop them.
+	///
+	void initialize_memories() {
+		const ModuleStorage& storage = module_->storage();
+		for (const auto& entry : module_->active_data_table()) {
+			absl::Span<const Byte> segment = data_[entry.segment];
+			std::uint64_t file_offset      = segment.data() - storage.address();
+			memories_[entry.memory]->load(
+				entry.offset, segment.data(), segment.size(), storage.fd(), file_offset);
+			data_[entry.segment] = absl::Span<const Byte>();
+		}
+	}
+
+	/// Take ownership of the next memory, and publish it in the pool.
+	///
+	void add_memory(std::unique_ptr<LinearMemory> memory) {
+		memory_ptrs_.push_back(memory.get());
+		memories_.push_back(std::move(memory));
+		const_pool_.memory   = memory_ptrs_.front();
+		const_pool_.memories = memory_ptrs_;
+	}
+
+	FuncInstTable imports_;
+	std::vector<std::uint64_t> globals_;
+	DataTable data_;
+	std::vector<RefTable> tables_;
+	std::vector<std::unique_ptr<LinearMemory>> memories_;
+	std::vector<LinearMemory*> memory_ptrs_;
+	ConstPool const_pool_;
+	bool linked_;
 };
 
 }  // namespace Ab
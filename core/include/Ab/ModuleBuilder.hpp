@@ -34,6 +34,45 @@ enum class InsnKind {
 	RETURN,
 	X32_RETURN,
 	X64_RETURN,
+	CALL,
+	CALL_INDIRECT,
+	CALL_PRIMITIVE,
+	GET_GLOBAL_X32,
+	GET_GLOBAL_X64,
+	SET_GLOBAL_X32,
+	SET_GLOBAL_X64,
+	I32_LOAD,
+	I64_LOAD,
+	I32_STORE,
+	I64_STORE,
+	MEMORY_SIZE,
+	MEMORY_GROW,
+	MEMORY_COPY,
+	MEMORY_FILL,
+	MEMORY_INIT,
+	DATA_DROP,
+	MEMORY_ATOMIC_NOTIFY,
+	MEMORY_ATOMIC_WAIT32,
+	MEMORY_ATOMIC_WAIT64,
+	ATOMIC_FENCE,
+	I32_ATOMIC_LOAD,
+	I64_ATOMIC_LOAD,
+	I32_ATOMIC_STORE,
+	I64_ATOMIC_STORE,
+	I32_ATOMIC_RMW_ADD,
+	I64_ATOMIC_RMW_ADD,
+	I32_ATOMIC_RMW_SUB,
+	I64_ATOMIC_RMW_SUB,
+	I32_ATOMIC_RMW_AND,
+	I64_ATOMIC_RMW_AND,
+	I32_ATOMIC_RMW_OR,
+	I64_ATOMIC_RMW_OR,
+	I32_ATOMIC_RMW_XOR,
+	I64_ATOMIC_RMW_XOR,
+	I32_ATOMIC_RMW_XCHG,
+	I64_ATOMIC_RMW_XCHG,
+	I32_ATOMIC_RMW_CMPXCHG,
+	I64_ATOMIC_RMW_CMPXCHG,
 	LABEL,
 };
 
@@ -57,6 +96,45 @@ class I32AddInsnNode;
 class ReturnInsnNode;
 class X32ReturnInsnNode;
 class X64ReturnInsnNode;
+class CallInsnNode;
+class CallIndirectInsnNode;
+class CallPrimitiveInsnNode;
+class GetGlobalX32InsnNode;
+class GetGlobalX64InsnNode;
+class SetGlobalX32InsnNode;
+class SetGlobalX64InsnNode;
+class I32LoadInsnNode;
+class I64LoadInsnNode;
+class I32StoreInsnNode;
+class I64StoreInsnNode;
+class MemorySizeInsnNode;
+class MemoryGrowInsnNode;
+class MemoryCopyInsnNode;
+class MemoryFillInsnNode;
+class MemoryInitInsnNode;
+class DataDropInsnNode;
+class MemoryAtomicNotifyInsnNode;
+class MemoryAtomicWait32InsnNode;
+class MemoryAtomicWait64InsnNode;
+class AtomicFenceInsnNode;
+class I32AtomicLoadInsnNode;
+class I64AtomicLoadInsnNode;
+class I32AtomicStoreInsnNode;
+class I64AtomicStoreInsnNode;
+class I32AtomicRmwAddInsnNode;
+class I64AtomicRmwAddInsnNode;
+class I32AtomicRmwSubInsnNode;
+class I64AtomicRmwSubInsnNode;
+class I32AtomicRmwAndInsnNode;
+class I64AtomicRmwAndInsnNode;
+class I32AtomicRmwOrInsnNode;
+class I64AtomicRmwOrInsnNode;
+class I32AtomicRmwXorInsnNode;
+class I64AtomicRmwXorInsnNode;
+class I32AtomicRmwXchgInsnNode;
+class I64AtomicRmwXchgInsnNode;
+class I32AtomicRmwCmpxchgInsnNode;
+class I64AtomicRmwCmpxchgInsnNode;
 
 class InsnVisitor {
 public:
@@ -75,6 +153,84 @@ public:
 	virtual void on_x32_return(X32ReturnInsnNode& n) = 0;
 
 	virtual void on_x64_return(X64ReturnInsnNode& n) = 0;
+
+	virtual void on_call(CallInsnNode& n) = 0;
+
+	virtual void on_call_indirect(CallIndirectInsnNode& n) = 0;
+
+	virtual void on_call_primitive(CallPrimitiveInsnNode& n) = 0;
+
+	virtual void on_get_global_x32(GetGlobalX32InsnNode& n) = 0;
+
+	virtual void on_get_global_x64(GetGlobalX64InsnNode& n) = 0;
+
+	virtual void on_set_global_x32(SetGlobalX32InsnNode& n) = 0;
+
+	virtual void on_set_global_x64(SetGlobalX64InsnNode& n) = 0;
+
+	virtual void on_i32_load(I32LoadInsnNode& n) = 0;
+
+	virtual void on_i64_load(I64LoadInsnNode& n) = 0;
+
+	virtual void on_i32_store(I32StoreInsnNode& n) = 0;
+
+	virtual void on_i64_store(I64StoreInsnNode& n) = 0;
+
+	virtual void on_memory_size(MemorySizeInsnNode& n) = 0;
+
+	virtual void on_memory_grow(MemoryGrowInsnNode& n) = 0;
+
+	virtual void on_memory_copy(MemoryCopyInsnNode& n) = 0;
+
+	virtual void on_memory_fill(MemoryFillInsnNode& n) = 0;
+
+	virtual void on_memory_init(MemoryInitInsnNode& n) = 0;
+
+	virtual void on_data_drop(DataDropInsnNode& n) = 0;
+
+	virtual void on_memory_atomic_notify(MemoryAtomicNotifyInsnNode& n) = 0;
+
+	virtual void on_memory_atomic_wait32(MemoryAtomicWait32InsnNode& n) = 0;
+
+	virtual void on_memory_atomic_wait64(MemoryAtomicWait64InsnNode& n) = 0;
+
+	virtual void on_atomic_fence(AtomicFenceInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_load(I32AtomicLoadInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_load(I64AtomicLoadInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_store(I32AtomicStoreInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_store(I64AtomicStoreInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_add(I32AtomicRmwAddInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_add(I64AtomicRmwAddInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_sub(I32AtomicRmwSubInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_sub(I64AtomicRmwSubInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_and(I32AtomicRmwAndInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_and(I64AtomicRmwAndInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_or(I32AtomicRmwOrInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_or(I64AtomicRmwOrInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_xor(I32AtomicRmwXorInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_xor(I64AtomicRmwXorInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_xchg(I32AtomicRmwXchgInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_xchg(I64AtomicRmwXchgInsnNode& n) = 0;
+
+	virtual void on_i32_atomic_rmw_cmpxchg(I32AtomicRmwCmpxchgInsnNode& n) = 0;
+
+	virtual void on_i64_atomic_rmw_cmpxchg(I64AtomicRmwCmpxchgInsnNode& n) = 0;
 };
 
 inline InsnVisitor::~InsnVisitor() noexcept = default;
@@ -161,6 +317,750 @@ public:
 	std::uint32_t src;
 };
 
+class CallInsnNode final : public InsnNode {
+public:
+	CallInsnNode() noexcept = default;
+
+	constexpr CallInsnNode(std::uint32_t tgt, std::uint32_t base) noexcept
+		: tgt(tgt), base(base) {}
+
+	virtual ~CallInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::CALL; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_call(*this); }
+
+	std::uint32_t tgt;
+	std::uint32_t base;
+};
+
+class CallIndirectInsnNode final : public InsnNode {
+public:
+	CallIndirectInsnNode() noexcept = default;
+
+	constexpr CallIndirectInsnNode(
+		std::uint32_t type_idx, std::uint32_t base, std::uint32_t index,
+		std::uint32_t table = 0) noexcept
+		: type_idx(type_idx), base(base), index(index), table(table) {}
+
+	virtual ~CallIndirectInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::CALL_INDIRECT; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_call_indirect(*this); }
+
+	std::uint32_t type_idx;
+	std::uint32_t base;
+	std::uint32_t index;
+	std::uint32_t table;
+};
+
+class CallPrimitiveInsnNode final : public InsnNode {
+public:
+	CallPrimitiveInsnNode() noexcept = default;
+
+	constexpr CallPrimitiveInsnNode(std::uint32_t tgt, std::uint32_t base) noexcept
+		: tgt(tgt), base(base) {}
+
+	virtual ~CallPrimitiveInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::CALL_PRIMITIVE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_call_primitive(*this); }
+
+	std::uint32_t tgt;
+	std::uint32_t base;
+};
+
+class GetGlobalX32InsnNode final : public InsnNode {
+public:
+	GetGlobalX32InsnNode() noexcept = default;
+
+	constexpr GetGlobalX32InsnNode(std::uint32_t dst, std::uint32_t index) noexcept
+		: dst(dst), index(index) {}
+
+	virtual ~GetGlobalX32InsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::GET_GLOBAL_X32; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_get_global_x32(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t index;
+};
+
+class GetGlobalX64InsnNode final : public InsnNode {
+public:
+	GetGlobalX64InsnNode() noexcept = default;
+
+	constexpr GetGlobalX64InsnNode(std::uint32_t dst, std::uint32_t index) noexcept
+		: dst(dst), index(index) {}
+
+	virtual ~GetGlobalX64InsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::GET_GLOBAL_X64; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_get_global_x64(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t index;
+};
+
+class SetGlobalX32InsnNode final : public InsnNode {
+public:
+	SetGlobalX32InsnNode() noexcept = default;
+
+	constexpr SetGlobalX32InsnNode(std::uint32_t src, std::uint32_t index) noexcept
+		: src(src), index(index) {}
+
+	virtual ~SetGlobalX32InsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::SET_GLOBAL_X32; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_set_global_x32(*this); }
+
+	std::uint32_t src;
+	std::uint32_t index;
+};
+
+class SetGlobalX64InsnNode final : public InsnNode {
+public:
+	SetGlobalX64InsnNode() noexcept = default;
+
+	constexpr SetGlobalX64InsnNode(std::uint32_t src, std::uint32_t index) noexcept
+		: src(src), index(index) {}
+
+	virtual ~SetGlobalX64InsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::SET_GLOBAL_X64; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_set_global_x64(*this); }
+
+	std::uint32_t src;
+	std::uint32_t index;
+};
+
+class I32LoadInsnNode final : public InsnNode {
+public:
+	I32LoadInsnNode() noexcept = default;
+
+	constexpr I32LoadInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint64_t offset = 0,
+		std::uint32_t memory = 0) noexcept
+		: dst(dst), addr(addr), offset(offset), memory(memory) {}
+
+	virtual ~I32LoadInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_LOAD; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_load(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint64_t offset;
+	std::uint32_t memory;
+};
+
+class I64LoadInsnNode final : public InsnNode {
+public:
+	I64LoadInsnNode() noexcept = default;
+
+	constexpr I64LoadInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint64_t offset = 0,
+		std::uint32_t memory = 0) noexcept
+		: dst(dst), addr(addr), offset(offset), memory(memory) {}
+
+	virtual ~I64LoadInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_LOAD; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_load(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint64_t offset;
+	std::uint32_t memory;
+};
+
+class I32StoreInsnNode final : public InsnNode {
+public:
+	I32StoreInsnNode() noexcept = default;
+
+	constexpr I32StoreInsnNode(
+		std::uint32_t addr, std::uint32_t src, std::uint64_t offset = 0,
+		std::uint32_t memory = 0) noexcept
+		: addr(addr), src(src), offset(offset), memory(memory) {}
+
+	virtual ~I32StoreInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_STORE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_store(*this); }
+
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint64_t offset;
+	std::uint32_t memory;
+};
+
+class I64StoreInsnNode final : public InsnNode {
+public:
+	I64StoreInsnNode() noexcept = default;
+
+	constexpr I64StoreInsnNode(
+		std::uint32_t addr, std::uint32_t src, std::uint64_t offset = 0,
+		std::uint32_t memory = 0) noexcept
+		: addr(addr), src(src), offset(offset), memory(memory) {}
+
+	virtual ~I64StoreInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_STORE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_store(*this); }
+
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint64_t offset;
+	std::uint32_t memory;
+};
+
+class MemorySizeInsnNode final : public InsnNode {
+public:
+	MemorySizeInsnNode() noexcept = default;
+
+	constexpr MemorySizeInsnNode(std::uint32_t dst) noexcept : dst(dst) {}
+
+	virtual ~MemorySizeInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_SIZE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_size(*this); }
+
+	std::uint32_t dst;
+};
+
+class MemoryGrowInsnNode final : public InsnNode {
+public:
+	MemoryGrowInsnNode() noexcept = default;
+
+	constexpr MemoryGrowInsnNode(std::uint32_t dst, std::uint32_t delta) noexcept
+		: dst(dst), delta(delta) {}
+
+	virtual ~MemoryGrowInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_GROW; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_grow(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t delta;
+};
+
+class MemoryCopyInsnNode final : public InsnNode {
+public:
+	MemoryCopyInsnNode() noexcept = default;
+
+	constexpr MemoryCopyInsnNode(std::uint32_t dst, std::uint32_t src, std::uint32_t len) noexcept
+		: dst(dst), src(src), len(len) {}
+
+	virtual ~MemoryCopyInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_COPY; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_copy(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t src;
+	std::uint32_t len;
+};
+
+class MemoryFillInsnNode final : public InsnNode {
+public:
+	MemoryFillInsnNode() noexcept = default;
+
+	constexpr MemoryFillInsnNode(std::uint32_t dst, std::uint32_t val, std::uint32_t len) noexcept
+		: dst(dst), val(val), len(len) {}
+
+	virtual ~MemoryFillInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_FILL; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_fill(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t val;
+	std::uint32_t len;
+};
+
+class MemoryInitInsnNode final : public InsnNode {
+public:
+	MemoryInitInsnNode() noexcept = default;
+
+	constexpr MemoryInitInsnNode(
+		std::uint32_t dst, std::uint32_t src, std::uint32_t len, std::uint32_t segment) noexcept
+		: dst(dst), src(src), len(len), segment(segment) {}
+
+	virtual ~MemoryInitInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_INIT; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_init(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t src;
+	std::uint32_t len;
+	std::uint32_t segment;
+};
+
+class DataDropInsnNode final : public InsnNode {
+public:
+	DataDropInsnNode() noexcept = default;
+
+	constexpr DataDropInsnNode(std::uint32_t segment) noexcept : segment(segment) {}
+
+	virtual ~DataDropInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::DATA_DROP; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_data_drop(*this); }
+
+	std::uint32_t segment;
+};
+
+class MemoryAtomicNotifyInsnNode final : public InsnNode {
+public:
+	MemoryAtomicNotifyInsnNode() noexcept = default;
+
+	constexpr MemoryAtomicNotifyInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t count, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), count(count), offset(offset) {}
+
+	virtual ~MemoryAtomicNotifyInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_ATOMIC_NOTIFY; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_atomic_notify(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t count;
+	std::uint32_t offset;
+};
+
+class MemoryAtomicWait32InsnNode final : public InsnNode {
+public:
+	MemoryAtomicWait32InsnNode() noexcept = default;
+
+	constexpr MemoryAtomicWait32InsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t expected, std::uint32_t timeout,
+		std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), expected(expected), timeout(timeout), offset(offset) {}
+
+	virtual ~MemoryAtomicWait32InsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_ATOMIC_WAIT32; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_atomic_wait32(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t expected;
+	std::uint32_t timeout;
+	std::uint32_t offset;
+};
+
+class MemoryAtomicWait64InsnNode final : public InsnNode {
+public:
+	MemoryAtomicWait64InsnNode() noexcept = default;
+
+	constexpr MemoryAtomicWait64InsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t expected, std::uint32_t timeout,
+		std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), expected(expected), timeout(timeout), offset(offset) {}
+
+	virtual ~MemoryAtomicWait64InsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::MEMORY_ATOMIC_WAIT64; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_memory_atomic_wait64(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t expected;
+	std::uint32_t timeout;
+	std::uint32_t offset;
+};
+
+class AtomicFenceInsnNode final : public InsnNode {
+public:
+	constexpr AtomicFenceInsnNode() noexcept = default;
+
+	virtual ~AtomicFenceInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::ATOMIC_FENCE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_atomic_fence(*this); }
+};
+
+class I32AtomicLoadInsnNode final : public InsnNode {
+public:
+	I32AtomicLoadInsnNode() noexcept = default;
+
+	constexpr I32AtomicLoadInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), offset(offset) {}
+
+	virtual ~I32AtomicLoadInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_LOAD; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_load(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t offset;
+};
+
+class I64AtomicLoadInsnNode final : public InsnNode {
+public:
+	I64AtomicLoadInsnNode() noexcept = default;
+
+	constexpr I64AtomicLoadInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), offset(offset) {}
+
+	virtual ~I64AtomicLoadInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_LOAD; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_load(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t offset;
+};
+
+class I32AtomicStoreInsnNode final : public InsnNode {
+public:
+	I32AtomicStoreInsnNode() noexcept = default;
+
+	constexpr I32AtomicStoreInsnNode(
+		std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicStoreInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_STORE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_store(*this); }
+
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicStoreInsnNode final : public InsnNode {
+public:
+	I64AtomicStoreInsnNode() noexcept = default;
+
+	constexpr I64AtomicStoreInsnNode(
+		std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicStoreInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_STORE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_store(*this); }
+
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwAddInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwAddInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwAddInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicRmwAddInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_ADD; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_add(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwAddInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwAddInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwAddInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicRmwAddInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_ADD; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_add(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwSubInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwSubInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwSubInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicRmwSubInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_SUB; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_sub(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwSubInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwSubInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwSubInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicRmwSubInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_SUB; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_sub(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwAndInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwAndInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwAndInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicRmwAndInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_AND; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_and(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwAndInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwAndInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwAndInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicRmwAndInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_AND; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_and(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwOrInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwOrInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwOrInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicRmwOrInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_OR; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_or(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwOrInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwOrInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwOrInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicRmwOrInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_OR; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_or(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwXorInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwXorInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwXorInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicRmwXorInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_XOR; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_xor(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwXorInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwXorInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwXorInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicRmwXorInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_XOR; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_xor(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwXchgInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwXchgInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwXchgInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I32AtomicRmwXchgInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_XCHG; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_xchg(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwXchgInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwXchgInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwXchgInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t src, std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), src(src), offset(offset) {}
+
+	virtual ~I64AtomicRmwXchgInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_XCHG; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_xchg(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t src;
+	std::uint32_t offset;
+};
+
+class I32AtomicRmwCmpxchgInsnNode final : public InsnNode {
+public:
+	I32AtomicRmwCmpxchgInsnNode() noexcept = default;
+
+	constexpr I32AtomicRmwCmpxchgInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t expected, std::uint32_t replacement,
+		std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), expected(expected), replacement(replacement), offset(offset) {}
+
+	virtual ~I32AtomicRmwCmpxchgInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ATOMIC_RMW_CMPXCHG; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_atomic_rmw_cmpxchg(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t expected;
+	std::uint32_t replacement;
+	std::uint32_t offset;
+};
+
+class I64AtomicRmwCmpxchgInsnNode final : public InsnNode {
+public:
+	I64AtomicRmwCmpxchgInsnNode() noexcept = default;
+
+	constexpr I64AtomicRmwCmpxchgInsnNode(
+		std::uint32_t dst, std::uint32_t addr, std::uint32_t expected, std::uint32_t replacement,
+		std::uint32_t offset) noexcept
+		: dst(dst), addr(addr), expected(expected), replacement(replacement), offset(offset) {}
+
+	virtual ~I64AtomicRmwCmpxchgInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ATOMIC_RMW_CMPXCHG; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_atomic_rmw_cmpxchg(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t addr;
+	std::uint32_t expected;
+	std::uint32_t replacement;
+	std::uint32_t offset;
+};
 #if 0  //////////////////////////////////////////////////////////////////////////
 
 struct CodeMetadata {
@@ -255,6 +1155,201 @@ public:
 				visitor.on_x64_return(x.src);
 				break;
 			}
+			case InsnKind::CALL: {
+				auto& x = static_cast<CallInsnNode&>(insn);
+				visitor.on_call(x.tgt, x.base);
+				break;
+			}
+			case InsnKind::CALL_INDIRECT: {
+				auto& x = static_cast<CallIndirectInsnNode&>(insn);
+				visitor.on_call_indirect(x.type_idx, x.base, x.index, x.table);
+				break;
+			}
+			case InsnKind::CALL_PRIMITIVE: {
+				auto& x = static_cast<CallPrimitiveInsnNode&>(insn);
+				visitor.on_call_primitive(x.tgt, x.base);
+				break;
+			}
+			case InsnKind::GET_GLOBAL_X32: {
+				auto& x = static_cast<GetGlobalX32InsnNode&>(insn);
+				visitor.on_get_global_x32(x.dst, x.index);
+				break;
+			}
+			case InsnKind::GET_GLOBAL_X64: {
+				auto& x = static_cast<GetGlobalX64InsnNode&>(insn);
+				visitor.on_get_global_x64(x.dst, x.index);
+				break;
+			}
+			case InsnKind::SET_GLOBAL_X32: {
+				auto& x = static_cast<SetGlobalX32InsnNode&>(insn);
+				visitor.on_set_global_x32(x.src, x.index);
+				break;
+			}
+			case InsnKind::SET_GLOBAL_X64: {
+				auto& x = static_cast<SetGlobalX64InsnNode&>(insn);
+				visitor.on_set_global_x64(x.src, x.index);
+				break;
+			}
+			case InsnKind::I32_LOAD: {
+				auto& x = static_cast<I32LoadInsnNode&>(insn);
+				visitor.on_i32_load(x.dst, x.addr, x.offset, x.memory);
+				break;
+			}
+			case InsnKind::I64_LOAD: {
+				auto& x = static_cast<I64LoadInsnNode&>(insn);
+				visitor.on_i64_load(x.dst, x.addr, x.offset, x.memory);
+				break;
+			}
+			case InsnKind::I32_STORE: {
+				auto& x = static_cast<I32StoreInsnNode&>(insn);
+				visitor.on_i32_store(x.addr, x.src, x.offset, x.memory);
+				break;
+			}
+			case InsnKind::I64_STORE: {
+				auto& x = static_cast<I64StoreInsnNode&>(insn);
+				visitor.on_i64_store(x.addr, x.src, x.offset, x.memory);
+				break;
+			}
+			case InsnKind::MEMORY_SIZE: {
+				auto& x = static_cast<MemorySizeInsnNode&>(insn);
+				visitor.on_memory_size(x.dst);
+				break;
+			}
+			case InsnKind::MEMORY_GROW: {
+				auto& x = static_cast<MemoryGrowInsnNode&>(insn);
+				visitor.on_memory_grow(x.dst, x.delta);
+				break;
+			}
+			case InsnKind::MEMORY_COPY: {
+				auto& x = static_cast<MemoryCopyInsnNode&>(insn);
+				visitor.on_memory_copy(x.dst, x.src, x.len);
+				break;
+			}
+			case InsnKind::MEMORY_FILL: {
+				auto& x = static_cast<MemoryFillInsnNode&>(insn);
+				visitor.on_memory_fill(x.dst, x.val, x.len);
+				break;
+			}
+			case InsnKind::MEMORY_INIT: {
+				auto& x = static_cast<MemoryInitInsnNode&>(insn);
+				visitor.on_memory_init(x.dst, x.src, x.len, x.segment);
+				break;
+			}
+			case InsnKind::DATA_DROP: {
+				auto& x = static_cast<DataDropInsnNode&>(insn);
+				visitor.on_data_drop(x.segment);
+				break;
+			}
+			case InsnKind::MEMORY_ATOMIC_NOTIFY: {
+				auto& x = static_cast<MemoryAtomicNotifyInsnNode&>(insn);
+				visitor.on_memory_atomic_notify(x.dst, x.addr, x.count, x.offset);
+				break;
+			}
+			case InsnKind::MEMORY_ATOMIC_WAIT32: {
+				auto& x = static_cast<MemoryAtomicWait32InsnNode&>(insn);
+				visitor.on_memory_atomic_wait32(x.dst, x.addr, x.expected, x.timeout, x.offset);
+				break;
+			}
+			case InsnKind::MEMORY_ATOMIC_WAIT64: {
+				auto& x = static_cast<MemoryAtomicWait64InsnNode&>(insn);
+				visitor.on_memory_atomic_wait64(x.dst, x.addr, x.expected, x.timeout, x.offset);
+				break;
+			}
+			case InsnKind::ATOMIC_FENCE:
+				visitor.on_atomic_fence();
+				break;
+			case InsnKind::I32_ATOMIC_LOAD: {
+				auto& x = static_cast<I32AtomicLoadInsnNode&>(insn);
+				visitor.on_i32_atomic_load(x.dst, x.addr, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_LOAD: {
+				auto& x = static_cast<I64AtomicLoadInsnNode&>(insn);
+				visitor.on_i64_atomic_load(x.dst, x.addr, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_STORE: {
+				auto& x = static_cast<I32AtomicStoreInsnNode&>(insn);
+				visitor.on_i32_atomic_store(x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_STORE: {
+				auto& x = static_cast<I64AtomicStoreInsnNode&>(insn);
+				visitor.on_i64_atomic_store(x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_ADD: {
+				auto& x = static_cast<I32AtomicRmwAddInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_add(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_ADD: {
+				auto& x = static_cast<I64AtomicRmwAddInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_add(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_SUB: {
+				auto& x = static_cast<I32AtomicRmwSubInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_sub(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_SUB: {
+				auto& x = static_cast<I64AtomicRmwSubInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_sub(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_AND: {
+				auto& x = static_cast<I32AtomicRmwAndInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_and(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_AND: {
+				auto& x = static_cast<I64AtomicRmwAndInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_and(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_OR: {
+				auto& x = static_cast<I32AtomicRmwOrInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_or(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_OR: {
+				auto& x = static_cast<I64AtomicRmwOrInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_or(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_XOR: {
+				auto& x = static_cast<I32AtomicRmwXorInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_xor(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_XOR: {
+				auto& x = static_cast<I64AtomicRmwXorInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_xor(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_XCHG: {
+				auto& x = static_cast<I32AtomicRmwXchgInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_xchg(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_XCHG: {
+				auto& x = static_cast<I64AtomicRmwXchgInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_xchg(x.dst, x.addr, x.src, x.offset);
+				break;
+			}
+			case InsnKind::I32_ATOMIC_RMW_CMPXCHG: {
+				auto& x = static_cast<I32AtomicRmwCmpxchgInsnNode&>(insn);
+				visitor.on_i32_atomic_rmw_cmpxchg(
+					x.dst, x.addr, x.expected, x.replacement, x.offset);
+				break;
+			}
+			case InsnKind::I64_ATOMIC_RMW_CMPXCHG: {
+				auto& x = static_cast<I64AtomicRmwCmpxchgInsnNode&>(insn);
+				visitor.on_i64_atomic_rmw_cmpxchg(
+					x.dst, x.addr, x.expected, x.replacement, x.offset);
+				break;
+			}
 			default:
 				AB_ASSERT_UNREACHABLE();
 				break;
@@ -273,6 +1368,14 @@ public:
 	std::vector<std::unique_ptr<InsnNode>> insn_list;
 };
 
+/// An active data segment, copied into a memory at `offset` when the module is instantiated.
+///
+struct ActiveDataNode {
+	std::uint32_t memory = 0;
+	std::uint64_t offset = 0;
+	std::vector<Byte> bytes;
+};
+
 class ModuleNode final : public ModuleModel {
 public:
 	ModuleNode() = default;
@@ -286,9 +1389,15 @@ public:
 	virtual void accept(ModuleVisitor& visitor) override {
 		visitor.enter_module();
 		accept_type_section(visitor);
+		accept_import_section(visitor);
 		accept_export_section(visitor);
 		accept_func_section(visitor);
+		accept_table_section(visitor);
+		accept_memory_section(visitor);
+		accept_global_section(visitor);
+		accept_element_section(visitor);
 		accept_code_section(visitor);
+		accept_data_section(visitor);
 		visitor.leave_module();
 	}
 
@@ -303,6 +1412,16 @@ public:
 
 	std::vector<FuncNode> funcs;
 	std::vector<FuncType> types;
+	ImportTable imports;
+	TableTable tables;
+	ElementTable elements;
+	MemoryTable memories;
+	GlobalTable globals;
+	ExportTable exports;
+	std::vector<std::vector<Byte>> data;
+
+	/// Active data segments follow the passive segments in the data index space.
+	std::vector<ActiveDataNode> active_data;
 
 private:
 	void accept_type_section(ModuleVisitor& visitor) {
@@ -313,8 +1432,19 @@ private:
 		visitor.leave_type_section();
 	}
 
+	void accept_import_section(ModuleVisitor& visitor) {
+		visitor.enter_import_section();
+		for (const auto& entry : imports) {
+			visitor.on_import(entry.module, entry.name, entry.kind, entry.type_idx);
+		}
+		visitor.leave_import_section();
+	}
+
 	void accept_export_section(ModuleVisitor& visitor) {
 		visitor.enter_export_section();
+		for (const auto& entry : exports) {
+			visitor.on_export(entry.name, entry.kind, entry.index);
+		}
 		visitor.leave_export_section();
 	}
 
@@ -326,6 +1456,39 @@ private:
 		visitor.leave_func_section();
 	}
 
+	void accept_table_section(ModuleVisitor& visitor) {
+		visitor.enter_table_section();
+		for (const auto& entry : tables) {
+			visitor.on_table(entry.size_min, entry.size_max);
+		}
+		visitor.leave_table_section();
+	}
+
+	void accept_memory_section(ModuleVisitor& visitor) {
+		visitor.enter_memory_section();
+		for (const auto& entry : memories) {
+			visitor.on_memory(
+				entry.page_count_min, entry.page_count_max, entry.shared, entry.memory64);
+		}
+		visitor.leave_memory_section();
+	}
+
+	void accept_global_section(ModuleVisitor& visitor) {
+		visitor.enter_global_section();
+		for (const auto& entry : globals) {
+			visitor.on_global(entry.type, entry.is_mutable, entry.init);
+		}
+		visitor.leave_global_section();
+	}
+
+	void accept_element_section(ModuleVisitor& visitor) {
+		visitor.enter_element_section();
+		for (const auto& segment : elements) {
+			visitor.on_element(segment.table, segment.offset, segment.funcs);
+		}
+		visitor.leave_element_section();
+	}
+
 	void accept_code_section(ModuleVisitor& visitor) {
 		visitor.enter_code_section();
 		for (auto& func : funcs) {
@@ -333,6 +1496,17 @@ private:
 		}
 		visitor.leave_code_section();
 	}
+
+	void accept_data_section(ModuleVisitor& visitor) {
+		visitor.enter_data_section();
+		for (const auto& segment : data) {
+			visitor.on_data(segment);
+		}
+		for (const auto& segment : active_data) {
+			visitor.on_active_data(segment.memory, segment.offset, segment.bytes);
+		}
+		visitor.leave_data_section();
+	}
 };
 
 #if 0   /////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,7 @@
 #ifndef AB_MODULECONSTANTS_HPP_
 #define AB_MODULECONSTANTS_HPP_
 
+#include <cstddef>
 #include <cstdint>
 
 namespace Ab {
@@ -28,6 +29,40 @@ enum class SectionCode : std::uint8_t {
 	LAST    = DATA
 };
 
+/// The kind of definition named by an import or export.
+///
+enum class ExternalKind : std::uint8_t {
+	FUNC   = 0x0,
+	TABLE  = 0x1,
+	MEMORY = 0x2,
+	GLOBAL = 0x3,
+};
+
+/// Flags of a memory section entry.
+///
+enum class MemoryFlags : std::uint8_t {
+	NONE     = 0x0,
+	SHARED   = 0x1,
+	MEMORY64 = 0x2,
+};
+
+/// Flags of a data section entry.
+///
+enum class DataFlags : std::uint8_t {
+	/// A passive segment is only copied into memory by `memory.init`.
+	PASSIVE = 0x0,
+
+	/// An active segment is copied into a memory when the module is instantiated.
+	ACTIVE = 0x1,
+};
+
+/// Active data segments at least this large are placed so that their bytes are congruent, modulo
+/// DATA_ALIGNMENT, to the memory offset they initialize. Where the module is a file, their pages
+/// can then be mapped into the memory, rather than copied. A multiple of every supported page
+/// size.
+///
+constexpr std::size_t DATA_ALIGNMENT = std::size_t(64) << 10;
+
 enum class ValType : std::uint8_t {
 	I32     = 0x7f,  // -0x01
 	I64     = 0x7e,  // -0x02
@@ -1,8 +1,12 @@
 #ifndef AB_MODULEVISITATION_HPP_
 #define AB_MODULEVISITATION_HPP_
 
+#include <Ab/Bytes.hpp>
 #include <Ab/ModuleConstants.hpp>
 #include <Ab/Types.hpp>
+#include <absl/types/span.h>
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 namespace Ab {
@@ -79,6 +83,119 @@ public:
 	virtual void on_x32_return(std::uint8_t src) = 0;
 
 	virtual void on_x64_return(std::uint8_t src) = 0;
+
+	virtual void on_call(std::uint32_t tgt, std::uint8_t base) = 0;
+
+	virtual void on_call_indirect(
+		std::uint32_t type_idx, std::uint8_t base, std::uint8_t index, std::uint32_t table) = 0;
+
+	virtual void on_call_primitive(std::uint32_t tgt, std::uint8_t base) = 0;
+
+	// Globals
+
+	virtual void on_get_global_x32(std::uint8_t dst, std::uint32_t index) = 0;
+
+	virtual void on_get_global_x64(std::uint8_t dst, std::uint32_t index) = 0;
+
+	virtual void on_set_global_x32(std::uint8_t src, std::uint32_t index) = 0;
+
+	virtual void on_set_global_x64(std::uint8_t src, std::uint32_t index) = 0;
+
+	// Memory Access
+
+	virtual void on_i32_load(
+		std::uint8_t dst, std::uint8_t addr, std::uint64_t offset, std::uint32_t memory) = 0;
+
+	virtual void on_i64_load(
+		std::uint8_t dst, std::uint8_t addr, std::uint64_t offset, std::uint32_t memory) = 0;
+
+	virtual void on_i32_store(
+		std::uint8_t addr, std::uint8_t src, std::uint64_t offset, std::uint32_t memory) = 0;
+
+	virtual void on_i64_store(
+		std::uint8_t addr, std::uint8_t src, std::uint64_t offset, std::uint32_t memory) = 0;
+
+	virtual void on_memory_size(std::uint8_t dst) = 0;
+
+	virtual void on_memory_grow(std::uint8_t dst, std::uint8_t delta) = 0;
+
+	// Bulk Memory
+
+	virtual void on_memory_copy(std::uint8_t dst, std::uint8_t src, std::uint8_t len) = 0;
+
+	virtual void on_memory_fill(std::uint8_t dst, std::uint8_t val, std::uint8_t len) = 0;
+
+	virtual void on_memory_init(
+		std::uint8_t dst, std::uint8_t src, std::uint8_t len, std::uint32_t segment) = 0;
+
+	virtual void on_data_drop(std::uint32_t segment) = 0;
+
+	// Atomics
+
+	virtual void on_memory_atomic_notify(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t count, std::uint32_t offset) = 0;
+
+	virtual void on_memory_atomic_wait32(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t timeout,
+		std::uint32_t offset) = 0;
+
+	virtual void on_memory_atomic_wait64(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t timeout,
+		std::uint32_t offset) = 0;
+
+	virtual void on_atomic_fence() = 0;
+
+	virtual void on_i32_atomic_load(std::uint8_t dst, std::uint8_t addr, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_load(std::uint8_t dst, std::uint8_t addr, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_store(std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_store(std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_add(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_add(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_sub(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_sub(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_and(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_and(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_or(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_or(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_xor(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_xor(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_xchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_xchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) = 0;
+
+	virtual void on_i32_atomic_rmw_cmpxchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t replacement,
+		std::uint32_t offset) = 0;
+
+	virtual void on_i64_atomic_rmw_cmpxchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t replacement,
+		std::uint32_t offset) = 0;
 };
 
 /// A function visitor that does nothing--useful as a base class.
@@ -108,6 +225,110 @@ public:
 	virtual void on_x32_return(std::uint8_t) override {}
 
 	virtual void on_x64_return(std::uint8_t) override {}
+
+	virtual void on_call(std::uint32_t, std::uint8_t) override {}
+
+	virtual void on_call_indirect(
+		std::uint32_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_call_primitive(std::uint32_t, std::uint8_t) override {}
+
+	// Globals
+
+	virtual void on_get_global_x32(std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_get_global_x64(std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_set_global_x32(std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_set_global_x64(std::uint8_t, std::uint32_t) override {}
+
+	// Memory Access
+
+	virtual void on_i32_load(std::uint8_t, std::uint8_t, std::uint64_t, std::uint32_t) override {}
+
+	virtual void on_i64_load(std::uint8_t, std::uint8_t, std::uint64_t, std::uint32_t) override {}
+
+	virtual void on_i32_store(std::uint8_t, std::uint8_t, std::uint64_t, std::uint32_t) override {}
+
+	virtual void on_i64_store(std::uint8_t, std::uint8_t, std::uint64_t, std::uint32_t) override {}
+
+	virtual void on_memory_size(std::uint8_t) override {}
+
+	virtual void on_memory_grow(std::uint8_t, std::uint8_t) override {}
+
+	// Bulk Memory
+
+	virtual void on_memory_copy(std::uint8_t, std::uint8_t, std::uint8_t) override {}
+
+	virtual void on_memory_fill(std::uint8_t, std::uint8_t, std::uint8_t) override {}
+
+	virtual void on_memory_init(std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_data_drop(std::uint32_t) override {}
+
+	// Atomics
+
+	virtual void on_memory_atomic_notify(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_memory_atomic_wait32(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_memory_atomic_wait64(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_atomic_fence() override {}
+
+	virtual void on_i32_atomic_load(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_load(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_store(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_store(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_add(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_add(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_sub(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_sub(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_and(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_and(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_or(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_or(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_xor(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_xor(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_xchg(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_xchg(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i32_atomic_rmw_cmpxchg(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_i64_atomic_rmw_cmpxchg(
+		std::uint8_t, std::uint8_t, std::uint8_t, std::uint8_t, std::uint32_t) override {}
 };
 
 class CodeModel {
@@ -137,6 +358,16 @@ public:
 
 	virtual void on_type(const FuncType& type) = 0;
 
+	// Import Section
+
+	virtual void enter_import_section() = 0;
+
+	virtual void leave_import_section() = 0;
+
+	virtual void on_import(
+		std::string_view module, std::string_view name, ExternalKind kind,
+		std::uint32_t type_idx) = 0;
+
 	// Func Section
 
 	virtual void enter_func_section() = 0;
@@ -145,12 +376,49 @@ public:
 
 	virtual void on_func(std::uint32_t type_idx) = 0;
 
+	// Table Section
+
+	virtual void enter_table_section() = 0;
+
+	virtual void leave_table_section() = 0;
+
+	virtual void on_table(std::uint32_t size_min, std::uint32_t size_max) = 0;
+
+	// Memory Section
+
+	virtual void enter_memory_section() = 0;
+
+	virtual void leave_memory_section() = 0;
+
+	virtual void on_memory(
+		std::uint64_t page_count_min, std::uint64_t page_count_max, bool shared,
+		bool memory64) = 0;
+
+	// Global Section
+
+	virtual void enter_global_section() = 0;
+
+	virtual void leave_global_section() = 0;
+
+	virtual void on_global(ValType type, bool is_mutable, std::uint64_t init) = 0;
+
 	// Export Section
 
 	virtual void enter_export_section() = 0;
 
 	virtual void leave_export_section() = 0;
 
+	virtual void on_export(std::string_view name, ExternalKind kind, std::uint32_t index) = 0;
+
+	// Element Section
+
+	virtual void enter_element_section() = 0;
+
+	virtual void leave_element_section() = 0;
+
+	virtual void on_element(
+		std::uint32_t table, std::uint32_t offset, absl::Span<const std::uint32_t> funcs) = 0;
+
 	// Code Section
 
 	virtual void enter_code_section() = 0;
@@ -158,6 +426,17 @@ public:
 	virtual void leave_code_section() = 0;
 
 	virtual void on_code(CodeModel& model) = 0;
+
+	// Data Section
+
+	virtual void enter_data_section() = 0;
+
+	virtual void leave_data_section() = 0;
+
+	virtual void on_data(absl::Span<const Byte> bytes) = 0;
+
+	virtual void
+	on_active_data(std::uint32_t memory, std::uint64_t offset, absl::Span<const Byte> bytes) = 0;
 };
 
 /// Basic visitor that does nothing by default.
@@ -180,6 +459,15 @@ public:
 
 	virtual void on_type(const FuncType&) override {}
 
+	// Import Section
+
+	virtual void enter_import_section() override {}
+
+	virtual void leave_import_section() override {}
+
+	virtual void on_import(
+		std::string_view, std::string_view, ExternalKind, std::uint32_t) override {}
+
 	// Func Section
 
 	virtual void enter_func_section() override {}
@@ -188,12 +476,47 @@ public:
 
 	virtual void on_func(std::uint32_t) override {}
 
+	// Table Section
+
+	virtual void enter_table_section() override {}
+
+	virtual void leave_table_section() override {}
+
+	virtual void on_table(std::uint32_t, std::uint32_t) override {}
+
+	// Memory Section
+
+	virtual void enter_memory_section() override {}
+
+	virtual void leave_memory_section() override {}
+
+	virtual void on_memory(std::uint64_t, std::uint64_t, bool, bool) override {}
+
+	// Global Section
+
+	virtual void enter_global_section() override {}
+
+	virtual void leave_global_section() override {}
+
+	virtual void on_global(ValType, bool, std::uint64_t) override {}
+
 	// Export Section
 
 	virtual void enter_export_section() override {}
 
 	virtual void leave_export_section() override {}
 
+	virtual void on_export(std::string_view, ExternalKind, std::uint32_t) override {}
+
+	// Element Section
+
+	virtual void enter_element_section() override {}
+
+	virtual void leave_element_section() override {}
+
+	virtual void on_element(
+		std::uint32_t, std::uint32_t, absl::Span<const std::uint32_t>) override {}
+
 	// Code Section
 
 	virtual void enter_code_section() override {}
@@ -201,6 +524,16 @@ public:
 	virtual void leave_code_section() override {}
 
 	virtual void on_code(CodeModel&) override {}
+
+	// Data Section
+
+	virtual void enter_data_section() override {}
+
+	virtual void leave_data_section() override {}
+
+	virtual void on_data(absl::Span<const Byte>) override {}
+
+	virtual void on_active_data(std::uint32_t, std::uint64_t, absl::Span<const Byte>) override {}
 };
 
 class ModuleModel {
@@ -2,6 +2,7 @@
 #define AB_MODULEWRITER_HPP_
 
 #include <Ab/Config.hpp>
+#include <Ab/Assert.hpp>
 #include <Ab/ByteBuffer.hpp>
 #include <Ab/Bytes.hpp>
 #include <Ab/ModuleVisitation.hpp>
@@ -11,6 +12,7 @@
 #include <Ab/VectorUtilities.hpp>
 #include <absl/types/span.h>
 #include <limits>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -34,6 +36,11 @@ class CodeWriter final : public CodeVisitor {
 public:
 	CodeWriter() {}
 
+	/// A writer for a function of a module with the given memories. Accesses to a memory64 memory
+	/// are written in their 64-bit address form.
+	///
+	explicit CodeWriter(std::vector<bool> memory64) : memory64_(std::move(memory64)) {}
+
 	virtual ~CodeWriter() = default;
 
 	virtual void enter_code(std::uint32_t nregs) override { nregs_ = nregs; }
@@ -65,6 +72,314 @@ public:
 		body_.append(src);
 	}
 
+	virtual void on_call(std::uint32_t tgt, std::uint8_t base) override {
+		body_.append(Opcode::CALL);
+		body_.append(tgt);
+		body_.append(base);
+	}
+
+	virtual void on_call_indirect(
+		std::uint32_t type_idx, std::uint8_t base, std::uint8_t index,
+		std::uint32_t table) override {
+		body_.append(Opcode::CALL_INDIRECT);
+		body_.append(type_idx);
+		body_.append(base);
+		body_.append(index);
+		body_.append(table);
+	}
+
+	virtual void on_call_primitive(std::uint32_t tgt, std::uint8_t base) override {
+		body_.append(Opcode::CALL_PRIMITIVE);
+		body_.append(tgt);
+		body_.append(base);
+	}
+
+	virtual void on_get_global_x32(std::uint8_t dst, std::uint32_t index) override {
+		body_.append(Opcode::GET_GLOBAL_X32);
+		body_.append(dst);
+		body_.append(index);
+	}
+
+	virtual void on_get_global_x64(std::uint8_t dst, std::uint32_t index) override {
+		body_.append(Opcode::GET_GLOBAL_X64);
+		body_.append(dst);
+		body_.append(index);
+	}
+
+	virtual void on_set_global_x32(std::uint8_t src, std::uint32_t index) override {
+		body_.append(Opcode::SET_GLOBAL_X32);
+		body_.append(src);
+		body_.append(index);
+	}
+
+	virtual void on_set_global_x64(std::uint8_t src, std::uint32_t index) override {
+		body_.append(Opcode::SET_GLOBAL_X64);
+		body_.append(src);
+		body_.append(index);
+	}
+
+	virtual void on_i32_load(
+		std::uint8_t dst, std::uint8_t addr, std::uint64_t offset, std::uint32_t memory) override {
+		append_access(
+			Opcode::I32_LOAD, Opcode::I32_LOAD_MEM, Opcode::I32_LOAD_A64, dst, addr, offset,
+			memory);
+	}
+
+	virtual void on_i64_load(
+		std::uint8_t dst, std::uint8_t addr, std::uint64_t offset, std::uint32_t memory) override {
+		append_access(
+			Opcode::I64_LOAD, Opcode::I64_LOAD_MEM, Opcode::I64_LOAD_A64, dst, addr, offset,
+			memory);
+	}
+
+	virtual void on_i32_store(
+		std::uint8_t addr, std::uint8_t src, std::uint64_t offset, std::uint32_t memory) override {
+		append_access(
+			Opcode::I32_STORE, Opcode::I32_STORE_MEM, Opcode::I32_STORE_A64, addr, src, offset,
+			memory);
+	}
+
+	virtual void on_i64_store(
+		std::uint8_t addr, std::uint8_t src, std::uint64_t offset, std::uint32_t memory) override {
+		append_access(
+			Opcode::I64_STORE, Opcode::I64_STORE_MEM, Opcode::I64_STORE_A64, addr, src, offset,
+			memory);
+	}
+
+	virtual void on_memory_size(std::uint8_t dst) override {
+		body_.append(Opcode::MEMORY_SIZE);
+		body_.append(dst);
+	}
+
+	virtual void on_memory_grow(std::uint8_t dst, std::uint8_t delta) override {
+		body_.append(Opcode::MEMORY_GROW);
+		body_.append(dst);
+		body_.append(delta);
+	}
+
+	virtual void on_memory_copy(std::uint8_t dst, std::uint8_t src, std::uint8_t len) override {
+		body_.append(Opcode::MEMORY_COPY);
+		body_.append(dst);
+		body_.append(src);
+		body_.append(len);
+	}
+
+	virtual void on_memory_fill(std::uint8_t dst, std::uint8_t val, std::uint8_t len) override {
+		body_.append(Opcode::MEMORY_FILL);
+		body_.append(dst);
+		body_.append(val);
+		body_.append(len);
+	}
+
+	virtual void on_memory_init(
+		std::uint8_t dst, std::uint8_t src, std::uint8_t len, std::uint32_t segment) override {
+		body_.append(Opcode::MEMORY_INIT);
+		body_.append(dst);
+		body_.append(src);
+		body_.append(len);
+		body_.append(segment);
+	}
+
+	virtual void on_data_drop(std::uint32_t segment) override {
+		body_.append(Opcode::DATA_DROP);
+		body_.append(segment);
+	}
+
+	virtual void on_memory_atomic_notify(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t count, std::uint32_t offset) override {
+		body_.append(Opcode::MEMORY_ATOMIC_NOTIFY);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(count);
+		body_.append(offset);
+	}
+
+	virtual void on_memory_atomic_wait32(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t timeout,
+		std::uint32_t offset) override {
+		body_.append(Opcode::MEMORY_ATOMIC_WAIT32);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(expected);
+		body_.append(timeout);
+		body_.append(offset);
+	}
+
+	virtual void on_memory_atomic_wait64(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t timeout,
+		std::uint32_t offset) override {
+		body_.append(Opcode::MEMORY_ATOMIC_WAIT64);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(expected);
+		body_.append(timeout);
+		body_.append(offset);
+	}
+
+	virtual void on_atomic_fence() override { body_.append(Opcode::ATOMIC_FENCE); }
+
+	virtual void on_i32_atomic_load(
+		std::uint8_t dst, std::uint8_t addr, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_LOAD);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_load(
+		std::uint8_t dst, std::uint8_t addr, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_LOAD);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_store(
+		std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_STORE);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_store(
+		std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_STORE);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_add(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_ADD);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_add(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_ADD);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_sub(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_SUB);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_sub(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_SUB);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_and(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_AND);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_and(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_AND);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_or(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_OR);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_or(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_OR);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_xor(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_XOR);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_xor(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_XOR);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_xchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_XCHG);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_xchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t src, std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_XCHG);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(src);
+		body_.append(offset);
+	}
+
+	virtual void on_i32_atomic_rmw_cmpxchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t replacement,
+		std::uint32_t offset) override {
+		body_.append(Opcode::I32_ATOMIC_RMW_CMPXCHG);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(expected);
+		body_.append(replacement);
+		body_.append(offset);
+	}
+
+	virtual void on_i64_atomic_rmw_cmpxchg(
+		std::uint8_t dst, std::uint8_t addr, std::uint8_t expected, std::uint8_t replacement,
+		std::uint32_t offset) override {
+		body_.append(Opcode::I64_ATOMIC_RMW_CMPXCHG);
+		body_.append(dst);
+		body_.append(addr);
+		body_.append(expected);
+		body_.append(replacement);
+		body_.append(offset);
+	}
+
 	void append_to(ByteBuffer& buffer) const {
 		ByteBuffer content;
 
@@ -76,8 +391,34 @@ public:
 	}
 
 private:
+	/// Append a load or store. Accesses to memory 0 use the short form, which finds the memory in
+	/// the execution state. Accesses to a memory64 use the 64-bit address form, with a 64-bit
+	/// offset, and always name their memory.
+	///
+	void append_access(
+		Opcode op, Opcode op_mem, Opcode op_a64, std::uint8_t a, std::uint8_t b,
+		std::uint64_t offset, std::uint32_t memory) {
+		if (memory < memory64_.size() && memory64_[memory]) {
+			body_.append(op_a64);
+			body_.append(a);
+			body_.append(b);
+			body_.append(offset);
+			body_.append(memory);
+			return;
+		}
+		AB_ASSERT(offset <= std::numeric_limits<std::uint32_t>::max());
+		body_.append(memory == 0 ? op : op_mem);
+		body_.append(a);
+		body_.append(b);
+		body_.append(std::uint32_t(offset));
+		if (memory != 0) {
+			body_.append(memory);
+		}
+	}
+
 	std::uint32_t nregs_;
 	ByteBuffer body_;
+	std::vector<bool> memory64_;
 };
 
 /// The module writer is itself a visitor.
@@ -108,6 +449,18 @@ public:
 
 	virtual void on_type(const FuncType& type) override { type_entries_.push_back(type); }
 
+	// Import Section
+
+	virtual void enter_import_section() override {}
+
+	virtual void leave_import_section() override {}
+
+	virtual void on_import(
+		std::string_view module, std::string_view name, ExternalKind kind,
+		std::uint32_t type_idx) override {
+		import_entries_.push_back({std::string(module), std::string(name), kind, type_idx});
+	}
+
 	// Func Section
 
 	virtual void enter_func_section() override {}
@@ -116,27 +469,147 @@ public:
 
 	virtual void on_func(std::uint32_t type_idx) override { func_entries_.push_back(type_idx); }
 
+	// Table Section
+
+	virtual void enter_table_section() override {}
+
+	virtual void leave_table_section() override {}
+
+	virtual void on_table(std::uint32_t size_min, std::uint32_t size_max) override {
+		table_entries_.push_back({size_min, size_max});
+	}
+
+	// Memory Section
+
+	virtual void enter_memory_section() override {}
+
+	virtual void leave_memory_section() override {}
+
+	virtual void on_memory(
+		std::uint64_t page_count_min, std::uint64_t page_count_max, bool shared,
+		bool memory64) override {
+		memory_entries_.push_back({page_count_min, page_count_max, shared, memory64});
+	}
+
+	// Global Section
+
+	virtual void enter_global_section() override {}
+
+	virtual void leave_global_section() override {}
+
+	virtual void on_global(ValType type, bool is_mutable, std::uint64_t init) override {
+		global_entries_.push_back({type, is_mutable, init});
+	}
+
 	// Export Section
 
 	virtual void enter_export_section() override {}
 
 	virtual void leave_export_section() override {}
 
+	virtual void on_export(std::string_view name, ExternalKind kind, std::uint32_t index) override {
+		export_entries_.push_back({std::string(name), kind, index});
+	}
+
+	// Element Section
+
+	virtual void enter_element_section() override {}
+
+	virtual void leave_element_section() override {}
+
+	virtual void on_element(
+		std::uint32_t table, std::uint32_t offset,
+		absl::Span<const std::uint32_t> funcs) override {
+		element_entries_.push_back({table, offset, {funcs.begin(), funcs.end()}});
+	}
+
 	// Code Section
 
 	virtual void enter_code_section() override {}
 
 	virtual void leave_code_section() override {}
 
-	virtual void on_code(CodeModel& model) override { model.accept(push(code_entries_)); }
+	virtual void on_code(CodeModel& model) override {
+		std::vector<bool> memory64;
+		for (const auto& entry : memory_entries_) {
+			memory64.push_back(entry.memory64);
+		}
+		model.accept(code_entries_.emplace_back(std::move(memory64)));
+	}
+
+	// Data Section
+
+	virtual void enter_data_section() override {}
+
+	virtual void leave_data_section() override {}
+
+	virtual void on_data(absl::Span<const Byte> bytes) override {
+		data_entries_.push_back({false, 0, 0, {bytes.begin(), bytes.end()}});
+	}
+
+	virtual void on_active_data(
+		std::uint32_t memory, std::uint64_t offset, absl::Span<const Byte> bytes) override {
+		data_entries_.push_back({true, memory, offset, {bytes.begin(), bytes.end()}});
+	}
 
 private:
+	struct ImportRecord {
+		std::string module;
+		std::string name;
+		ExternalKind kind;
+		std::uint32_t type_idx;
+	};
+
+	struct TableRecord {
+		std::uint32_t size_min;
+		std::uint32_t size_max;
+	};
+
+	struct ElementRecord {
+		std::uint32_t table;
+		std::uint32_t offset;
+		std::vector<std::uint32_t> funcs;
+	};
+
+	struct MemoryRecord {
+		std::uint64_t page_count_min;
+		std::uint64_t page_count_max;
+		bool shared;
+		bool memory64;
+	};
+
+	struct GlobalRecord {
+		ValType type;
+		bool is_mutable;
+		std::uint64_t init;
+	};
+
+	struct ExportRecord {
+		std::string name;
+		ExternalKind kind;
+		std::uint32_t index;
+	};
+
+	struct DataRecord {
+		bool active;
+		std::uint32_t memory;
+		std::uint64_t offset;
+		std::vector<Byte> bytes;
+	};
+
 	void append_module(ByteBuffer& buffer) const {
 		buffer.append(MODULE_MAGIC);
 		buffer.append(MODULE_VERSION);
 		append_type_section(buffer);
+		append_import_section(buffer);
 		append_func_section(buffer);
+		append_table_section(buffer);
+		append_memory_section(buffer);
+		append_global_section(buffer);
+		append_export_section(buffer);
+		append_element_section(buffer);
 		append_code_section(buffer);
+		append_data_section(buffer);
 	}
 
 	void append_type_section(ByteBuffer& buffer) const {
@@ -156,6 +629,26 @@ private:
 		buffer.append(content);
 	}
 
+	void append_import_section(ByteBuffer& buffer) const {
+		if (import_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, import_entries_.size());
+		for (const auto& entry : import_entries_) {
+			append_name(content, entry.module);
+			append_name(content, entry.name);
+			content.append(entry.kind);
+			append_varuint32(content, entry.type_idx);
+		}
+
+		buffer.append(SectionCode::IMPORT);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
 	void append_func_section(ByteBuffer& buffer) const {
 		if (func_entries_.size() == 0) {
 			return;
@@ -173,6 +666,124 @@ private:
 		buffer.append(content);
 	}
 
+	/// Each table is it's minimum and maximum size, in slots.
+	///
+	void append_table_section(ByteBuffer& buffer) const {
+		if (table_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, table_entries_.size());
+		for (const auto& entry : table_entries_) {
+			append_varuint32(content, entry.size_min);
+			append_varuint32(content, entry.size_max);
+		}
+
+		buffer.append(SectionCode::TABLE);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
+	/// Each memory is it's flags, then it's minimum and maximum page counts. The page counts of a
+	/// memory64 are 64 bits wide.
+	///
+	void append_memory_section(ByteBuffer& buffer) const {
+		if (memory_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, memory_entries_.size());
+		for (const auto& entry : memory_entries_) {
+			std::uint8_t flags = std::uint8_t(MemoryFlags::NONE);
+			if (entry.shared) {
+				flags |= std::uint8_t(MemoryFlags::SHARED);
+			}
+			if (entry.memory64) {
+				flags |= std::uint8_t(MemoryFlags::MEMORY64);
+			}
+			content.append(flags);
+			if (entry.memory64) {
+				append_varuint64(content, entry.page_count_min);
+				append_varuint64(content, entry.page_count_max);
+			} else {
+				append_varuint32(content, entry.page_count_min);
+				append_varuint32(content, entry.page_count_max);
+			}
+		}
+
+		buffer.append(SectionCode::MEMORY);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
+	/// Each global is it's type, a mutable flag, and the raw 8-byte initial value.
+	///
+	void append_global_section(ByteBuffer& buffer) const {
+		if (global_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, global_entries_.size());
+		for (const auto& entry : global_entries_) {
+			content.append(entry.type);
+			content.append(std::uint8_t(entry.is_mutable));
+			content.append(entry.init);
+		}
+
+		buffer.append(SectionCode::GLOBAL);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
+	void append_export_section(ByteBuffer& buffer) const {
+		if (export_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, export_entries_.size());
+		for (const auto& entry : export_entries_) {
+			append_name(content, entry.name);
+			content.append(entry.kind);
+			append_varuint32(content, entry.index);
+		}
+
+		buffer.append(SectionCode::EXPORT);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
+	/// Each element segment is it's table, it's offset in the table, and it's function indices.
+	///
+	void append_element_section(ByteBuffer& buffer) const {
+		if (element_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, element_entries_.size());
+		for (const auto& entry : element_entries_) {
+			append_varuint32(content, entry.table);
+			append_varuint32(content, entry.offset);
+			append_varuint32(content, entry.funcs.size());
+			for (auto func : entry.funcs) {
+				append_varuint32(content, func);
+			}
+		}
+
+		buffer.append(SectionCode::ELEMENT);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
 	void append_code_section(ByteBuffer& buffer) const {
 		if (code_entries_.size() == 0) {
 			return;
@@ -190,9 +801,68 @@ private:
 		buffer.append(content);
 	}
 
+	/// Each data segment is it's flags, then for an active segment, it's memory and offset. Then
+	/// the segment's size, the size of the padding before it's bytes, the padding, and the bytes.
+	///
+	/// Large active segments are padded, so their bytes are congruent to their memory offset,
+	/// modulo DATA_ALIGNMENT. The padding and the section size are written with a fixed width, so
+	/// the position of every byte is known before the section is written.
+	///
+	void append_data_section(ByteBuffer& buffer) const {
+		if (data_entries_.size() == 0) {
+			return;
+		}
+
+		constexpr std::size_t SIZE_BYTES    = 5;
+		constexpr std::size_t PADDING_BYTES = 3;
+
+		ByteBuffer content;
+
+		// The position of the content in the module.
+		std::size_t start = buffer.size() + sizeof(SectionCode) + SIZE_BYTES;
+
+		append_varuint32(content, data_entries_.size());
+		for (const auto& entry : data_entries_) {
+			auto flags = entry.active ? DataFlags::ACTIVE : DataFlags::PASSIVE;
+			content.append(std::uint8_t(flags));
+			if (entry.active) {
+				append_varuint32(content, entry.memory);
+				append_varuint64(content, entry.offset);
+			}
+			append_varuint32(content, entry.bytes.size());
+
+			std::size_t padding = 0;
+			if (entry.active && entry.bytes.size() >= DATA_ALIGNMENT) {
+				std::size_t position = start + content.size() + PADDING_BYTES;
+				padding = (entry.offset - position) % DATA_ALIGNMENT;
+			}
+			append_padded_varuint<32>(content, std::uint32_t(padding), PADDING_BYTES);
+			for (std::size_t i = 0; i < padding; ++i) {
+				content.append(std::uint8_t(0));
+			}
+			content.append(entry.bytes.data(), entry.bytes.size());
+		}
+
+		buffer.append(SectionCode::DATA);
+		append_padded_varuint<32>(buffer, std::uint32_t(content.size()), SIZE_BYTES);
+		buffer.append(content);
+	}
+
+	static void append_name(ByteBuffer& buffer, const std::string& name) {
+		append_varuint32(buffer, name.size());
+		buffer.append(reinterpret_cast<const Byte*>(name.data()), name.size());
+	}
+
 	std::vector<FuncType> type_entries_;
+	std::vector<ImportRecord> import_entries_;
 	std::vector<std::uint32_t> func_entries_;
+	std::vector<TableRecord> table_entries_;
+	std::vector<MemoryRecord> memory_entries_;
+	std::vector<GlobalRecord> global_entries_;
+	std::vector<ExportRecord> export_entries_;
+	std::vector<ElementRecord> element_entries_;
 	std::vector<CodeWriter> code_entries_;
+	std::vector<DataRecord> data_entries_;
 };
 
 template <typename M>
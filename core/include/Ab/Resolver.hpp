@@ -6,7 +6,10 @@
 
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <utility>
@@ -18,12 +21,6 @@ class FuncInst;
 
 enum class ExternType { FUNC, GLOBAL, MEMORY };
 
-struct Import {
-	std::string module;
-	std::string component;
-	ExternType type;
-};
-
 enum class ExternValKind { UNRESOLVED, ERROR, FUNC };
 
 /// A record of a value available for either import or export.
@@ -74,15 +71,38 @@ public:
 /// The global resolver.
 /// Resolve symbols from the global namespace.
 ///
+/// Definitions are indexed by (module, symbol), so resolving an import is a single hash lookup,
+/// however many host functions and modules are defined. Thread safe.
+///
 class BasicResolver final : public Resolver {
 public:
 	BasicResolver() {}
 
 	virtual ~BasicResolver() noexcept override = default;
 
-	virtual ExternVal resolve(std::string_view module, std::string_view symbol) override {
-		return ExternVal();
-	}
+	/// Define a single function, such as a host function. The function must outlive every
+	/// instance linked against it. A later definition of the same name replaces an earlier one.
+	///
+	void define(std::string_view module, std::string_view symbol, FuncInst* func);
+
+	/// Define every function exported by a linked instance, under the given module name.
+	///
+	void define_module(std::string_view module, ModuleInst* inst);
+
+	virtual ExternVal resolve(std::string_view module, std::string_view symbol) override;
+
+private:
+	static std::string key(std::string_view module, std::string_view symbol);
+
+	std::mutex lock_;
+	std::unordered_map<std::string, ExternVal> index_;
+};
+
+/// Thrown when a module's imports can not be bound.
+///
+class LinkError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
 };
 
 class Linker {
@@ -92,14 +112,22 @@ public:
 	virtual void link(ModuleInst* module) = 0;
 };
 
-/// Simple linker that does no resolution.
-/// If there is a resolution that needs to be complete, the link fails.
+/// Linker that binds each import through a resolver.
+///
+/// Imports are resolved once, at link time, and bound directly into the instance's function
+/// table. Calling an imported function costs the same as calling a local one. If an import is
+/// unresolved, or has the wrong type, the link fails with a LinkError.
 ///
 class BasicLinker final : public Linker {
 public:
+	explicit BasicLinker(Resolver* resolver) noexcept : resolver_(resolver) {}
+
 	virtual ~BasicLinker() noexcept override = default;
 
-	virtual void link(ModuleInst* module) override {}
+	virtual void link(ModuleInst* module) override;
+
+private:
+	Resolver* resolver_;
 };
 
 }  // namespace Ab
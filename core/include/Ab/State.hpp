@@ -5,10 +5,13 @@
 #include <Ab/Address.hpp>
 #include <Ab/State.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 
 namespace Ab {
 
+class LinearMemory;
+
 /// Storage for saving machine registers at interpreter entry.
 /// NOTE: THIS CLASS IS WIP AND NOT USED
 ///
@@ -51,17 +54,25 @@ static_assert(sizeof(Flags) == 2);
 /// Primary state is cached in the interpreter, and kept in registers if possible.
 /// The state is only reflected back into the struct explicitly, when needed.
 ///
+/// The base and size of memory 0 are cached here, so memory-0 loads and stores check their bounds
+/// without reaching through the LinearMemory. The cache is refreshed when memory 0 grows, and at
+/// call boundaries when the memory's epoch has moved on. See `ExecStateB::memory_epoch`.
+///
 struct ExecStateA {
 	const Byte* ip;
 	Byte* sp;
 	FuncInst* fn;
+	Byte* mem_base;
+	std::uint64_t mem_size;
 };
 
 static_assert(std::is_standard_layout<ExecStateA>::value);
 static_assert(offsetof(ExecStateA, ip) == 0);
 static_assert(offsetof(ExecStateA, sp) == 8);
 static_assert(offsetof(ExecStateA, fn) == 16);
-static_assert(sizeof(ExecStateA) == 24);
+static_assert(offsetof(ExecStateA, mem_base) == 24);
+static_assert(offsetof(ExecStateA, mem_size) == 32);
+static_assert(sizeof(ExecStateA) == 40);
 
 /// Secondary state is kept in memory and up-to-date. Frequently accessed data
 /// should be placed in the primary state and cached in registers during execution.
@@ -72,6 +83,8 @@ struct ExecStateB {
 	Byte* stack;
 	ExecCond condition;
 	Flags flags;
+	LinearMemory* memory;        ///< Memory 0 of func's instance, cached for memory-0 instructions.
+	std::uint64_t memory_epoch;  ///< The epoch of memory 0 when it's base and size were cached.
 };
 
 static_assert(std::is_standard_layout<ExecStateB>::value);
@@ -79,7 +92,9 @@ static_assert(offsetof(ExecStateB, func) == 0);
 static_assert(offsetof(ExecStateB, stack) == 8);
 static_assert(offsetof(ExecStateB, condition) == 16);
 static_assert(offsetof(ExecStateB, flags) == 17);
-static_assert(sizeof(ExecStateB) == 24);
+static_assert(offsetof(ExecStateB, memory) == 24);
+static_assert(offsetof(ExecStateB, memory_epoch) == 32);
+static_assert(sizeof(ExecStateB) == 40);
 
 /// Interpreter state is divided into primary and secondary state.
 /// primary state is frequently accessed, and typically cached in local registers.
@@ -93,9 +108,9 @@ struct ExecState {
 
 static_assert(std::is_standard_layout<ExecState>::value);
 static_assert(offsetof(ExecState, st_a) == 0);
-static_assert(offsetof(ExecState, st_b) == 24);
-static_assert(offsetof(ExecState, entry_save_area) == 48);
-static_assert(sizeof(ExecState) == 64);
+static_assert(offsetof(ExecState, st_b) == 40);
+static_assert(offsetof(ExecState, entry_save_area) == 80);
+static_assert(sizeof(ExecState) == 96);
 
 }  // namespace Ab
 
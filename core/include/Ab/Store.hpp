@@ -1,19 +1,221 @@
 #ifndef AB_STORE_HPP_
 #define AB_STORE_HPP_
 
+#include <Ab/Config.hpp>
+#include <Ab/Assert.hpp>
+#include <Ab/Func.hpp>
+#include <Ab/Module.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
 namespace Ab {
 
-class FuncStore {};
+/// A reference to an object in an Arena.
+///
+/// A handle is a 32-bit slot index and a 32-bit generation. Destroying an object bumps the
+/// generation of it's slot, so a stale handle never resolves to the slot's next occupant.
+///
+template <typename T>
+class Handle {
+public:
+	constexpr Handle() noexcept : index_(INVALID), generation_(0) {}
+
+	constexpr Handle(std::uint32_t index, std::uint32_t generation) noexcept
+		: index_(index), generation_(generation) {}
+
+	constexpr std::uint32_t index() const noexcept { return index_; }
+
+	constexpr std::uint32_t generation() const noexcept { return generation_; }
+
+	constexpr bool valid() const noexcept { return index_ != INVALID; }
+
+	constexpr explicit operator bool() const noexcept { return valid(); }
+
+	constexpr bool operator==(const Handle& rhs) const noexcept {
+		return index_ == rhs.index_ && generation_ == rhs.generation_;
+	}
+
+	constexpr bool operator!=(const Handle& rhs) const noexcept { return !(*this == rhs); }
+
+private:
+	static constexpr std::uint32_t INVALID = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint32_t index_;
+	std::uint32_t generation_;
+};
+
+/// A typed slab arena.
+///
+/// Objects are constructed in place, in fixed-size chunks of slots, so an object never moves and
+/// creating one is usually a pop from the free list. Destroyed slots are reused. Objects are
+/// addressed by handle, or by the pointer returned on creation.
+///
+/// Not thread safe.
+///
+template <typename T>
+class Arena {
+public:
+	/// The number of slots allocated at a time.
+	///
+	static constexpr std::size_t CHUNK_SIZE = 64;
+
+	Arena() noexcept = default;
+
+	Arena(const Arena&) = delete;
+
+	~Arena() noexcept { clear(); }
+
+	Arena& operator=(const Arena&) = delete;
+
+	/// Construct an object in the arena.
+	///
+	template <typename... Args>
+	Handle<T> create(Args&&... args) {
+		std::uint32_t index = allocate_slot();
+		Slot& slot          = slot_at(index);
+		try {
+			new (slot.storage) T(std::forward<Args>(args)...);
+		} catch (...) {
+			free_.push_back(index);
+			throw;
+		}
+		slot.live = true;
+		++size_;
+		return Handle<T>(index, slot.generation);
+	}
 
-class GlobalStore {};
+	/// Resolve a handle. Null if the handle is stale, or invalid.
+	///
+	T* get(Handle<T> handle) noexcept {
+		if (handle.index() >= capacity()) {
+			return nullptr;
+		}
+		Slot& slot = slot_at(handle.index());
+		if (!slot.live || slot.generation != handle.generation()) {
+			return nullptr;
+		}
+		return slot.object();
+	}
+
+	const T* get(Handle<T> handle) const noexcept { return const_cast<Arena*>(this)->get(handle); }
+
+	/// Destroy the object referenced by a live handle.
+	///
+	void destroy(Handle<T> handle) noexcept {
+		AB_ASSERT(get(handle) != nullptr);
+		release(handle.index());
+	}
+
+	/// Destroy every object in the arena, in reverse order of slot. The slots are kept for reuse.
+	///
+	void clear() noexcept {
+		for (std::size_t i = capacity(); i > 0; --i) {
+			if (slot_at(i - 1).live) {
+				release(std::uint32_t(i - 1));
+			}
+		}
+	}
+
+	/// The number of live objects.
+	///
+	std::size_t size() const noexcept { return size_; }
+
+	/// The number of slots, live and free.
+	///
+	std::size_t capacity() const noexcept { return chunks_.size() * CHUNK_SIZE; }
+
+private:
+	struct Slot {
+		T* object() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+
+		alignas(T) unsigned char storage[sizeof(T)];
+		std::uint32_t generation = 0;
+		bool live                = false;
+	};
+
+	Slot& slot_at(std::size_t index) noexcept {
+		return chunks_[index / CHUNK_SIZE][index % CHUNK_SIZE];
+	}
+
+	std::uint32_t allocate_slot() {
+		if (free_.empty()) {
+			AB_ASSERT(capacity() + CHUNK_SIZE < std::numeric_limits<std::uint32_t>::max());
+			std::size_t base = capacity();
+			free_.reserve(free_.size() + CHUNK_SIZE);
+			chunks_.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+			// Hand out the new slots lowest first.
+			for (std::size_t i = CHUNK_SIZE; i > 0; --i) {
+				free_.push_back(std::uint32_t(base + i - 1));
+			}
+		}
+		std::uint32_t index = free_.back();
+		free_.pop_back();
+		return index;
+	}
+
+	void release(std::uint32_t index) noexcept {
+		Slot& slot = slot_at(index);
+		slot.object()->~T();
+		slot.live = false;
+		++slot.generation;
+		free_.push_back(index);
+		--size_;
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> chunks_;
+	std::vector<std::uint32_t> free_;
+	std::size_t size_ = 0;
+};
+
+using InstanceStore = Arena<ModuleInst>;
+
+using FuncStore = Arena<HostFunc>;
 
 /// The global state of the virtual machine.
 ///
+/// The store owns the VM's runtime objects, each kind in it's own arena. Nothing in the store is
+/// individually reference counted: objects are destroyed explicitly, or all at once with the
+/// store. Instances are destroyed before the host functions they may refer to.
+///
+/// Globals, tables and memories have no arena, and never will. An instance keeps it's globals in
+/// one contiguous block, and it's tables and memories in vectors, all published through it's
+/// constant pool, so `get_global`, `call_indirect` and memory accesses are a single load from the
+/// pool rather than a handle lookup. They are allocated and freed with their instance, which is
+/// itself an arena object.
+///
+/// Not thread safe. The VM serializes access to it's store.
+///
 class Store {
 public:
-	Store() {}
+	Store() noexcept = default;
+
+	Store(const Store&) = delete;
+
+	~Store() noexcept { clear(); }
+
+	Store& operator=(const Store&) = delete;
+
+	InstanceStore& instances() noexcept { return instances_; }
+
+	FuncStore& funcs() noexcept { return funcs_; }
+
+	/// Destroy every object in the store.
+	///
+	void clear() noexcept {
+		instances_.clear();
+		funcs_.clear();
+	}
+
+private:
+	FuncStore funcs_;
+	InstanceStore instances_;
 };
 
-} // namespace Ab
+}  // namespace Ab
 
-#endif // AB_STORE_HPP_
+#endif  // AB_STORE_HPP_
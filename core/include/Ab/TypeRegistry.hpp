@@ -0,0 +1,38 @@
+#ifndef AB_TYPEREGISTRY_HPP_
+#define AB_TYPEREGISTRY_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Types.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Ab {
+
+/// The canonical id of a function type. Structurally equal types have equal ids, whichever module
+/// or host function they come from, so checking a signature is a single integer compare.
+///
+using TypeId = std::uint32_t;
+
+/// The id of no type. No function has it, so a signature check against an empty slot fails.
+///
+constexpr TypeId NULL_TYPE_ID = 0;
+
+/// The process-wide registry of function types.
+///
+/// A module's types are interned when it is compiled. Interned types are never released, so an
+/// id stays valid for the life of the process. Thread safe.
+///
+class TypeRegistry {
+public:
+	/// The canonical id of a type. The first time a type is seen, it is given the next free id.
+	///
+	static TypeId intern(const FuncType& type);
+
+	/// The number of distinct types interned so far.
+	///
+	static std::size_t size();
+};
+
+}  // namespace Ab
+
+#endif  // AB_TYPEREGISTRY_HPP_
@@ -176,6 +176,8 @@ bool types_match(const std::vector<ValType>& dyn_types) {
 	return true;
 }
 
+/// Limits of a memory or table. Limits are 64 bits wide, to hold the limits of memory64 memories.
+///
 struct Limits {
 public:
 	std::size_t hash() const noexcept {
@@ -196,14 +198,15 @@ public:
 		if (has_max && max != rhs.max) {
 			return false;
 		}
-		return true;
+		return is_64 == rhs.is_64;
 	}
 
 	bool operator!=(const Limits& rhs) const noexcept { return !(*this == rhs); }
 
-	std::uint32_t min;
-	std::uint32_t max;
+	std::uint64_t min;
+	std::uint64_t max;
 	bool has_max;
+	bool is_64 = false;
 };
 
 struct FuncType final {
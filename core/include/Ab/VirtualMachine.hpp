@@ -1,17 +1,21 @@
 #ifndef AB_VIRTUALMACHINE_HPP_
 #define AB_VIRTUALMACHINE_HPP_
 
-#define AB_DEBUG
-
 #include <Ab/Config.hpp>
 #include <Ab/Assert.hpp>
 #include <Ab/Debug.hpp>
 #include <Ab/Interpreter.hpp>
 #include <Ab/IntrusiveList.hpp>
 #include <Ab/LinearMemory.hpp>
+#include <Ab/MemoryProfile.hpp>
 #include <Ab/Module.hpp>
+#include <Ab/Resolver.hpp>
 #include <Ab/Runtime.hpp>
+#include <Ab/Store.hpp>
+#include <absl/types/span.h>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -26,50 +30,153 @@ class ModuleInst;
 using ContextList     = IntrusiveList<Context>;
 using ContextListNode = IntrusiveListNode<Context>;
 
+/// An immutable list of the module instances owned by a VM.
+///
+/// Snapshots are published RCU-style: readers grab the current snapshot without taking the VM's
+/// module lock, and may hold it for as long as they like. Writers copy the current snapshot, append
+/// to the copy, and publish the copy in place of the original. A snapshot is freed when it's last
+/// reader drops it.
+///
+using ModuleSnapshot = std::vector<ModuleInst*>;
+
 /// The global state of the Abigail VM.
 ///
+/// A single VM may be shared by many threads. Each thread attaches to the VM through it's own
+/// Context. Attaching and detaching a Context takes a short lock, but nothing on the execution
+/// path does.
+///
 class VirtualMachine {
 public:
-	VirtualMachine(Runtime* runtime) : runtime_(runtime) {}
+	VirtualMachine(Runtime* runtime);
+
+	/// Create a VM whose instances' memories follow a configured policy. Each instance owns it's
+	/// memories, sized by it's module. Only the huge page and NUMA policies of the config apply.
+	///
+	VirtualMachine(Runtime* runtime, const LinearMemoryConfig& memory_config);
 
 	VirtualMachine(const VirtualMachine&) = delete;
 
-	VirtualMachine(VirtualMachine&&) noexcept = default;
+	VirtualMachine(VirtualMachine&&) = delete;
+
+	~VirtualMachine() noexcept;
 
-	// const std::vector<Module>& modules() const { return modules_; }
+	/// The VM attached to the calling thread's current context, or null.
+	///
+	static inline VirtualMachine* current() noexcept;
 
 	Runtime* runtime() const noexcept { return runtime_; }
 
+	/// Attach a context to this VM. Thread safe.
+	///
 	inline void enter(Context* cx);
 
+	/// Detach a context from this VM. Thread safe.
+	///
 	inline void leave(Context* cx);
 
-	LinearMemory& linear_memory() noexcept { return linear_memory_; }
-
-	const LinearMemory& linear_memory() const noexcept { return linear_memory_; }
-
+	/// Instantiate a module into the VM's store, link it against the VM's resolver, and publish
+	/// it in a new module snapshot. Thread safe.
+	///
+	/// @returns a handle to the new instance. See `instance` and `destroy`.
+	/// @throws LinkError if an import is unresolved, or has the wrong type.
+	///
+	Handle<ModuleInst> instantiate(const std::shared_ptr<Module>& module);
+
+	/// Resolve an instance handle. Null if the instance has been destroyed. Thread safe.
+	///
+	ModuleInst* instance(Handle<ModuleInst> handle);
+
+	/// Remove an instance from the module snapshot, and destroy it, freeing it's slot for the next
+	/// instance. Thread safe.
+	///
+	/// The caller must ensure that nothing still uses the instance: no context is running it's
+	/// code, no instance imports from it, and no reader still holds an older snapshot to reach it.
+	///
+	void destroy(Handle<ModuleInst> handle);
+
+	/// Create a host function in the VM's store. Thread safe. See `define_host`.
+	///
+	/// @returns the host function's instance.
+	///
+	FuncInst* new_host_func(FuncType&& type, NativeFn native, PrimitiveFn primitive);
+
+	/// Get the current snapshot of the VM's module instances. Thread safe, and never waits on a
+	/// writer building the next snapshot. The atomic shared_ptr load itself is not lock free: the
+	/// standard library guards it with a short, internal spinlock or mutex.
+	///
+	std::shared_ptr<const ModuleSnapshot> modules() const noexcept {
+		return std::atomic_load_explicit(&module_snapshot_, std::memory_order_acquire);
+	}
+
+	/// The policy applied to the memories of new instances.
+	///
+	const LinearMemoryConfig& memory_config() const noexcept { return memory_config_; }
+
+	/// The VM's global namespace, which instances are linked against when instantiated.
+	///
+	BasicResolver& resolver() noexcept { return resolver_; }
+
+	/// The lock guarding the context list.
+	///
+	std::mutex& context_lock() const noexcept { return context_lock_; }
+
+	/// The list of attached contexts. Callers must hold the context_lock while walking the list.
+	///
 	ContextList& context_list() noexcept { return context_list_; }
 
 	const ContextList& context_list() const noexcept { return context_list_; }
 
+	/// The number of attached contexts. Thread safe.
+	///
+	std::size_t context_count() const noexcept {
+		std::lock_guard<std::mutex> guard(context_lock_);
+		return context_count_;
+	}
+
 private:
 	Runtime* runtime_;
-	std::vector<std::unique_ptr<ModuleInst>> modules_;
-	LinearMemory linear_memory_;
+	LinearMemoryConfig memory_config_;
+	BasicResolver resolver_;
+
+	mutable std::mutex context_lock_;
 	ContextList context_list_;
+	std::size_t context_count_ = 0;
+
+	std::mutex module_lock_;
+	Store store_;
+	std::shared_ptr<const ModuleSnapshot> module_snapshot_;
+
+	/// Publish a new module snapshot. The caller must hold the module lock.
+	///
+	void publish(std::shared_ptr<const ModuleSnapshot> snapshot) noexcept;
 };
 
 /// Thread-local VM context.
 ///
+/// A context attaches the calling thread to a VM. While a context is alive, it is the thread's
+/// current context, and is reachable through Context::current() without touching shared state.
+/// Contexts must be created and destroyed on the same thread, in a stack-like order.
+///
 class Context {
 public:
-	explicit Context(VirtualMachine* vm) : vm_(vm) { enter(); }
+	explicit Context(VirtualMachine* vm) : vm_(vm), prev_(current_) {
+		enter();
+		current_ = this;
+	}
 
 	Context(const Context&) = delete;
 
-	Context(Context&&) = default;
+	Context(Context&&) = delete;
 
-	~Context() { leave(); }
+	~Context() {
+		AB_ASSERT(current_ == this);
+		current_ = prev_;
+		leave();
+	}
+
+	/// The calling thread's current context, or null if the thread is not attached to a VM.
+	///
+	static Context* current() noexcept { return current_; }
 
 	VirtualMachine* vm() const noexcept { return vm_; }
 
@@ -87,19 +194,51 @@ public:
 
 	const ExecState& exec_state() const noexcept { return interpreter_.exec_state(); }
 
+	/// The memory targeted by memory-0 instructions: memory 0 of the running function's instance,
+	/// or null. A host function sees it's caller's memory.
+	///
+	LinearMemory* memory() const noexcept { return exec_state().st_b.memory; }
+
+#ifdef AB_MEMORY_PROFILE
+	/// The sampled memory accesses of code run on this context.
+	///
+	MemoryProfile& memory_profile() noexcept { return memory_profile_; }
+
+	const MemoryProfile& memory_profile() const noexcept { return memory_profile_; }
+#endif  // AB_MEMORY_PROFILE
+
 	ContextListNode& node() noexcept { return node_; }
 
 	const ContextListNode& node() const noexcept { return node_; }
 
 private:
+	static inline thread_local Context* current_ = nullptr;
+
 	VirtualMachine* vm_;
+	Context* prev_;
 	Interpreter interpreter_;
 	ContextListNode node_;
+#ifdef AB_MEMORY_PROFILE
+	MemoryProfile memory_profile_;
+#endif
 };
 
-inline void VirtualMachine::enter(Context* cx) { context_list_.add(cx); }
+inline VirtualMachine* VirtualMachine::current() noexcept {
+	Context* cx = Context::current();
+	return cx ? cx->vm() : nullptr;
+}
 
-inline void VirtualMachine::leave(Context* cx) { context_list_.remove(cx); }
+inline void VirtualMachine::enter(Context* cx) {
+	std::lock_guard<std::mutex> guard(context_lock_);
+	context_list_.add(cx);
+	++context_count_;
+}
+
+inline void VirtualMachine::leave(Context* cx) {
+	std::lock_guard<std::mutex> guard(context_lock_);
+	context_list_.remove(cx);
+	--context_count_;
+}
 
 template <typename T>
 void set_stack_element(Byte* ptr, T x) noexcept {
@@ -157,7 +296,13 @@ Byte* enter_native_frame(Context& cx, std::size_t nregs);
 ///
 Byte* leave_native_frame(Context& cx, std::size_t nregs);
 
-/// Enter a VM call from C.
+/// Thrown when a call into the interpreter traps.
+///
+class Trap : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
 ///
 /// The target will be interpreted. In order to call this function, you must
 /// have pushed a top-level frame onto the interpreter stack.
@@ -166,6 +311,13 @@ Byte* leave_native_frame(Context& cx, std::size_t nregs);
 ///
 Byte* enter_interpreter(Context& cx, FuncInst* func);
 
+/// Unwind a top-level frame after the interpreter has trapped, and throw a Trap.
+///
+/// The interpreter stops in the trapping frame, so the stack is first reset to the top-level
+/// frame's registers at `reg_ptr`. The trap flags are cleared, so the context may be reused.
+///
+[[noreturn]] void raise_trap(Context& cx, Byte* reg_ptr, std::size_t nregs);
+
 /// Call a function with arguments As returning values Rs in a tuple.
 ///
 /// The signature will be validated at runtime, and must match the signature
@@ -185,6 +337,11 @@ std::tuple<Rs...> static_call(Context& cx, FuncInst* func, As... as) {
 
 	auto ret_ptr = enter_interpreter(cx, func);
 
+	const Flags& flags = cx.exec_state().st_b.flags;
+	if (flags.trap || flags.error) {
+		raise_trap(cx, reg_ptr, func->nregs());
+	}
+
 	auto ret = get_stack_elements<Rs...>(ret_ptr);
 	leave_native_frame(cx, func->nregs());
 
@@ -193,7 +350,58 @@ std::tuple<Rs...> static_call(Context& cx, FuncInst* func, As... as) {
 
 template <typename... Rs, typename... As>
 std::tuple<Rs...> static_call(Context& cx, ModuleInst* mod_inst, std::size_t index, As... as) {
-	return static_call(cx, mod_inst->func_inst(index), as...);
+	return static_call<Rs...>(cx, mod_inst->func_inst(index), as...);
+}
+
+/// Call an exported function through a handle pre-resolved with `Module::resolve_func`.
+///
+template <typename... Rs, typename... As>
+std::tuple<Rs...> static_call(Context& cx, ModuleInst* mod_inst, FuncHandle handle, As... as) {
+	return static_call<Rs...>(cx, mod_inst->func_inst(handle), as...);
+}
+
+/// Call a function once per element of `args`, writing the nth result tuple to `results[n]`.
+///
+/// The whole batch runs in a single top-level frame: the signature is checked and the frame is
+/// pushed once, and each element only writes it's arguments into the frame's registers and
+/// re-enters the interpreter. For small functions called many times, this is much cheaper than
+/// a static_call per element.
+///
+/// If an element traps, the batch stops and a Trap is thrown. The results of earlier elements
+/// have been written.
+///
+template <typename... Rs, typename... As>
+void batch_call(
+	Context& cx, FuncInst* func, absl::Span<const std::tuple<As...>> args,
+	absl::Span<std::tuple<Rs...>> results) {
+	const FuncType& func_type = *func->type();
+	AB_ASSERT((types_match<As...>(func_type.args)));
+	AB_ASSERT((types_match<Rs...>(func_type.rets)));
+	AB_ASSERT(args.size() <= results.size());
+
+	auto reg_ptr       = enter_native_frame(cx, func->nregs());
+	const Flags& flags = cx.exec_state().st_b.flags;
+
+	for (std::size_t i = 0; i < args.size(); ++i) {
+		std::apply([reg_ptr](As... as) { set_stack_elements<As...>(reg_ptr, as...); }, args[i]);
+
+		auto ret_ptr = enter_interpreter(cx, func);
+
+		if (flags.trap || flags.error) {
+			raise_trap(cx, reg_ptr, func->nregs());
+		}
+
+		results[i] = get_stack_elements<Rs...>(ret_ptr);
+	}
+
+	leave_native_frame(cx, func->nregs());
+}
+
+template <typename... Rs, typename... As>
+void batch_call(
+	Context& cx, ModuleInst* mod_inst, std::size_t index, absl::Span<const std::tuple<As...>> args,
+	absl::Span<std::tuple<Rs...>> results) {
+	batch_call<Rs...>(cx, mod_inst->func_inst(index), args, results);
 }
 
 extern "C" Byte* ab_act(ExecState* state, ExecAction action);
@@ -36,10 +36,14 @@ struct GlobalType {
 	bool is_mutable;
 };
 
+/// Limits of a memory or table. Limits of a memory64 memory are 64 bits wide.
+///
 struct ResizableLimits {
-	std::uint32_t initial;
-	std::uint32_t max;
+	std::uint64_t initial;
+	std::uint64_t max;
 	bool has_max;
+	bool shared;
+	bool is_64;
 };
 
 struct MemoryType {
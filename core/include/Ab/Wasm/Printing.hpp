@@ -94,10 +94,16 @@ inline auto operator<<(Sexpr::Formatter& out, const Section& section) -> Sexpr::
 }
 
 inline auto operator<<(Sexpr::Formatter& out, const ResizableLimits& limits) -> Sexpr::Formatter& {
+	if (limits.is_64) {
+		out << "i64";
+	}
 	out << limits.initial;
 	if (limits.has_max) {
 		out << limits.max;
 	}
+	if (limits.shared) {
+		out << "shared";
+	}
 	return out;
 }
 
@@ -174,11 +174,16 @@ private:
 		visitor_.section_end(section);
 	}
 
+	/// Limits start with a flags field: bit 0 is set if there is a maximum, bit 1 if the memory
+	/// is shared, and bit 2 if the memory is a memory64. Memory64 limits are 64 bits wide.
 	auto resizable_limits(ResizableLimits& out) -> void {
-		out.has_max = varuint1();
-		out.initial = varuint32();
+		auto flags  = varuint7();
+		out.has_max = (flags & 0x1) != 0;
+		out.shared  = (flags & 0x2) != 0;
+		out.is_64   = (flags & 0x4) != 0;
+		out.initial = out.is_64 ? varuint64() : varuint32();
 		if (out.has_max) {
-			out.max = varuint32();
+			out.max = out.is_64 ? varuint64() : varuint32();
 		} else {
 			out.max = 0;
 		}
@@ -264,6 +269,8 @@ private:
 
 	auto varuint32() -> std::uint64_t { return uleb128(); }
 
+	auto varuint64() -> std::uint64_t { return uleb128(); }
+
 	auto import_section([[maybe_unused]] const Section& section) -> void {
 		auto count = varuint32();
 		visitor_.import_section(count);
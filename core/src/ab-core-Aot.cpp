@@ -0,0 +1,580 @@
+#include <Ab/Config.hpp>
+#include <Ab/Aot.hpp>
+#include <Ab/Interpreter.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/Opcode.hpp>
+#include <Ab/State.hpp>
+#include <Ab/Types.hpp>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <dlfcn.h>
+#include <fstream>
+#include <ostream>
+#include <set>
+#include <spawn.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+namespace Ab {
+
+namespace {
+
+/// Byte offset of the error flag in the ExecState, poked by `unreachable`.
+///
+constexpr std::size_t ERROR_FLAG_OFFSET =
+	offsetof(ExecState, st_b) + offsetof(ExecStateB, flags) + offsetof(Flags, error);
+
+/// Byte offset of the trap flag in the ExecState, poked by an out of bounds access.
+///
+constexpr std::size_t TRAP_FLAG_OFFSET =
+	offsetof(ExecState, st_b) + offsetof(ExecStateB, flags) + offsetof(Flags, trap);
+
+/// Byte offsets of the cached base and size of the current memory.
+///
+constexpr std::size_t MEM_BASE_OFFSET = offsetof(ExecState, st_a) + offsetof(ExecStateA, mem_base);
+constexpr std::size_t MEM_SIZE_OFFSET = offsetof(ExecState, st_a) + offsetof(ExecStateA, mem_size);
+
+/// Preamble shared by every artifact. Registers are accessed through may_alias types, the same way
+/// the interpreter accesses the register window. Memory-0 accesses are checked against the size
+/// cached in the ExecState, and may be unaligned. The runtime fills in the function pointers when
+/// the artifact is loaded.
+///
+constexpr const char* const AOT_PREAMBLE =
+	"/* Generated by ab-aot. Do not edit. */\n"
+	"#include <stdint.h>\n"
+	"\n"
+	"typedef uint32_t ab_x32 __attribute__((may_alias));\n"
+	"typedef uint64_t ab_x64 __attribute__((may_alias));\n"
+	"typedef uint32_t ab_u32 __attribute__((may_alias, aligned(1)));\n"
+	"typedef uint64_t ab_u64 __attribute__((may_alias, aligned(1)));\n"
+	"\n"
+	"#define AB_X32(i) (*(ab_x32*)(regs + (i) * {slot}))\n"
+	"#define AB_X64(i) (*(ab_x64*)(regs + (i) * {slot}))\n"
+	"\n"
+	"#define AB_MEM_BASE (*(unsigned char**)((unsigned char*)state + {mem_base}))\n"
+	"#define AB_MEM_SIZE (*(uint64_t*)((unsigned char*)state + {mem_size}))\n"
+	"#define AB_MEM(t, ea) (*(t*)(AB_MEM_BASE + (ea)))\n"
+	"#define AB_TRAP() do {{ ((unsigned char*)state)[{trap}] = 1; return 0; }} while (0)\n"
+	"#define AB_CHECK(ea, n) \\\n"
+	"\tif ((ea) + (n) > AB_MEM_SIZE && !{in_bounds_symbol}(state, (ea), (n))) AB_TRAP()\n"
+	"\n"
+	"const unsigned int {abi_version_symbol} = {abi_version};\n"
+	"\n"
+	"int (*{call_symbol})(void*, unsigned int, unsigned char*) = 0;\n"
+	"int (*{in_bounds_symbol})(void*, uint64_t, uint64_t) = 0;\n"
+	"\n";
+
+/// Called by an artifact for `call`. Returns 0 if the call trapped.
+///
+int aot_call(void* state, unsigned int tgt, unsigned char* args) {
+	auto* exec = static_cast<ExecState*>(state);
+	return call_from_native(exec, exec->st_b.func->func_const(tgt), args);
+}
+
+/// Called by an artifact when an access misses the cached memory size. Returns 0 if the access is
+/// out of bounds.
+///
+int aot_in_bounds(void* state, std::uint64_t ea, std::uint64_t len) {
+	auto* exec = static_cast<ExecState*>(state);
+	reload_memory_cache(exec);
+	return ea + len <= exec->st_a.mem_size;
+}
+
+using AotCallFn     = int (*)(void*, unsigned int, unsigned char*);
+using AotInBoundsFn = int (*)(void*, std::uint64_t, std::uint64_t);
+
+/// A load or store on memory 0.
+///
+struct AotAccess {
+	bool is_load;
+	bool checked;
+	std::uint8_t width;
+	bool wide = false;  ///< The offset immediate packs the length of the check.
+};
+
+/// The memory-0 load or store with an opcode, if any. Accesses proven in bounds by
+/// `eliminate_bounds_checks` are translated without a check.
+///
+bool find_access(Opcode opcode, AotAccess& access) {
+	switch (opcode) {
+	case Opcode::I32_LOAD:
+		access = {true, true, 4};
+		return true;
+	case Opcode::I64_LOAD:
+		access = {true, true, 8};
+		return true;
+	case Opcode::I32_STORE:
+		access = {false, true, 4};
+		return true;
+	case Opcode::I64_STORE:
+		access = {false, true, 8};
+		return true;
+	case Opcode::I32_LOAD_UNCHECKED:
+		access = {true, false, 4};
+		return true;
+	case Opcode::I64_LOAD_UNCHECKED:
+		access = {true, false, 8};
+		return true;
+	case Opcode::I32_STORE_UNCHECKED:
+		access = {false, false, 4};
+		return true;
+	case Opcode::I64_STORE_UNCHECKED:
+		access = {false, false, 8};
+		return true;
+	case Opcode::I32_LOAD_WIDE:
+		access = {true, true, 4, true};
+		return true;
+	case Opcode::I64_LOAD_WIDE:
+		access = {true, true, 8, true};
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Every memory-0 load and store shares the layout of `i32.load`, registers first.
+static_assert(I64_LOAD_SIZEOF == I32_LOAD_SIZEOF && I32_STORE_SIZEOF == I32_LOAD_SIZEOF);
+static_assert(I32_LOAD_UNCHECKED_SIZEOF == I32_LOAD_SIZEOF);
+static_assert(I32_LOAD_WIDE_SIZEOF == I32_LOAD_SIZEOF && I64_LOAD_WIDE_SIZEOF == I32_LOAD_SIZEOF);
+static_assert(I32_STORE_OFFSET_OFFSET == I32_LOAD_OFFSET_OFFSET);
+
+/// Translates a single function body to a C function. Throws AotError if the body has an
+/// instruction with no translation, and the function stays in the interpreter.
+///
+/// Immutable globals are folded: `get_global` becomes a store of the global's initial value.
+/// Mutable globals live in the instance, which native code has no way to reach, so functions
+/// that touch them stay in the interpreter.
+///
+/// Calls and memory-0 accesses go through the ExecState. While a translated function runs, the
+/// current function and the memory cache are it's own, see `call_from_native`.
+///
+class AotFuncWriter {
+public:
+	AotFuncWriter(std::ostream& out, const Module& module, const Func& func, std::size_t index)
+		: out_(out), module_(module), body_(func.body_bytes()), index_(index) {}
+
+	void write() {
+		scan();
+		fmt::print(
+			out_, "static unsigned char* ab_aot_func_{}(void* state, unsigned char* regs) {{\n",
+			index_);
+		std::size_t offset = 0;
+		while (offset < body_.size()) {
+			if (targets_.count(offset) != 0) {
+				fmt::print(out_, "L{}:;\n", offset);
+			}
+			offset += write_insn(offset);
+		}
+		fmt::print(out_, "\t__builtin_trap();\n}}\n\n");
+	}
+
+private:
+	template <typename T>
+	T operand(std::size_t offset) const {
+		return *reinterpret_cast<const T*>(body_.data() + offset);
+	}
+
+	Opcode opcode(std::size_t offset) const { return operand<Opcode>(offset); }
+
+	/// The size of the instruction at offset. Throws if there is no translation for it.
+	///
+	std::size_t insn_size(std::size_t offset) const {
+		AotAccess access;
+		if (find_access(opcode(offset), access)) {
+			return I32_LOAD_SIZEOF;
+		}
+		switch (opcode(offset)) {
+		case Opcode::UNREACHABLE:
+			return UNREACHABLE_SIZEOF;
+		case Opcode::NOP:
+			return NOP_SIZEOF;
+		case Opcode::HALT:
+			return HALT_SIZEOF;
+		case Opcode::RETURN:
+			return 1;
+		case Opcode::X32_RETURN:
+			return X32_RETURN_SIZEOF;
+		case Opcode::X64_RETURN:
+			return X64_RETURN_SIZEOF;
+		case Opcode::GOTO:
+			return GOTO_SIZEOF;
+		case Opcode::GOTO_IF:
+			return GOTO_IF_SIZEOF;
+		case Opcode::GOTO_UNLESS:
+			return GOTO_UNLESS_SIZEOF;
+		case Opcode::I32_ADD:
+			return I32_ADD_SIZEOF;
+		case Opcode::CALL:
+			return CALL_SIZEOF;
+		case Opcode::GET_GLOBAL_X32:
+			constant_global(offset, GET_GLOBAL_X32_IDX_OFFSET);
+			return GET_GLOBAL_X32_SIZEOF;
+		case Opcode::GET_GLOBAL_X64:
+			constant_global(offset, GET_GLOBAL_X64_IDX_OFFSET);
+			return GET_GLOBAL_X64_SIZEOF;
+		default:
+			throw AotError(fmt::format(
+				"func {}: no native translation for opcode {:#04x} at offset {}", index_,
+				RawOpcode(opcode(offset)), offset));
+		}
+	}
+
+	/// The immutable global read by the instruction at offset. Throws if the global is mutable,
+	/// which leaves the function to the interpreter.
+	///
+	const GlobalEntry& constant_global(std::size_t offset, std::size_t idx_offset) const {
+		auto index          = operand<std::uint32_t>(offset + idx_offset);
+		const auto& globals = module_.global_table();
+		if (index >= globals.size()) {
+			throw AotError(fmt::format(
+				"func {}: global {} at offset {} is undefined", index_, index, offset));
+		}
+		if (globals[index].is_mutable) {
+			throw AotError(fmt::format(
+				"func {}: no native translation for mutable global {} at offset {}", index_,
+				index, offset));
+		}
+		return globals[index];
+	}
+
+	/// Absolute target of the branch at offset.
+	///
+	std::size_t branch_target(std::size_t offset, std::size_t off_offset) const {
+		auto target = std::ptrdiff_t(offset + insn_size(offset)) +
+			      operand<std::int8_t>(offset + off_offset);
+		if (target < 0 || std::size_t(target) >= body_.size()) {
+			throw AotError(fmt::format(
+				"func {}: branch at offset {} jumps out of the function", index_, offset));
+		}
+		return std::size_t(target);
+	}
+
+	/// Validate the body, and record every branch target, so labels are only emitted where they
+	/// are needed.
+	///
+	void scan() {
+		std::set<std::size_t> starts;
+		std::size_t offset = 0;
+		while (offset < body_.size()) {
+			starts.insert(offset);
+			switch (opcode(offset)) {
+			case Opcode::GOTO:
+				targets_.insert(branch_target(offset, GOTO_OFF_OFFSET));
+				break;
+			case Opcode::GOTO_IF:
+				targets_.insert(branch_target(offset, GOTO_IF_OFF_OFFSET));
+				break;
+			case Opcode::GOTO_UNLESS:
+				targets_.insert(branch_target(offset, GOTO_UNLESS_OFF_OFFSET));
+				break;
+			default:
+				break;
+			}
+			offset += insn_size(offset);
+		}
+		for (auto target : targets_) {
+			if (starts.count(target) == 0) {
+				throw AotError(fmt::format(
+					"func {}: branch target {} is not an instruction boundary", index_,
+					target));
+			}
+		}
+	}
+
+	/// Write a memory-0 load or store. The address is zero extended, so the effective address
+	/// can't wrap. A widened load checks the bytes of the later accesses it covers too.
+	///
+	void write_access(std::size_t offset, const AotAccess& access) {
+		auto addr = operand<std::uint8_t>(
+			offset + (access.is_load ? I32_LOAD_ADDR_OFFSET : I32_STORE_ADDR_OFFSET));
+		auto reg = operand<std::uint8_t>(
+			offset + (access.is_load ? I32_LOAD_DST_OFFSET : I32_STORE_SRC_OFFSET));
+		auto disp = operand<std::uint32_t>(offset + I32_LOAD_OFFSET_OFFSET);
+		auto len  = std::uint32_t(access.width);
+		if (access.wide) {
+			len = disp >> WIDE_LENGTH_SHIFT;
+			disp &= WIDE_OFFSET_MASK;
+		}
+		auto bits = access.width * 8;
+		fmt::print(out_, "\t{{\n\t\tuint64_t ea = (uint64_t)AB_X32({}) + {}u;\n", addr, disp);
+		if (access.checked) {
+			fmt::print(out_, "\t\tAB_CHECK(ea, {});\n", len);
+		}
+		if (access.is_load) {
+			fmt::print(out_, "\t\tAB_X{}({}) = AB_MEM(ab_u{}, ea);\n", bits, reg, bits);
+		} else {
+			fmt::print(out_, "\t\tAB_MEM(ab_u{}, ea) = AB_X{}({});\n", bits, bits, reg);
+		}
+		fmt::print(out_, "\t}}\n");
+	}
+
+	std::size_t write_insn(std::size_t offset) {
+		AotAccess access;
+		if (find_access(opcode(offset), access)) {
+			write_access(offset, access);
+			return insn_size(offset);
+		}
+		switch (opcode(offset)) {
+		case Opcode::UNREACHABLE:
+			fmt::print(
+				out_, "\t((unsigned char*)state)[{}] = 1;\n\treturn 0;\n",
+				ERROR_FLAG_OFFSET);
+			break;
+		case Opcode::NOP:
+			break;
+		case Opcode::HALT:
+		case Opcode::RETURN:
+			fmt::print(out_, "\treturn 0;\n");
+			break;
+		case Opcode::X32_RETURN:
+			fmt::print(
+				out_, "\treturn regs + {} * {};\n",
+				operand<std::uint8_t>(offset + X32_RETURN_RET_OFFSET), SIZEOF_SLOT);
+			break;
+		case Opcode::X64_RETURN:
+			fmt::print(
+				out_, "\treturn regs + {} * {};\n",
+				operand<std::uint8_t>(offset + X64_RETURN_RET_OFFSET), SIZEOF_SLOT);
+			break;
+		case Opcode::GOTO:
+			fmt::print(out_, "\tgoto L{};\n", branch_target(offset, GOTO_OFF_OFFSET));
+			break;
+		case Opcode::GOTO_IF:
+			fmt::print(
+				out_, "\tif (AB_X32({})) goto L{};\n",
+				operand<std::uint8_t>(offset + GOTO_IF_TST_OFFSET),
+				branch_target(offset, GOTO_IF_OFF_OFFSET));
+			break;
+		case Opcode::GOTO_UNLESS:
+			fmt::print(
+				out_, "\tif (!AB_X32({})) goto L{};\n",
+				operand<std::uint8_t>(offset + GOTO_UNLESS_TST_OFFSET),
+				branch_target(offset, GOTO_UNLESS_OFF_OFFSET));
+			break;
+		case Opcode::I32_ADD:
+			fmt::print(
+				out_, "\tAB_X32({}) = AB_X32({}) + AB_X32({});\n",
+				operand<std::uint8_t>(offset + I32_ADD_DST_OFFSET),
+				operand<std::uint8_t>(offset + I32_ADD_LHS_OFFSET),
+				operand<std::uint8_t>(offset + I32_ADD_RHS_OFFSET));
+			break;
+		case Opcode::CALL:
+			fmt::print(
+				out_, "\tif (!{}(state, {}u, regs + {} * {})) return 0;\n", AOT_CALL_SYMBOL,
+				operand<std::uint32_t>(offset + CALL_TGT_OFFSET),
+				operand<std::uint8_t>(offset + CALL_BASE_OFFSET), SIZEOF_SLOT);
+			break;
+		case Opcode::GET_GLOBAL_X32:
+			fmt::print(
+				out_, "\tAB_X32({}) = {:#x}u;\n",
+				operand<std::uint8_t>(offset + GET_GLOBAL_X32_DST_OFFSET),
+				constant_global(offset, GET_GLOBAL_X32_IDX_OFFSET).init);
+			break;
+		case Opcode::GET_GLOBAL_X64:
+			fmt::print(
+				out_, "\tAB_X64({}) = {:#x}ull;\n",
+				operand<std::uint8_t>(offset + GET_GLOBAL_X64_DST_OFFSET),
+				constant_global(offset, GET_GLOBAL_X64_IDX_OFFSET).init);
+			break;
+		default:
+			AB_ASSERT_UNREACHABLE();
+		}
+		return insn_size(offset);
+	}
+
+	std::ostream& out_;
+	const Module& module_;
+	absl::Span<Byte> body_;
+	std::size_t index_;
+	std::set<std::size_t> targets_;
+};
+
+void write_module_bytes(std::ostream& out, absl::Span<Byte> bytes) {
+	fmt::print(out, "unsigned char {}[] = {{", AOT_MODULE_SYMBOL);
+	for (std::size_t i = 0; i < bytes.size(); ++i) {
+		if (i % 16 == 0) {
+			fmt::print(out, "\n\t");
+		}
+		fmt::print(out, "{:#04x},", bytes[i]);
+	}
+	fmt::print(out, "\n}};\n\n");
+	fmt::print(out, "const unsigned long {} = {};\n\n", AOT_MODULE_SIZE_SYMBOL, bytes.size());
+}
+
+/// Write the table of entry points. A function with no translation has a null entry.
+///
+void write_func_table(std::ostream& out, const std::vector<bool>& translated) {
+	std::size_t nfuncs = translated.size();
+	fmt::print(out, "unsigned char* (*const {}[])(void*, unsigned char*) = {{\n", AOT_FUNCS_SYMBOL);
+	for (std::size_t i = 0; i < nfuncs; ++i) {
+		if (translated[i]) {
+			fmt::print(out, "\tab_aot_func_{},\n", i);
+		} else {
+			fmt::print(out, "\t0,\n");
+		}
+	}
+	// An empty initializer list is not valid C.
+	if (nfuncs == 0) {
+		fmt::print(out, "\t0,\n");
+	}
+	fmt::print(out, "}};\n\n");
+	fmt::print(out, "const unsigned long {} = {};\n", AOT_FUNC_COUNT_SYMBOL, nfuncs);
+}
+
+/// Run a command, and wait for it to finish.
+///
+void run_command(const std::vector<std::string>& args) {
+	std::vector<char*> argv;
+	for (const auto& arg : args) {
+		argv.push_back(const_cast<char*>(arg.c_str()));
+	}
+	argv.push_back(nullptr);
+
+	pid_t pid;
+	int e = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+	if (e != 0) {
+		throw AotError(fmt::format("failed to run {}: {}", args[0], std::strerror(e)));
+	}
+
+	int status = 0;
+	if (waitpid(pid, &status, 0) == -1) {
+		throw AotError(fmt::format("failed to wait for {}", args[0]));
+	}
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		throw AotError(fmt::format("{} failed", args[0]));
+	}
+}
+
+template <typename T>
+T* find_symbol(void* handle, const char* name) {
+	void* sym = dlsym(handle, name);
+	if (sym == nullptr) {
+		throw AotError(fmt::format("AOT artifact is missing symbol: {}", name));
+	}
+	return reinterpret_cast<T*>(sym);
+}
+
+}  // namespace
+
+void write_aot_source(std::ostream& out, const Module& module) {
+	fmt::print(
+		out, AOT_PREAMBLE, fmt::arg("slot", SIZEOF_SLOT), fmt::arg("mem_base", MEM_BASE_OFFSET),
+		fmt::arg("mem_size", MEM_SIZE_OFFSET), fmt::arg("trap", TRAP_FLAG_OFFSET),
+		fmt::arg("abi_version_symbol", AOT_ABI_VERSION_SYMBOL),
+		fmt::arg("abi_version", AOT_ABI_VERSION), fmt::arg("call_symbol", AOT_CALL_SYMBOL),
+		fmt::arg("in_bounds_symbol", AOT_IN_BOUNDS_SYMBOL));
+
+	write_module_bytes(out, module.bytes());
+
+	// Each function is written aside, so a function with no translation can be dropped, and left
+	// to the interpreter.
+	const auto& funcs = module.func_table();
+	std::vector<bool> translated(funcs.size());
+	for (std::size_t i = 0; i < funcs.size(); ++i) {
+		std::ostringstream func_out;
+		try {
+			AotFuncWriter(func_out, module, funcs[i], i).write();
+			out << func_out.str();
+			translated[i] = true;
+		} catch (const AotError& e) {
+			fmt::print(out, "/* interpreted: {} */\n\n", e.what());
+		}
+	}
+
+	write_func_table(out, translated);
+}
+
+void build_aot_artifact(const Module& module, const std::string& output, const AotConfig& config) {
+	std::string source = config.source;
+	bool temporary     = source.empty();
+
+	if (temporary) {
+		char name[] = "/tmp/ab-aot-XXXXXX.c";
+		int fd      = mkstemps(name, 2);
+		if (fd == -1) {
+			throw AotError("failed to create temporary source file");
+		}
+		close(fd);
+		source = name;
+	}
+
+	try {
+		{
+			std::ofstream out(source, std::ios::out | std::ios::trunc);
+			if (!out.is_open()) {
+				throw AotError(fmt::format("failed to open {}", source));
+			}
+			write_aot_source(out, module);
+		}
+
+		std::vector<std::string> args = {config.cc};
+		args.insert(args.end(), config.cflags.begin(), config.cflags.end());
+		args.insert(args.end(), {"-shared", "-fPIC", "-o", output, source});
+		run_command(args);
+	} catch (...) {
+		if (temporary) {
+			unlink(source.c_str());
+		}
+		throw;
+	}
+
+	if (temporary) {
+		unlink(source.c_str());
+	}
+}
+
+bool is_aot_artifact(const std::string& filename) {
+	static constexpr char ELF_MAGIC[4] = {0x7f, 'E', 'L', 'F'};
+
+	std::ifstream in(filename, std::ios::in | std::ios::binary);
+	char magic[4] = {};
+	in.read(magic, sizeof(magic));
+	return in.gcount() == sizeof(magic) && std::memcmp(magic, ELF_MAGIC, sizeof(magic)) == 0;
+}
+
+std::shared_ptr<Module> load_aot_artifact(Context& cx, const std::string& filename) {
+	// The handle is deliberately leaked: the module's bytes and code live in the shared object.
+	void* handle = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (handle == nullptr) {
+		throw AotError(fmt::format("failed to load AOT artifact: {}", dlerror()));
+	}
+
+	auto abi_version = *find_symbol<const unsigned int>(handle, AOT_ABI_VERSION_SYMBOL);
+	if (abi_version != AOT_ABI_VERSION) {
+		throw AotError(fmt::format(
+			"AOT artifact has ABI version {}, expected {}", abi_version, AOT_ABI_VERSION));
+	}
+
+	auto module_bytes = find_symbol<Byte>(handle, AOT_MODULE_SYMBOL);
+	auto module_size  = *find_symbol<const unsigned long>(handle, AOT_MODULE_SIZE_SYMBOL);
+	auto funcs        = find_symbol<const NativeFn>(handle, AOT_FUNCS_SYMBOL);
+	auto func_count   = *find_symbol<const unsigned long>(handle, AOT_FUNC_COUNT_SYMBOL);
+
+	auto module = compile(cx, ModuleStorage(absl::Span<Byte>(module_bytes, module_size), nullptr));
+
+	if (func_count != module->func_table().size()) {
+		throw AotError("AOT artifact function table does not match the embedded module");
+	}
+
+	*find_symbol<AotCallFn>(handle, AOT_CALL_SYMBOL)         = &aot_call;
+	*find_symbol<AotInBoundsFn>(handle, AOT_IN_BOUNDS_SYMBOL) = &aot_in_bounds;
+
+	// Functions with no translation have a null entry, and stay interpreted.
+	for (std::size_t i = 0; i < func_count; ++i) {
+		if (funcs[i] != nullptr) {
+			module->func_table()[i].native(funcs[i]);
+		}
+	}
+
+	return module;
+}
+
+}  // namespace Ab
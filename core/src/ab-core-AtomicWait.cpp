@@ -0,0 +1,147 @@
+#include <Ab/Config.hpp>
+#include <Ab/AtomicWait.hpp>
+#include <Ab/Futex.hpp>
+#include <Ab/Synchronic.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace Ab {
+
+namespace {
+
+/// A thread parked in atomic_wait. Lives on the waiting thread's stack. The links are only touched
+/// while holding it's bucket's lock. The waiter sleeps on it's own futex, in `woken`, so a notify
+/// wakes exactly the threads it dequeues.
+///
+struct Waiter {
+	explicit Waiter(const void* address) : address(address) {}
+
+	const void* address;
+	Synchronic<bool> woken{false};
+	Waiter* prev = nullptr;
+	Waiter* next = nullptr;
+};
+
+/// A FIFO queue of waiters, for every address that hashes to this bucket.
+///
+struct alignas(CACHE_LINE_SIZE) Bucket {
+	std::mutex lock;
+	Waiter* head = nullptr;
+	Waiter* tail = nullptr;
+
+	void enqueue(Waiter* waiter) noexcept {
+		waiter->prev = tail;
+		waiter->next = nullptr;
+		if (tail != nullptr) {
+			tail->next = waiter;
+		} else {
+			head = waiter;
+		}
+		tail = waiter;
+	}
+
+	void dequeue(Waiter* waiter) noexcept {
+		if (waiter->prev != nullptr) {
+			waiter->prev->next = waiter->next;
+		} else {
+			head = waiter->next;
+		}
+		if (waiter->next != nullptr) {
+			waiter->next->prev = waiter->prev;
+		} else {
+			tail = waiter->prev;
+		}
+	}
+};
+
+constexpr std::size_t BUCKET_COUNT = 256;
+
+Bucket buckets[BUCKET_COUNT];
+
+/// Fibonacci hash of the address, taking the top 8 bits.
+///
+Bucket& bucket_for(const void* address) noexcept {
+	static_assert(BUCKET_COUNT == 256);
+	auto key = reinterpret_cast<std::uintptr_t>(address) >> 2;
+	return buckets[(key * 0x9E3779B97F4A7C15ull) >> 56];
+}
+
+/// The deadline of a wait, `timeout` nanoseconds from now. Saturates rather than overflowing.
+///
+std::chrono::steady_clock::time_point wait_deadline(std::int64_t timeout) noexcept {
+	using Clock = std::chrono::steady_clock;
+	auto now    = Clock::now();
+	auto limit  = Clock::time_point::max() - now;
+	if (std::chrono::nanoseconds(timeout) >= limit) {
+		return Clock::time_point::max();
+	}
+	return now + std::chrono::nanoseconds(timeout);
+}
+
+template <typename T>
+WaitResult wait(T* address, T expected, std::int64_t timeout) {
+	Bucket& bucket = bucket_for(address);
+	Waiter waiter(address);
+
+	{
+		std::lock_guard<std::mutex> guard(bucket.lock);
+
+		// Notifiers write the value before taking the bucket lock, so a waiter that sees the
+		// expected value here can not miss the notify.
+		if (std::atomic_ref<T>(*address).load(std::memory_order_seq_cst) != expected) {
+			return WaitResult::NOT_EQUAL;
+		}
+
+		bucket.enqueue(&waiter);
+	}
+
+	// Waits are long-lived parks, so sleep at once rather than spin.
+	if (timeout < 0) {
+		waiter.woken.wait(false, WaitHint::OPTIMIZE_UTILIZATION);
+	} else {
+		waiter.woken.wait_until(false, wait_deadline(timeout), WaitHint::OPTIMIZE_UTILIZATION);
+	}
+
+	// A notifier holds the bucket lock until it is done with the waiter, so the waiter must take
+	// the lock before it goes out of scope, even once woken.
+	std::lock_guard<std::mutex> guard(bucket.lock);
+	if (!waiter.woken.load()) {
+		bucket.dequeue(&waiter);
+		return WaitResult::TIMED_OUT;
+	}
+	return WaitResult::OK;
+}
+
+}  // namespace
+
+WaitResult atomic_wait(std::uint32_t* address, std::uint32_t expected, std::int64_t timeout) {
+	return wait(address, expected, timeout);
+}
+
+WaitResult atomic_wait(std::uint64_t* address, std::uint64_t expected, std::int64_t timeout) {
+	return wait(address, expected, timeout);
+}
+
+std::uint32_t atomic_notify(const void* address, std::uint32_t count) {
+	Bucket& bucket = bucket_for(address);
+	std::lock_guard<std::mutex> guard(bucket.lock);
+
+	std::uint32_t n = 0;
+	Waiter* waiter  = bucket.head;
+	while (waiter != nullptr && n < count) {
+		Waiter* next = waiter->next;
+		if (waiter->address == address) {
+			bucket.dequeue(waiter);
+			// The waiter can't return until we drop the bucket lock, so it's safe to notify it.
+			waiter->woken.store(true);
+			waiter->woken.notify_one();
+			++n;
+		}
+		waiter = next;
+	}
+	return n;
+}
+
+}  // namespace Ab
@@ -0,0 +1,546 @@
+#include <Ab/Config.hpp>
+#include <Ab/BoundsCheck.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/Module.hpp>
+#include <Ab/ModuleConstants.hpp>
+#include <Ab/Opcode.hpp>
+#include <Ab/Types.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace Ab {
+
+namespace {
+
+// Loads share the layout of `i32.load` in each form, and stores share the layout of `i32.store`.
+// The unchecked forms share the layout of their checked forms.
+
+static_assert(I64_LOAD_SIZEOF == I32_LOAD_SIZEOF);
+static_assert(I64_LOAD_MEM_SIZEOF == I32_LOAD_MEM_SIZEOF);
+static_assert(I64_LOAD_A64_SIZEOF == I32_LOAD_A64_SIZEOF);
+static_assert(I64_STORE_MEM_MEMORY_OFFSET == I32_STORE_MEM_MEMORY_OFFSET);
+static_assert(I64_STORE_A64_MEMORY_OFFSET == I32_STORE_A64_MEMORY_OFFSET);
+static_assert(I32_LOAD_UNCHECKED_SIZEOF == I32_LOAD_SIZEOF);
+static_assert(I32_LOAD_MEM_UNCHECKED_SIZEOF == I32_LOAD_MEM_SIZEOF);
+static_assert(I32_LOAD_A64_UNCHECKED_SIZEOF == I32_LOAD_A64_SIZEOF);
+static_assert(I32_STORE_A64_UNCHECKED_MEMORY_OFFSET == I32_STORE_A64_MEMORY_OFFSET);
+static_assert(I32_LOAD_WIDE_SIZEOF == I32_LOAD_SIZEOF && I64_LOAD_WIDE_SIZEOF == I32_LOAD_SIZEOF);
+
+enum class AccessForm {
+	MEMORY_0,
+	MEM,
+	A64,
+};
+
+/// A plain load or store, and it's unchecked and widened forms. Only memory-0 loads can be
+/// widened, any other access has it's checked opcode as it's widened form.
+///
+struct AccessOp {
+	Opcode checked;
+	Opcode unchecked;
+	Opcode wide;
+	AccessForm form;
+	bool is_load;
+	std::uint8_t width;
+};
+
+constexpr AccessOp ACCESS_OPS[] = {
+	{Opcode::I32_LOAD, Opcode::I32_LOAD_UNCHECKED, Opcode::I32_LOAD_WIDE, AccessForm::MEMORY_0,
+	 true, 4},
+	{Opcode::I64_LOAD, Opcode::I64_LOAD_UNCHECKED, Opcode::I64_LOAD_WIDE, AccessForm::MEMORY_0,
+	 true, 8},
+	{Opcode::I32_STORE, Opcode::I32_STORE_UNCHECKED, Opcode::I32_STORE, AccessForm::MEMORY_0,
+	 false, 4},
+	{Opcode::I64_STORE, Opcode::I64_STORE_UNCHECKED, Opcode::I64_STORE, AccessForm::MEMORY_0,
+	 false, 8},
+	{Opcode::I32_LOAD_MEM, Opcode::I32_LOAD_MEM_UNCHECKED, Opcode::I32_LOAD_MEM, AccessForm::MEM,
+	 true, 4},
+	{Opcode::I64_LOAD_MEM, Opcode::I64_LOAD_MEM_UNCHECKED, Opcode::I64_LOAD_MEM, AccessForm::MEM,
+	 true, 8},
+	{Opcode::I32_STORE_MEM, Opcode::I32_STORE_MEM_UNCHECKED, Opcode::I32_STORE_MEM, AccessForm::MEM,
+	 false, 4},
+	{Opcode::I64_STORE_MEM, Opcode::I64_STORE_MEM_UNCHECKED, Opcode::I64_STORE_MEM, AccessForm::MEM,
+	 false, 8},
+	{Opcode::I32_LOAD_A64, Opcode::I32_LOAD_A64_UNCHECKED, Opcode::I32_LOAD_A64, AccessForm::A64,
+	 true, 4},
+	{Opcode::I64_LOAD_A64, Opcode::I64_LOAD_A64_UNCHECKED, Opcode::I64_LOAD_A64, AccessForm::A64,
+	 true, 8},
+	{Opcode::I32_STORE_A64, Opcode::I32_STORE_A64_UNCHECKED, Opcode::I32_STORE_A64, AccessForm::A64,
+	 false, 4},
+	{Opcode::I64_STORE_A64, Opcode::I64_STORE_A64_UNCHECKED, Opcode::I64_STORE_A64, AccessForm::A64,
+	 false, 8},
+};
+
+/// Find the plain load or store with a checked, unchecked or widened opcode, or null for any other
+/// instruction.
+///
+const AccessOp* find_access_op(Opcode opcode) {
+	for (const auto& op : ACCESS_OPS) {
+		if (op.checked == opcode || op.unchecked == opcode || op.wide == opcode) {
+			return &op;
+		}
+	}
+	return nullptr;
+}
+
+std::size_t access_size(AccessForm form) {
+	switch (form) {
+	case AccessForm::MEMORY_0:
+		return I32_LOAD_SIZEOF;
+	case AccessForm::MEM:
+		return I32_LOAD_MEM_SIZEOF;
+	default:
+		return I32_LOAD_A64_SIZEOF;
+	}
+}
+
+/// How an instruction, other than a plain load or store, affects what is proven.
+///
+enum class Effect {
+	/// Proofs survive the instruction.
+	NONE,
+	/// The instruction writes the register at offset 1, and proofs off the slots it writes are
+	/// lost.
+	DEFINES,
+	/// Every proof is lost. A call writes it's results over a range of registers, and a call or a
+	/// wait may reach the host.
+	CLOBBERS,
+	/// A branch, which proves nothing at it's target.
+	BRANCHES,
+};
+
+struct Insn {
+	std::size_t size   = 0;
+	Effect effect      = Effect::NONE;
+	std::size_t nslots = 1;  ///< The number of slots a definition writes, 2 for a 64-bit value.
+};
+
+/// Decode any instruction other than a plain load or store. The size is 0 for an instruction the
+/// pass doesn't know.
+///
+Insn decode_insn(Opcode opcode) {
+	switch (opcode) {
+	case Opcode::NOP:
+		return {NOP_SIZEOF, Effect::NONE};
+	case Opcode::SET_GLOBAL_X32:
+		return {SET_GLOBAL_X32_SIZEOF, Effect::NONE};
+	case Opcode::SET_GLOBAL_X64:
+		return {SET_GLOBAL_X64_SIZEOF, Effect::NONE};
+	case Opcode::MEMORY_COPY:
+		return {MEMORY_COPY_SIZEOF, Effect::NONE};
+	case Opcode::MEMORY_FILL:
+		return {MEMORY_FILL_SIZEOF, Effect::NONE};
+	case Opcode::MEMORY_INIT:
+		return {MEMORY_INIT_SIZEOF, Effect::NONE};
+	case Opcode::DATA_DROP:
+		return {DATA_DROP_SIZEOF, Effect::NONE};
+	case Opcode::ATOMIC_FENCE:
+		return {ATOMIC_FENCE_SIZEOF, Effect::NONE};
+	case Opcode::I32_ATOMIC_STORE:
+		return {I32_ATOMIC_STORE_SIZEOF, Effect::NONE};
+	case Opcode::I64_ATOMIC_STORE:
+		return {I64_ATOMIC_STORE_SIZEOF, Effect::NONE};
+
+	case Opcode::I32_ADD:
+		return {I32_ADD_SIZEOF, Effect::DEFINES};
+	case Opcode::I32_SUB:
+		return {I32_SUB_SIZEOF, Effect::DEFINES};
+	case Opcode::GET_GLOBAL_X32:
+		return {GET_GLOBAL_X32_SIZEOF, Effect::DEFINES};
+	case Opcode::GET_GLOBAL_X64:
+		return {GET_GLOBAL_X64_SIZEOF, Effect::DEFINES, 2};
+	case Opcode::MEMORY_SIZE:
+		return {MEMORY_SIZE_SIZEOF, Effect::DEFINES};
+	case Opcode::MEMORY_GROW:
+		return {MEMORY_GROW_SIZEOF, Effect::DEFINES};
+	case Opcode::MEMORY_ATOMIC_NOTIFY:
+		return {MEMORY_ATOMIC_NOTIFY_SIZEOF, Effect::DEFINES};
+	case Opcode::I32_ATOMIC_LOAD:
+		return {I32_ATOMIC_LOAD_SIZEOF, Effect::DEFINES};
+	case Opcode::I64_ATOMIC_LOAD:
+		return {I64_ATOMIC_LOAD_SIZEOF, Effect::DEFINES, 2};
+	case Opcode::I32_ATOMIC_RMW_ADD:
+	case Opcode::I32_ATOMIC_RMW_SUB:
+	case Opcode::I32_ATOMIC_RMW_AND:
+	case Opcode::I32_ATOMIC_RMW_OR:
+	case Opcode::I32_ATOMIC_RMW_XOR:
+	case Opcode::I32_ATOMIC_RMW_XCHG:
+		return {I32_ATOMIC_RMW_ADD_SIZEOF, Effect::DEFINES};
+	case Opcode::I64_ATOMIC_RMW_ADD:
+	case Opcode::I64_ATOMIC_RMW_SUB:
+	case Opcode::I64_ATOMIC_RMW_AND:
+	case Opcode::I64_ATOMIC_RMW_OR:
+	case Opcode::I64_ATOMIC_RMW_XOR:
+	case Opcode::I64_ATOMIC_RMW_XCHG:
+		return {I64_ATOMIC_RMW_ADD_SIZEOF, Effect::DEFINES, 2};
+	case Opcode::I32_ATOMIC_RMW_CMPXCHG:
+		return {I32_ATOMIC_RMW_CMPXCHG_SIZEOF, Effect::DEFINES};
+	case Opcode::I64_ATOMIC_RMW_CMPXCHG:
+		return {I64_ATOMIC_RMW_CMPXCHG_SIZEOF, Effect::DEFINES, 2};
+
+	case Opcode::UNREACHABLE:
+		return {UNREACHABLE_SIZEOF, Effect::CLOBBERS};
+	case Opcode::HALT:
+		return {HALT_SIZEOF, Effect::CLOBBERS};
+	case Opcode::RETURN:
+		return {1, Effect::CLOBBERS};
+	case Opcode::X32_RETURN:
+		return {X32_RETURN_SIZEOF, Effect::CLOBBERS};
+	case Opcode::X64_RETURN:
+		return {X64_RETURN_SIZEOF, Effect::CLOBBERS};
+	case Opcode::CALL_PRIMITIVE:
+		return {CALL_PRIMITIVE_SIZEOF, Effect::CLOBBERS};
+	case Opcode::CALL:
+		return {CALL_SIZEOF, Effect::CLOBBERS};
+	case Opcode::CALL_INDIRECT:
+		return {CALL_INDIRECT_SIZEOF, Effect::CLOBBERS};
+	case Opcode::MEMORY_ATOMIC_WAIT32:
+		return {MEMORY_ATOMIC_WAIT32_SIZEOF, Effect::CLOBBERS};
+	case Opcode::MEMORY_ATOMIC_WAIT64:
+		return {MEMORY_ATOMIC_WAIT64_SIZEOF, Effect::CLOBBERS};
+
+	case Opcode::GOTO:
+		return {GOTO_SIZEOF, Effect::BRANCHES};
+	case Opcode::GOTO_IF:
+		return {GOTO_IF_SIZEOF, Effect::BRANCHES};
+	case Opcode::GOTO_UNLESS:
+		return {GOTO_UNLESS_SIZEOF, Effect::BRANCHES};
+
+	default:
+		return {};
+	}
+}
+
+static_assert(I32_ADD_DST_OFFSET == 1 && I32_SUB_DST_OFFSET == 1);
+static_assert(GET_GLOBAL_X32_DST_OFFSET == 1 && GET_GLOBAL_X64_DST_OFFSET == 1);
+static_assert(MEMORY_SIZE_DST_OFFSET == 1 && MEMORY_GROW_DST_OFFSET == 1);
+static_assert(MEMORY_ATOMIC_NOTIFY_DST_OFFSET == 1);
+static_assert(I32_ATOMIC_LOAD_DST_OFFSET == 1 && I64_ATOMIC_LOAD_DST_OFFSET == 1);
+static_assert(I32_ATOMIC_RMW_XCHG_SIZEOF == I32_ATOMIC_RMW_ADD_SIZEOF);
+static_assert(I64_ATOMIC_RMW_XCHG_SIZEOF == I64_ATOMIC_RMW_ADD_SIZEOF);
+static_assert(I32_ATOMIC_RMW_ADD_DST_OFFSET == 1 && I64_ATOMIC_RMW_ADD_DST_OFFSET == 1);
+static_assert(I32_ATOMIC_RMW_CMPXCHG_DST_OFFSET == 1 && I64_ATOMIC_RMW_CMPXCHG_DST_OFFSET == 1);
+
+/// True if an instruction, other than a plain load or store, has no effect but on it's registers.
+/// A check may be widened over it, because it can't be observed whether it ran before a trap.
+///
+bool is_pure(Opcode opcode) {
+	switch (opcode) {
+	case Opcode::NOP:
+	case Opcode::I32_ADD:
+	case Opcode::I32_SUB:
+	case Opcode::GET_GLOBAL_X32:
+	case Opcode::GET_GLOBAL_X64:
+	case Opcode::MEMORY_SIZE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/// The offset of a branch's displacement. Every branch is taken relative to the end of it's
+/// instruction.
+///
+std::size_t branch_off_offset(Opcode opcode) {
+	switch (opcode) {
+	case Opcode::GOTO:
+		return GOTO_OFF_OFFSET;
+	case Opcode::GOTO_IF:
+		return GOTO_IF_OFF_OFFSET;
+	default:
+		return GOTO_UNLESS_OFF_OFFSET;
+	}
+}
+
+template <typename T>
+T operand(const Byte* insn, std::size_t offset) {
+	T value;
+	std::memcpy(&value, insn + offset, sizeof(T));
+	return value;
+}
+
+/// The width of a value of a type, in bytes, or 0 if it has no width.
+///
+std::size_t value_width(ValType type) {
+	switch (type) {
+	case ValType::I32:
+	case ValType::F32:
+		return 4;
+	case ValType::I64:
+	case ValType::F64:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/// Check a `get_global` or `set_global` of `width` bytes.
+///
+void validate_global(const Module& module, std::uint32_t index, std::size_t width, bool is_set) {
+	const auto& globals = module.global_table();
+	if (index >= globals.size()) {
+		throw DecodeError("Global index out of bounds");
+	}
+	if (is_set && !globals[index].is_mutable) {
+		throw DecodeError("Set of an immutable global");
+	}
+	if (value_width(globals[index].type) != width) {
+		throw DecodeError("Global accessed with the wrong width");
+	}
+}
+
+/// Check the segment of a `memory.init` or `data.drop`.
+///
+void validate_data_segment(const Module& module, std::uint32_t index) {
+	if (index >= module.data_table().size()) {
+		throw DecodeError("Data segment index out of bounds");
+	}
+}
+
+/// Check the target of a `call` or `call_primitive`, an index in the module's function index
+/// space.
+///
+void validate_call_target(const Module& module, std::uint32_t index) {
+	if (index >= module.func_count()) {
+		throw DecodeError("Call target out of bounds");
+	}
+}
+
+/// Check the expected type of a `call_indirect`. The table index is checked when the call runs.
+///
+void validate_type(const Module& module, std::uint32_t index) {
+	if (index >= module.type_table().size()) {
+		throw DecodeError("Type index out of bounds");
+	}
+}
+
+/// Check the immediates of an instruction that index into the module. The interpreter trusts them.
+///
+void validate_insn(const Module& module, Opcode opcode, const Byte* insn) {
+	switch (opcode) {
+	case Opcode::CALL:
+		validate_call_target(module, operand<std::uint32_t>(insn, CALL_TGT_OFFSET));
+		break;
+	case Opcode::CALL_PRIMITIVE:
+		validate_call_target(module, operand<std::uint32_t>(insn, CALL_PRIMITIVE_TGT_OFFSET));
+		break;
+	case Opcode::CALL_INDIRECT:
+		validate_type(module, operand<std::uint32_t>(insn, CALL_INDIRECT_TYPE_OFFSET));
+		break;
+	case Opcode::GET_GLOBAL_X32:
+		validate_global(module, operand<std::uint32_t>(insn, GET_GLOBAL_X32_IDX_OFFSET), 4, false);
+		break;
+	case Opcode::GET_GLOBAL_X64:
+		validate_global(module, operand<std::uint32_t>(insn, GET_GLOBAL_X64_IDX_OFFSET), 8, false);
+		break;
+	case Opcode::SET_GLOBAL_X32:
+		validate_global(module, operand<std::uint32_t>(insn, SET_GLOBAL_X32_IDX_OFFSET), 4, true);
+		break;
+	case Opcode::SET_GLOBAL_X64:
+		validate_global(module, operand<std::uint32_t>(insn, SET_GLOBAL_X64_IDX_OFFSET), 8, true);
+		break;
+	case Opcode::MEMORY_INIT:
+		validate_data_segment(module, operand<std::uint32_t>(insn, MEMORY_INIT_SEGMENT_OFFSET));
+		break;
+	case Opcode::DATA_DROP:
+		validate_data_segment(module, operand<std::uint32_t>(insn, DATA_DROP_SEGMENT_OFFSET));
+		break;
+	default:
+		break;
+	}
+}
+
+/// What is proven in bounds: for a memory, address register and address width, the end of the
+/// furthest checked access. Plain memory-0 accesses are keyed as memory 0.
+///
+using Key = std::tuple<std::uint32_t, std::uint8_t, bool>;
+
+constexpr std::size_t NO_ANCHOR = std::numeric_limits<std::size_t>::max();
+
+struct Proof {
+	std::uint64_t end;
+	/// The offset of the checked memory-0 load that proved `end`, while it may still be widened,
+	/// or NO_ANCHOR.
+	std::size_t anchor = NO_ANCHOR;
+	/// The offset immediate of the anchor.
+	std::uint32_t anchor_disp = 0;
+};
+
+using Proven = std::map<Key, Proof>;
+
+/// End the straight-line run of every proof. No check is widened over the current instruction.
+///
+void end_runs(Proven& proven) {
+	for (auto& entry : proven) {
+		entry.second.anchor = NO_ANCHOR;
+	}
+}
+
+/// Widen the check of a proof's anchor to cover an access ending at `end`. Returns false, and
+/// changes nothing, if there is no anchor, or the check would be too wide to encode.
+///
+bool widen(absl::Span<Byte> body, Proof& proof, std::uint64_t end) {
+	if (proof.anchor == NO_ANCHOR || end - proof.anchor_disp > WIDE_LENGTH_MAX) {
+		return false;
+	}
+	Byte* anchor   = body.data() + proof.anchor;
+	auto len       = std::uint32_t(end - proof.anchor_disp);
+	auto immediate = proof.anchor_disp | (len << WIDE_LENGTH_SHIFT);
+	*anchor        = Byte(find_access_op(Opcode(*anchor))->wide);
+	std::memcpy(anchor + I32_LOAD_OFFSET_OFFSET, &immediate, sizeof(immediate));
+	proof.end = end;
+	return true;
+}
+
+/// Forget every proof whose address register overlaps the `nslots` slots written from `reg`.
+/// Registers are one slot wide, so a 64-bit value, or a 64-bit address, spans two registers.
+///
+void forget_slots(Proven& proven, std::uint8_t reg, std::size_t nslots) {
+	std::size_t begin = reg;
+	std::size_t end   = begin + nslots;
+	for (auto it = proven.begin(); it != proven.end();) {
+		std::size_t addr_begin = std::get<1>(it->first);
+		std::size_t addr_end   = addr_begin + (std::get<2>(it->first) ? 2 : 1);
+		if (addr_begin < end && begin < addr_end) {
+			it = proven.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+/// Eliminate the bounds checks of a body. The immediates of each instruction are validated against
+/// the module, if there is one.
+///
+std::size_t eliminate(absl::Span<Byte> body, const Module* module) {
+	// Find every instruction boundary, and every branch target.
+	std::vector<bool> starts(body.size());
+	std::vector<bool> targets(body.size());
+	std::size_t offset = 0;
+	while (offset < body.size()) {
+		const Byte* insn = body.data() + offset;
+		Opcode opcode    = Opcode(*insn);
+		const AccessOp* op = find_access_op(opcode);
+		Insn other         = op != nullptr ? Insn{access_size(op->form)} : decode_insn(opcode);
+		if (other.size == 0) {
+			throw DecodeError("Unknown opcode in function body");
+		}
+		if (other.size > body.size() - offset) {
+			throw DecodeError("Truncated instruction in function body");
+		}
+		if (other.effect == Effect::BRANCHES) {
+			auto off    = operand<std::int8_t>(insn, branch_off_offset(opcode));
+			auto target = std::ptrdiff_t(offset + other.size) + off;
+			if (target < 0 || std::size_t(target) >= body.size()) {
+				throw DecodeError("Branch out of function body");
+			}
+			targets[target] = true;
+		}
+		if (module != nullptr) {
+			validate_insn(*module, opcode, insn);
+		}
+		starts[offset] = true;
+		offset += other.size;
+	}
+	for (std::size_t i = 0; i < body.size(); ++i) {
+		if (targets[i] && !starts[i]) {
+			throw DecodeError("Branch into the middle of an instruction");
+		}
+	}
+
+	// Walk each run of code between branch targets, carrying what is proven along.
+	std::size_t count = 0;
+	Proven proven;
+	offset = 0;
+	while (offset < body.size()) {
+		if (targets[offset]) {
+			proven.clear();
+		}
+
+		Byte* insn         = body.data() + offset;
+		Opcode opcode      = Opcode(*insn);
+		const AccessOp* op = find_access_op(opcode);
+
+		if (op == nullptr) {
+			Insn other = decode_insn(opcode);
+			if (!is_pure(opcode)) {
+				end_runs(proven);
+			}
+			if (other.effect == Effect::DEFINES) {
+				forget_slots(proven, operand<std::uint8_t>(insn, 1), other.nslots);
+			} else if (other.effect == Effect::CLOBBERS) {
+				proven.clear();
+			}
+			offset += other.size;
+			continue;
+		}
+
+		// A widened load is derived again from it's plain form, so a body is never trusted to have
+		// widened a check itself.
+		if (opcode == op->wide && op->wide != op->checked) {
+			auto disp = operand<std::uint32_t>(insn, I32_LOAD_OFFSET_OFFSET) & WIDE_OFFSET_MASK;
+			std::memcpy(insn + I32_LOAD_OFFSET_OFFSET, &disp, sizeof(disp));
+		}
+
+		// Every form has it's registers at 1 and 2, then it's offset, then it's memory.
+		std::uint8_t addr    = operand<std::uint8_t>(insn, op->is_load ? 2 : 1);
+		std::uint64_t disp   = op->form == AccessForm::A64
+								  ? operand<std::uint64_t>(insn, I32_LOAD_A64_OFFSET_OFFSET)
+								  : operand<std::uint32_t>(insn, I32_LOAD_OFFSET_OFFSET);
+		std::uint32_t memory = 0;
+		if (op->form == AccessForm::MEM) {
+			memory = operand<std::uint32_t>(insn, I32_LOAD_MEM_MEMORY_OFFSET);
+		} else if (op->form == AccessForm::A64) {
+			memory = operand<std::uint32_t>(insn, I32_LOAD_A64_MEMORY_OFFSET);
+		}
+
+		// An access proven in bounds is unchecked, and any other access is checked, whatever
+		// opcode it came with. An access whose end overflows always traps, and proves nothing.
+		//
+		// An access past the end of a proof is proven too, if the check of the proof's anchor can
+		// be widened to cover it. Only loads and pure instructions ran in between, so a trap at
+		// the anchor is seen just as one at the access would be. A store can't be an anchor,
+		// because it would trap without it's write.
+		bool is_proven = false;
+		if (disp <= std::numeric_limits<std::uint64_t>::max() - op->width) {
+			std::uint64_t end = disp + op->width;
+			Key key{memory, addr, op->form == AccessForm::A64};
+			auto it = proven.find(key);
+			if (it != proven.end() && (end <= it->second.end || widen(body, it->second, end))) {
+				is_proven = true;
+			} else if (op->wide != op->checked && disp <= WIDE_OFFSET_MASK) {
+				proven[key] = {end, offset, std::uint32_t(disp)};
+			} else {
+				proven[key] = {end};
+			}
+		}
+		*insn = Byte(is_proven ? op->unchecked : op->checked);
+		count += is_proven;
+
+		if (op->is_load) {
+			forget_slots(proven, operand<std::uint8_t>(insn, 1), op->width / SIZEOF_SLOT);
+		} else {
+			end_runs(proven);
+		}
+		offset += access_size(op->form);
+	}
+	return count;
+}
+
+}  // namespace
+
+std::size_t eliminate_bounds_checks(absl::Span<Byte> body) { return eliminate(body, nullptr); }
+
+std::size_t eliminate_bounds_checks(Module& module) {
+	std::size_t count = 0;
+	for (auto& func : module.func_table()) {
+		count += eliminate(func.body_bytes(), &module);
+	}
+	return count;
+}
+
+}  // namespace Ab
@@ -0,0 +1,89 @@
+#include <Ab/Config.hpp>
+#include <Ab/Assert.hpp>
+#include <Ab/InstancePool.hpp>
+
+namespace Ab {
+
+InstancePool::InstancePool(const ModuleInst& prototype, std::size_t capacity)
+	: snapshots_(prototype.capture_memories()),
+	  prototype_(prototype, snapshots_),
+	  capacity_(capacity) {}
+
+InstancePool::~InstancePool() noexcept { AB_ASSERT(lease_count_ == 0); }
+
+InstancePool::Lease InstancePool::acquire() {
+	std::unique_ptr<PooledInstance> inst;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		++lease_count_;
+		if (!idle_.empty()) {
+			inst = std::move(idle_.back());
+			idle_.pop_back();
+		}
+	}
+
+	if (!inst) {
+		try {
+			inst = make_instance();
+		} catch (...) {
+			std::lock_guard<std::mutex> guard(lock_);
+			--lease_count_;
+			throw;
+		}
+	}
+
+	// Under the LOCAL NUMA policy, the memories follow the thread that takes the lease.
+	for (std::size_t i = 0; i < inst->inst()->memory_count(); ++i) {
+		inst->inst()->memory(i)->bind_to_current_node();
+	}
+
+	return Lease(inst.release(), Releaser(this));
+}
+
+void InstancePool::prewarm(std::size_t count) {
+	for (;;) {
+		{
+			std::lock_guard<std::mutex> guard(lock_);
+			if (idle_.size() >= count) {
+				return;
+			}
+		}
+		auto inst = make_instance();
+		std::lock_guard<std::mutex> guard(lock_);
+		idle_.push_back(std::move(inst));
+	}
+}
+
+std::size_t InstancePool::idle_count() const noexcept {
+	std::lock_guard<std::mutex> guard(lock_);
+	return idle_.size();
+}
+
+std::size_t InstancePool::lease_count() const noexcept {
+	std::lock_guard<std::mutex> guard(lock_);
+	return lease_count_;
+}
+
+std::unique_ptr<PooledInstance> InstancePool::make_instance() const {
+	return std::make_unique<PooledInstance>(prototype_, snapshots_);
+}
+
+void InstancePool::release(PooledInstance* ptr) {
+	std::unique_ptr<PooledInstance> inst(ptr);
+
+	// Reset outside the lock. An instance that fails to reset is dropped, not reused.
+	bool reusable = true;
+	try {
+		inst->reset();
+	} catch (const PageError&) {
+		reusable = false;
+	}
+
+	std::lock_guard<std::mutex> guard(lock_);
+	--lease_count_;
+	if (reusable && idle_.size() < capacity_) {
+		idle_.push_back(std::move(inst));
+	}
+}
+
+}  // namespace Ab
@@ -0,0 +1,248 @@
+#include <Ab/Config.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/Page.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Ab {
+
+///
+/// MemorySnapshot
+///
+
+std::shared_ptr<const MemorySnapshot> MemorySnapshot::capture(const LinearMemory& memory) {
+	int fd = memfd_create("ab-memory-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0) {
+		throw LinearMemoryError("Failed to create memory snapshot file.");
+	}
+
+	std::size_t page_count = memory.page_count();
+	std::size_t size       = page_count * LinearMemory::page_size();
+	const Byte* data       = memory.address();
+
+	if (ftruncate(fd, off_t(size)) != 0) {
+		close(fd);
+		throw LinearMemoryError("Failed to size memory snapshot file.");
+	}
+
+	// Pages of zeroes are left as holes in the file.
+	std::size_t page_size = LinearMemory::page_size();
+	for (std::size_t offset = 0; offset < size; offset += page_size) {
+		const Byte* page = data + offset;
+		if (std::all_of(page, page + page_size, [](Byte b) { return b == 0; })) {
+			continue;
+		}
+		std::size_t written = 0;
+		while (written < page_size) {
+			auto n = pwrite(fd, page + written, page_size - written, off_t(offset + written));
+			if (n < 0) {
+				close(fd);
+				throw LinearMemoryError("Failed to write memory snapshot file.");
+			}
+			written += std::size_t(n);
+		}
+	}
+
+	// Seal the file, so every mapping is guaranteed to see the same image.
+	if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+		close(fd);
+		throw LinearMemoryError("Failed to seal memory snapshot file.");
+	}
+
+	return std::shared_ptr<const MemorySnapshot>(new MemorySnapshot(fd, page_count));
+}
+
+MemorySnapshot::~MemorySnapshot() noexcept { close(fd_); }
+
+std::size_t MemorySnapshot::size() const noexcept {
+	return page_count_ * LinearMemory::page_size();
+}
+
+///
+/// LinearMemory
+///
+
+LinearMemory::LinearMemory(
+	const LinearMemoryConfig& config, std::shared_ptr<const MemorySnapshot> snapshot)
+	: address_(nullptr), page_count_(0), config_(config), snapshot_(std::move(snapshot)) {
+	config_.verify();
+	if (snapshot_->page_count() > config_.page_count_max) {
+		throw LinearMemoryError("Snapshot is larger than the memory's maximum size.");
+	}
+
+	// A private file mapping can't be placed inside a mapping of explicit huge pages.
+	reserve(
+		config_.huge_pages == HugePagePolicy::EXPLICIT ? HugePagePolicy::TRANSPARENT
+													   : config_.huge_pages);
+	if (snapshot_->page_count() != 0) {
+		auto permissions = PagePermission::READ | PagePermission::WRITE;
+		Page::map_file_private(address_, snapshot_->size(), permissions, snapshot_->fd());
+		publish_page_count(snapshot_->page_count());
+	}
+	if (page_count() < config_.page_count_min) {
+		grow(config_.page_count_min - page_count());
+	}
+}
+
+void LinearMemory::reserve(HugePagePolicy policy) {
+	// mmap can't map nothing. A memory that can't grow still reserves a page. verify caps the
+	// maximum, but a reservation that wraps would let the memory grow past it's end.
+	std::size_t page_count = std::max<std::size_t>(config_.page_count_max, 1);
+	std::size_t size;
+	if (__builtin_mul_overflow(page_count, page_size(), &size)) {
+		throw LinearMemoryError("Linear memory reservation is too large");
+	}
+	if (policy != HugePagePolicy::NONE) {
+		size = (size + Page::HUGE_SIZE - 1) / Page::HUGE_SIZE * Page::HUGE_SIZE;
+	}
+
+	if (policy == HugePagePolicy::EXPLICIT) {
+		address_ = Page::map_huge(config_.address, size);
+		if (address_ == nullptr) {
+			policy = HugePagePolicy::TRANSPARENT;
+		}
+	}
+
+	if (policy == HugePagePolicy::TRANSPARENT) {
+		address_ = Page::map_aligned(config_.address, size, Page::HUGE_SIZE);
+		if (!Page::advise_huge(address_, size)) {
+			policy = HugePagePolicy::NONE;
+		}
+	}
+
+	if (policy == HugePagePolicy::NONE && address_ == nullptr) {
+		address_ = Page::map(config_.address, size);
+	}
+
+	reserved_size_ = size;
+	huge_pages_    = policy;
+
+	if (config_.numa == NumaPolicy::LOCAL) {
+		bind_to_node(Process::numa_node());
+	}
+}
+
+bool LinearMemory::bind_to_node(int node) noexcept {
+	if (numa_node_.load(std::memory_order_relaxed) == node) {
+		return true;
+	}
+	if (!Page::bind(address_, reserved_size_, node, true)) {
+		return false;
+	}
+	numa_node_.store(node, std::memory_order_relaxed);
+	return true;
+}
+
+std::size_t LinearMemory::load(
+	std::size_t offset, const Byte* data, std::size_t size, int fd, std::uint64_t file_offset) {
+	std::lock_guard<std::mutex> guard(grow_lock_);
+
+	std::size_t memory_size = page_count_.load(std::memory_order_relaxed) * page_size();
+	if (offset > memory_size || size > memory_size - offset) {
+		throw LinearMemoryError("Failed to load data: out of bounds.");
+	}
+
+	// The whole pages of the range. A mapping can't replace part of an explicit huge page, and
+	// discarding pages mapped over a snapshot would read them back from the wrong file.
+	std::size_t page  = page_size();
+	std::size_t begin = (offset + page - 1) / page * page;
+	std::size_t end   = (offset + size) / page * page;
+	bool mappable     = fd >= 0 && begin < end && offset % page == file_offset % page &&
+					huge_pages_ != HugePagePolicy::EXPLICIT && !snapshot_;
+
+	if (!mappable) {
+		std::memcpy(address_ + offset, data, size);
+		return 0;
+	}
+
+	std::memcpy(address_ + offset, data, begin - offset);
+	std::memcpy(address_ + end, data + (end - offset), offset + size - end);
+
+	auto permissions = PagePermission::READ | PagePermission::WRITE;
+	Page::map_file_private(
+		address_ + begin, end - begin, permissions, fd, off_t(file_offset + (begin - offset)));
+
+	if (mapped_begin_ == mapped_end_) {
+		mapped_begin_ = begin;
+		mapped_end_   = end;
+	} else {
+		mapped_begin_ = std::min(mapped_begin_, begin);
+		mapped_end_   = std::max(mapped_end_, end);
+	}
+	return end - begin;
+}
+
+void LinearMemory::unmap_file_pages(std::size_t offset, int permissions) {
+	if (offset >= mapped_end_) {
+		return;
+	}
+	std::size_t begin = std::max(offset, mapped_begin_);
+	Page::map_fixed(address_ + begin, mapped_end_ - begin, permissions);
+	if (begin == mapped_begin_) {
+		mapped_begin_ = mapped_end_ = 0;
+	} else {
+		mapped_end_ = begin;
+	}
+}
+
+void LinearMemory::shrink(std::size_t n, PageRelease release) {
+	std::lock_guard<std::mutex> guard(grow_lock_);
+
+	std::size_t page_count = page_count_.load(std::memory_order_relaxed);
+	if (page_count < n) {
+		throw LinearMemoryError("Failed to shrink: not enough active pages.");
+	}
+	if (snapshot_ && page_count - n < snapshot_->page_count()) {
+		throw LinearMemoryError("Failed to shrink: the memory can't shrink below it's snapshot.");
+	}
+
+	// Publish the smaller size first, so bounds checks stop admitting the released pages.
+	publish_page_count(page_count - n);
+
+	std::size_t begin = (page_count - n) * page_size();
+	std::size_t end   = page_count * page_size();
+
+	// A commit granule straddling the new end stays committed. It's released part is cleared by
+	// hand.
+	std::size_t boundary = commit_boundary(begin);
+	if (boundary > begin) {
+		std::memset(address_ + begin, 0, std::min(boundary, end) - begin);
+	}
+	if (boundary >= end) {
+		return;
+	}
+
+	unmap_file_pages(boundary, PagePermission::NONE);
+
+	std::size_t size = commit_boundary(end) - boundary;
+	if (release == PageRelease::LAZY && Page::discard_lazily(address_ + boundary, size)) {
+		lazy_end_ = std::max(lazy_end_, boundary + size);
+	} else {
+		Page::discard(address_ + boundary, size);
+	}
+	deactivate(address_ + begin, n);
+}
+
+void LinearMemory::reset() {
+	std::lock_guard<std::mutex> guard(grow_lock_);
+
+	std::size_t page_count   = page_count_.load(std::memory_order_relaxed);
+	std::size_t snapshot_end = snapshot_ ? snapshot_->page_count() : 0;
+	std::size_t initial      = std::max(snapshot_end, config_.page_count_min);
+
+	// Discarding private file pages reverts them to the snapshot. Discarding anonymous pages
+	// reverts them to zero. Pages loaded from any other file are replaced outright.
+	unmap_file_pages(0, PagePermission::READ | PagePermission::WRITE);
+	Page::discard(address_, commit_boundary(page_count * page_size()));
+
+	if (page_count > initial) {
+		deactivate(address_ + (initial * page_size()), page_count - initial);
+	}
+
+	publish_page_count(initial);
+}
+
+}  // namespace Ab
@@ -1,18 +1,24 @@
+#include <Ab/Aot.hpp>
+#include <Ab/BoundsCheck.hpp>
 #include <Ab/Loading.hpp>
+#include <Ab/TypeRegistry.hpp>
 #include <Ab/VectorUtilities.hpp>
 #include <absl/types/span.h>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <type_traits>
+#include <unistd.h>
 
 namespace Ab {
 
-class DecodeError : public std::runtime_error {
-public:
-	using std::runtime_error::runtime_error;
-};
-
 class Decoder {
 public:
 	Decoder(absl::Span<Byte> bytes) : position_(bytes.data()), bytes_(bytes) {}
@@ -100,6 +106,8 @@ public:
 
 	std::uint32_t read_varu32() { return read_varu<32, std::uint32_t>(); }
 
+	std::uint64_t read_varu64() { return read_varu<64, std::uint64_t>(); }
+
 	std::uint8_t read_varu7() { return read_varu<7, std::uint8_t>(); }
 
 	std::uint8_t read_byte() { return read<std::uint8_t>(); }
@@ -108,13 +116,13 @@ public:
 
 	std::uint32_t read_u32() { return read<std::uint32_t>(); }
 
-	std::uint32_t read_u64() { return read<std::uint64_t>(); }
+	std::uint64_t read_u64() { return read<std::uint64_t>(); }
 
 	std::int8_t read_i8() { return read<std::int8_t>(); }
 
 	std::int32_t read_i32() { return read<std::int32_t>(); }
 
-	std::int32_t read_i64() { return read<std::int64_t>(); }
+	std::int64_t read_i64() { return read<std::int64_t>(); }
 
 	SectionCode read_section_code() {
 		SectionCode code = read<SectionCode>();
@@ -126,6 +134,39 @@ public:
 
 	ValType read_val_type() { return read<ValType>(); }
 
+	/// Read a length-prefixed run of bytes. The result points into the decoded bytes.
+	///
+	absl::Span<const Byte> read_bytes() {
+		std::uint32_t size = read_varu32();
+		if (std::size_t(end() - position_) < size) {
+			throw DecodeError("Read past end of buffer");
+		}
+		absl::Span<const Byte> bytes(position_, size);
+		position_ += size;
+		return bytes;
+	}
+
+	/// Skip over n bytes.
+	///
+	void skip(std::size_t n) {
+		if (std::size_t(end() - position_) < n) {
+			throw DecodeError("Read past end of buffer");
+		}
+		position_ += n;
+	}
+
+	/// Read a length-prefixed name. The name points into the decoded bytes.
+	///
+	std::string_view read_name() {
+		std::uint32_t size = read_varu32();
+		if (std::size_t(end() - position_) < size) {
+			throw DecodeError("Read past end of buffer");
+		}
+		std::string_view name(reinterpret_cast<const char*>(position_), size);
+		position_ += size;
+		return name;
+	}
+
 	template <typename T>
 	T read() {
 		static_assert(std::is_trivial_v<T>);
@@ -164,6 +205,34 @@ void decode_type_section(Context& cx, Module& module, Decoder& decoder, std::uin
 		for (std::size_t i = 0; i < nrets; ++i) {
 			type.rets.push_back(decoder.read_val_type());
 		}
+
+		module.type_ids().push_back(TypeRegistry::intern(type));
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+void decode_import_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nimports = decoder.read_varu32();
+	module.import_table().reserve(nimports);
+
+	for (std::size_t i = 0; i < nimports; ++i) {
+		ImportEntry& entry = push(module.import_table());
+		entry.module       = decoder.read_name();
+		entry.name         = decoder.read_name();
+		entry.kind         = decoder.read<ExternalKind>();
+		if (entry.kind != ExternalKind::FUNC) {
+			throw DecodeError("Unsupported import kind");
+		}
+		entry.type_idx = decoder.read_varu32();
+		if (entry.type_idx >= module.type_table().size()) {
+			throw DecodeError("Import of an undefined type");
+		}
 	}
 
 	Byte* end = decoder.position();
@@ -188,6 +257,174 @@ void decode_func_section(Context& cx, Module& module, Decoder& decoder, std::uin
 	}
 }
 
+void decode_table_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t ntables = decoder.read_varu32();
+	module.table_table().reserve(ntables);
+
+	for (std::size_t i = 0; i < ntables; ++i) {
+		TableEntry& entry = push(module.table_table());
+		entry.size_min    = decoder.read_varu32();
+		entry.size_max    = decoder.read_varu32();
+		if (entry.size_max < entry.size_min) {
+			throw DecodeError("Table minimum is greater than it's maximum");
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+void decode_memory_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nmemories = decoder.read_varu32();
+	module.memory_table().reserve(nmemories);
+
+	for (std::size_t i = 0; i < nmemories; ++i) {
+		MemoryEntry& entry = push(module.memory_table());
+		std::uint8_t flags = decoder.read_u8();
+		if (flags > (std::uint8_t(MemoryFlags::SHARED) | std::uint8_t(MemoryFlags::MEMORY64))) {
+			throw DecodeError("Invalid memory flags");
+		}
+		entry.shared   = (flags & std::uint8_t(MemoryFlags::SHARED)) != 0;
+		entry.memory64 = (flags & std::uint8_t(MemoryFlags::MEMORY64)) != 0;
+
+		// The limits of a memory64 are 64 bits wide.
+		if (entry.memory64) {
+			entry.page_count_min = decoder.read_varu64();
+			entry.page_count_max = decoder.read_varu64();
+		} else {
+			entry.page_count_min = decoder.read_varu32();
+			entry.page_count_max = decoder.read_varu32();
+		}
+		if (entry.page_count_max < entry.page_count_min) {
+			throw DecodeError("Memory minimum is greater than it's maximum");
+		}
+		// A memory64 maximum could otherwise overflow when scaled to bytes. 32-bit limits can't,
+		// and LinearMemoryConfig::verify reports them when instantiated.
+		if (entry.memory64 && entry.page_count_max > LinearMemoryConfig::max_page_count(true)) {
+			throw DecodeError("Memory maximum is too large");
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+void decode_global_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nglobals = decoder.read_varu32();
+	module.global_table().reserve(nglobals);
+
+	for (std::size_t i = 0; i < nglobals; ++i) {
+		GlobalEntry& entry = push(module.global_table());
+		entry.type         = decoder.read_val_type();
+		std::uint8_t flag  = decoder.read_u8();
+		entry.init         = decoder.read_u64();
+		if (flag > 1) {
+			throw DecodeError("Invalid global mutability");
+		}
+		entry.is_mutable = flag == 1;
+		switch (entry.type) {
+		case ValType::I32:
+		case ValType::F32:
+			if (entry.init > std::numeric_limits<std::uint32_t>::max()) {
+				throw DecodeError("Global initializer is too wide");
+			}
+			break;
+		case ValType::I64:
+		case ValType::F64:
+			break;
+		default:
+			throw DecodeError("Unsupported global type");
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+void decode_export_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nexports = decoder.read_varu32();
+	module.export_table().reserve(nexports);
+
+	for (std::size_t i = 0; i < nexports; ++i) {
+		ExportEntry& entry = push(module.export_table());
+		entry.name         = decoder.read_name();
+		entry.kind         = decoder.read<ExternalKind>();
+		entry.index        = decoder.read_varu32();
+		if (entry.kind != ExternalKind::FUNC) {
+			throw DecodeError("Unsupported export kind");
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+/// Check the export table against the decoded module, and build the export index.
+///
+void index_exports(Module& module) {
+	for (const auto& entry : module.export_table()) {
+		if (entry.index >= module.func_count()) {
+			throw DecodeError("Export of an undefined function");
+		}
+	}
+	if (!module.index_exports()) {
+		throw DecodeError("Duplicate export name");
+	}
+}
+
+/// Element segments are checked against the tables and function index space, which come before
+/// them, so linking an instance never writes out of bounds.
+///
+void decode_element_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nsegments = decoder.read_varu32();
+	module.element_table().reserve(nsegments);
+
+	for (std::size_t i = 0; i < nsegments; ++i) {
+		ElementSegment& segment = push(module.element_table());
+		segment.table           = decoder.read_varu32();
+		segment.offset          = decoder.read_varu32();
+		std::uint32_t nfuncs    = decoder.read_varu32();
+		if (segment.table >= module.table_table().size()) {
+			throw DecodeError("Element segment for an undefined table");
+		}
+		if (std::uint64_t(segment.offset) + nfuncs >
+			module.table_table()[segment.table].size_min) {
+			throw DecodeError("Element segment is out of the table's bounds");
+		}
+		segment.funcs.reserve(nfuncs);
+		for (std::size_t j = 0; j < nfuncs; ++j) {
+			std::uint32_t index = decoder.read_varu32();
+			if (index >= module.func_count()) {
+				throw DecodeError("Element of an undefined function");
+			}
+			segment.funcs.push_back(index);
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
 void decode_code_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
 	Byte* start = decoder.position();
 
@@ -205,7 +442,60 @@ void decode_code_section(Context& cx, Module& module, Decoder& decoder, std::uin
 		std::uint32_t nregs = decoder.read_varu32();
 		Byte* body          = decoder.position();
 		decoder.reposition(start + size);
-		module.func_table().emplace_back(&module.type_for(i), body, nregs);
+		module.func_table().emplace_back(
+			&module.type_for(i), absl::Span<Byte>(body, start + size - body), nregs);
+	}
+}
+
+/// Each data segment is it's flags, then for an active segment, it's memory and offset. Then the
+/// segment's size, the size of the padding before it's bytes, the padding, and the bytes.
+///
+void decode_data_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nsegments = decoder.read_varu32();
+	module.data_table().reserve(nsegments);
+
+	for (std::size_t i = 0; i < nsegments; ++i) {
+		std::uint8_t flags = decoder.read_u8();
+		if (flags > std::uint8_t(DataFlags::ACTIVE)) {
+			throw DecodeError("Invalid data segment flags");
+		}
+
+		ActiveDataEntry entry;
+		bool active = flags == std::uint8_t(DataFlags::ACTIVE);
+		if (active) {
+			entry.segment = i;
+			entry.memory  = decoder.read_varu32();
+			entry.offset  = decoder.read_varu64();
+		}
+
+		std::uint32_t length  = decoder.read_varu32();
+		std::uint32_t padding = decoder.read_varu32();
+		decoder.skip(padding);
+		Byte* bytes = decoder.position();
+		decoder.skip(length);
+		module.data_table().push_back(absl::Span<const Byte>(bytes, length));
+
+		if (active) {
+			if (entry.memory >= module.memory_table().size()) {
+				throw DecodeError("Data segment memory index out of bounds");
+			}
+			std::uint64_t page_count = module.memory_table()[entry.memory].page_count_min;
+			std::uint64_t limit;
+			if (__builtin_mul_overflow(page_count, LinearMemory::page_size(), &limit)) {
+				throw DecodeError("Data segment memory is too large");
+			}
+			if (entry.offset > limit || length > limit - entry.offset) {
+				throw DecodeError("Data segment out of bounds of it's memory");
+			}
+			module.active_data_table().push_back(entry);
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
 	}
 }
 
@@ -232,19 +522,100 @@ std::shared_ptr<Module> compile(Context& cx, ModuleStorage&& storage) {
 		case SectionCode::TYPE:
 			decode_type_section(cx, *module, decoder, section_size);
 			break;
+		case SectionCode::IMPORT:
+			decode_import_section(cx, *module, decoder, section_size);
+			break;
 		case SectionCode::FUNC:
 			decode_func_section(cx, *module, decoder, section_size);
 			break;
+		case SectionCode::TABLE:
+			decode_table_section(cx, *module, decoder, section_size);
+			break;
+		case SectionCode::MEMORY:
+			decode_memory_section(cx, *module, decoder, section_size);
+			break;
+		case SectionCode::GLOBAL:
+			decode_global_section(cx, *module, decoder, section_size);
+			break;
+		case SectionCode::EXPORT:
+			decode_export_section(cx, *module, decoder, section_size);
+			break;
+		case SectionCode::ELEMENT:
+			decode_element_section(cx, *module, decoder, section_size);
+			break;
 		case SectionCode::CODE:
 			decode_code_section(cx, *module, decoder, section_size);
 			break;
+		case SectionCode::DATA:
+			decode_data_section(cx, *module, decoder, section_size);
+			break;
 		default:
 			AB_ASSERT_UNREACHABLE();
 			break;
 		}
 	}
 
+	index_exports(*module);
+	eliminate_bounds_checks(*module);
+
 	return module;
 }
 
+/// Read an entire file into a malloc'd buffer, suitable for a ModuleStorage.
+///
+static ModuleStorage read_module_file(const std::string& filename) {
+	std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!in.is_open()) {
+		throw DecodeError("Failed to open module file: " + filename);
+	}
+
+	std::size_t size = in.tellg();
+	in.seekg(0);
+
+	Byte* data = static_cast<Byte*>(std::malloc(size));
+	if (data == nullptr && size != 0) {
+		throw DecodeError("Failed to allocate module storage");
+	}
+
+	ModuleStorage storage(absl::Span<Byte>(data, size));
+	in.read(reinterpret_cast<char*>(data), size);
+	if (std::size_t(in.gcount()) != size) {
+		throw DecodeError("Failed to read module file: " + filename);
+	}
+	return storage;
+}
+
+ModuleStorage ModuleStorage::map_file(const std::string& filename) {
+	int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		throw DecodeError("Failed to open module file: " + filename);
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+		close(fd);
+		return read_module_file(filename);
+	}
+
+	std::size_t size = std::size_t(st.st_size);
+	void* p          = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		close(fd);
+		return read_module_file(filename);
+	}
+	return ModuleStorage(absl::Span<Byte>(static_cast<Byte*>(p), size), fd);
+}
+
+void ModuleStorage::unmap_file(absl::Span<Byte> bytes, int fd) noexcept {
+	munmap(bytes.data(), bytes.size());
+	close(fd);
+}
+
+std::shared_ptr<Module> compile(Context& cx, const std::string& filename) {
+	if (is_aot_artifact(filename)) {
+		return load_aot_artifact(cx, filename);
+	}
+	return compile(cx, ModuleStorage::map_file(filename));
+}
+
 }  // namespace Ab
@@ -0,0 +1,83 @@
+#include <Ab/Config.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/MemoryProfile.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace Ab {
+
+///
+/// HeatMap
+///
+
+void HeatMap::add(std::uint64_t address, MemoryAccess access) {
+	std::size_t page = address / LinearMemory::page_size();
+	if (page >= loads_.size()) {
+		loads_.resize(page + 1);
+		stores_.resize(page + 1);
+	}
+	if (access == MemoryAccess::LOAD) {
+		++loads_[page];
+	} else {
+		++stores_[page];
+	}
+}
+
+std::uint64_t HeatMap::total() const noexcept {
+	return std::accumulate(loads_.begin(), loads_.end(), std::uint64_t(0)) +
+		   std::accumulate(stores_.begin(), stores_.end(), std::uint64_t(0));
+}
+
+std::vector<std::uint64_t> HeatMap::regions(std::size_t granule) const {
+	std::size_t pages_per_region = granule / LinearMemory::page_size();
+	AB_ASSERT(pages_per_region != 0);
+
+	std::vector<std::uint64_t> result((page_count() + pages_per_region - 1) / pages_per_region);
+	for (std::size_t page = 0; page < page_count(); ++page) {
+		result[page / pages_per_region] += count(page);
+	}
+	return result;
+}
+
+std::vector<std::size_t> HeatMap::hottest(std::size_t n) const {
+	std::vector<std::size_t> pages;
+	for (std::size_t page = 0; page < page_count(); ++page) {
+		if (count(page) != 0) {
+			pages.push_back(page);
+		}
+	}
+	n = std::min(n, pages.size());
+	std::partial_sort(pages.begin(), pages.begin() + n, pages.end(), [&](auto a, auto b) {
+		return count(a) > count(b) || (count(a) == count(b) && a < b);
+	});
+	pages.resize(n);
+	return pages;
+}
+
+///
+/// MemoryProfile
+///
+
+void MemoryProfile::flush() {
+	for (std::size_t i = 0; i < head_; ++i) {
+		const MemorySample& sample = samples_[i];
+		heat_maps_[sample.memory].add(sample.address, sample.access);
+	}
+	flushed_ += head_;
+	head_ = 0;
+}
+
+const HeatMap* MemoryProfile::heat_map(const LinearMemory* memory) {
+	flush();
+	auto it = heat_maps_.find(memory);
+	return it == heat_maps_.end() ? nullptr : &it->second;
+}
+
+void MemoryProfile::clear() noexcept {
+	head_      = 0;
+	flushed_   = 0;
+	countdown_ = period_;
+	heat_maps_.clear();
+}
+
+}  // namespace Ab
@@ -0,0 +1,85 @@
+#include <Ab/Config.hpp>
+#include <Ab/Resolver.hpp>
+
+namespace Ab {
+
+///
+/// Resolver
+///
+
+Resolver::~Resolver() noexcept {}
+
+///
+/// BasicResolver
+///
+
+void BasicResolver::define(std::string_view module, std::string_view symbol, FuncInst* func) {
+	std::lock_guard<std::mutex> guard(lock_);
+	index_[key(module, symbol)] = ExternVal(func);
+}
+
+void BasicResolver::define_module(std::string_view module, ModuleInst* inst) {
+	AB_ASSERT(inst->linked());
+	std::lock_guard<std::mutex> guard(lock_);
+	for (const auto& entry : inst->shared_module()->export_table()) {
+		if (entry.kind == ExternalKind::FUNC) {
+			index_[key(module, entry.name)] = ExternVal(inst->func(entry.index));
+		}
+	}
+}
+
+ExternVal BasicResolver::resolve(std::string_view module, std::string_view symbol) {
+	std::string k = key(module, symbol);
+	std::lock_guard<std::mutex> guard(lock_);
+	auto iter = index_.find(k);
+	if (iter == index_.end()) {
+		return ExternVal();
+	}
+	return iter->second;
+}
+
+/// Module names can not contain a nul, so the key is unambiguous.
+///
+std::string BasicResolver::key(std::string_view module, std::string_view symbol) {
+	std::string result;
+	result.reserve(module.size() + symbol.size() + 1);
+	result.append(module);
+	result.push_back('\0');
+	result.append(symbol);
+	return result;
+}
+
+///
+/// Linker
+///
+
+Linker::~Linker() noexcept {}
+
+///
+/// BasicLinker
+///
+
+void BasicLinker::link(ModuleInst* inst) {
+	const Module& module = *inst->shared_module();
+	const auto& imports  = module.import_table();
+
+	for (std::size_t i = 0; i < imports.size(); ++i) {
+		const ImportEntry& entry = imports[i];
+		ExternVal value          = resolver_->resolve(entry.module, entry.name);
+
+		if (value.kind() != ExternValKind::FUNC) {
+			throw LinkError("Unresolved import: " + entry.module + "." + entry.name);
+		}
+
+		FuncInst* func = value.func();
+		if (*func->type() != module.type_table()[entry.type_idx]) {
+			throw LinkError("Mismatched type for import: " + entry.module + "." + entry.name);
+		}
+
+		inst->bind_import(i, func);
+	}
+
+	inst->link();
+}
+
+}  // namespace Ab
@@ -0,0 +1,35 @@
+#include <Ab/Config.hpp>
+#include <Ab/TypeRegistry.hpp>
+#include <mutex>
+#include <unordered_map>
+
+namespace Ab {
+
+namespace {
+
+struct Registry {
+	std::mutex lock;
+	std::unordered_map<FuncType, TypeId> ids;
+};
+
+Registry& registry() {
+	static Registry instance;
+	return instance;
+}
+
+}  // namespace
+
+TypeId TypeRegistry::intern(const FuncType& type) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> guard(r.lock);
+	auto [it, inserted] = r.ids.try_emplace(type, TypeId(r.ids.size() + 1));
+	return it->second;
+}
+
+std::size_t TypeRegistry::size() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> guard(r.lock);
+	return r.ids.size();
+}
+
+}  // namespace Ab
@@ -1,9 +1,77 @@
 #include <Ab/Config.hpp>
 #include <Ab/Assert.hpp>
+#include <Ab/Loading.hpp>
 #include <Ab/VirtualMachine.hpp>
+#include <algorithm>
 
 namespace Ab {
 
+VirtualMachine::VirtualMachine(Runtime* runtime)
+	: runtime_(runtime), module_snapshot_(std::make_shared<const ModuleSnapshot>()) {}
+
+VirtualMachine::VirtualMachine(Runtime* runtime, const LinearMemoryConfig& memory_config)
+	: runtime_(runtime),
+	  memory_config_(memory_config),
+	  module_snapshot_(std::make_shared<const ModuleSnapshot>()) {}
+
+VirtualMachine::~VirtualMachine() noexcept { AB_ASSERT(context_count_ == 0); }
+
+Handle<ModuleInst> VirtualMachine::instantiate(const std::shared_ptr<Module>& module) {
+	Handle<ModuleInst> handle;
+	ModuleInst* ptr = nullptr;
+	{
+		std::lock_guard<std::mutex> guard(module_lock_);
+		handle = store_.instances().create(module, memory_config_);
+		ptr    = store_.instances().get(handle);
+	}
+
+	// Link outside the lock. The instance is not yet published, so it is private to this thread.
+	if (!ptr->linked()) {
+		try {
+			BasicLinker(&resolver_).link(ptr);
+		} catch (...) {
+			std::lock_guard<std::mutex> guard(module_lock_);
+			store_.instances().destroy(handle);
+			throw;
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(module_lock_);
+
+	auto snapshot = std::make_shared<ModuleSnapshot>(*module_snapshot_);
+	snapshot->push_back(ptr);
+	publish(std::move(snapshot));
+
+	return handle;
+}
+
+ModuleInst* VirtualMachine::instance(Handle<ModuleInst> handle) {
+	std::lock_guard<std::mutex> guard(module_lock_);
+	return store_.instances().get(handle);
+}
+
+void VirtualMachine::destroy(Handle<ModuleInst> handle) {
+	std::lock_guard<std::mutex> guard(module_lock_);
+	ModuleInst* ptr = store_.instances().get(handle);
+	AB_ASSERT(ptr != nullptr);
+
+	auto snapshot = std::make_shared<ModuleSnapshot>(*module_snapshot_);
+	snapshot->erase(std::remove(snapshot->begin(), snapshot->end(), ptr), snapshot->end());
+	publish(std::move(snapshot));
+
+	store_.instances().destroy(handle);
+}
+
+void VirtualMachine::publish(std::shared_ptr<const ModuleSnapshot> snapshot) noexcept {
+	std::atomic_store_explicit(&module_snapshot_, std::move(snapshot), std::memory_order_release);
+}
+
+FuncInst* VirtualMachine::new_host_func(FuncType&& type, NativeFn native, PrimitiveFn primitive) {
+	std::lock_guard<std::mutex> guard(module_lock_);
+	auto handle = store_.funcs().create(std::move(type), native, primitive);
+	return store_.funcs().get(handle)->inst();
+}
+
 Module* load_module(Context& cx, const char* filename) {
 	(void)cx;
 	(void)filename;
@@ -23,9 +91,7 @@ void link_module(Context& cx, Module* module) {
 }
 
 ModuleInst* instantiate_file(Context& cx, const std::string& filename) {
-	(void)cx;
-	(void)filename;
-	AB_ASSERT_UNIMPLEMENTED();
+	return instantiate(cx, compile(cx, filename));
 }
 
 void run_func(Context& cx, FuncInst* func) {
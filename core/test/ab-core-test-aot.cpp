@@ -0,0 +1,237 @@
+#include <Ab/Config.hpp>
+#include <Ab/Aot.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestAot : public BasicTest {};
+
+/// True if the default C compiler can be run. Tests building an artifact are skipped without one,
+/// but any other failure to build is a test failure.
+///
+bool have_cc() {
+	std::string command = AotConfig().cc + " --version >/dev/null 2>&1";
+	return std::system(command.c_str()) == 0;
+}
+
+/// A module with a single function, (i32 i32) -> i32, which adds it's arguments.
+///
+absl::Span<Byte> make_add_module() {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	FuncNode& func = push_func(mod, 0, 1);
+	func.push<I32AddInsnNode>(2, 0, 1);
+	func.push<X32ReturnInsnNode>(2);
+	return mod.write();
+}
+
+TEST_F(TestAot, WriteSource) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_add_module());
+
+	std::stringstream out;
+	write_aot_source(out, *module);
+	auto source = out.str();
+
+	EXPECT_NE(source.find("ab_aot_func_0"), std::string::npos);
+	EXPECT_NE(source.find(AOT_FUNCS_SYMBOL), std::string::npos);
+	EXPECT_NE(source.find(AOT_MODULE_SYMBOL), std::string::npos);
+	EXPECT_NE(source.find("AB_X32(2) = AB_X32(0) + AB_X32(1);"), std::string::npos);
+}
+
+/// A module with an immutable i32 global, an immutable i64 global, and a mutable i32 global, and a
+/// function reading each. The mutable global's reader is optional.
+///
+absl::Span<Byte> make_globals_module(bool read_mutable) {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{}, {ValType::I32}});
+	mod.types.push_back(FuncType{{}, {ValType::I64}});
+	mod.globals.push_back({ValType::I32, false, 42});
+	mod.globals.push_back({ValType::I64, false, 0x123456789});
+	mod.globals.push_back({ValType::I32, true, 7});
+	for (std::uint32_t i = 0; i < (read_mutable ? 3 : 2); ++i) {
+		FuncNode& func = push_func(mod, i == 1 ? 1 : 0, 2);
+		if (i == 1) {
+			func.push<GetGlobalX64InsnNode>(0, i);
+			func.push<X64ReturnInsnNode>(0);
+		} else {
+			func.push<GetGlobalX32InsnNode>(0, i);
+			func.push<X32ReturnInsnNode>(0);
+		}
+	}
+	return mod.write();
+}
+
+TEST_F(TestAot, ConstantGlobalsAreFolded) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_globals_module(false));
+
+	std::stringstream out;
+	write_aot_source(out, *module);
+	auto source = out.str();
+
+	EXPECT_NE(source.find("AB_X32(0) = 0x2au;"), std::string::npos);
+	EXPECT_NE(source.find("AB_X64(0) = 0x123456789ull;"), std::string::npos);
+}
+
+TEST_F(TestAot, MutableGlobalsAreNotTranslated) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_globals_module(true));
+
+	std::stringstream out;
+	write_aot_source(out, *module);
+	auto source = out.str();
+
+	// The mutable global's reader is left to the interpreter, the rest are translated.
+	EXPECT_NE(source.find("ab_aot_func_1"), std::string::npos);
+	EXPECT_EQ(source.find("ab_aot_func_2"), std::string::npos);
+	EXPECT_NE(source.find("\tab_aot_func_1,\n\t0,\n"), std::string::npos);
+}
+
+TEST_F(TestAot, BuildAndCall) {
+	if (!have_cc()) {
+		GTEST_SKIP() << "no C compiler available";
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	char dir[] = "/tmp/ab-core-test-aot-XXXXXX";
+	ASSERT_NE(mkdtemp(dir), nullptr);
+	std::string artifact = std::string(dir) + "/add.so";
+
+	build_aot_artifact(*compile(cx, make_add_module()), artifact, AotConfig());
+
+	EXPECT_TRUE(is_aot_artifact(artifact));
+
+	auto module = compile(cx, artifact);
+	ASSERT_EQ(module->func_table().size(), 1);
+	EXPECT_NE(module->func_table()[0].native(), nullptr);
+
+	ModuleInst* inst = instantiate(cx, module);
+	EXPECT_EQ(
+		static_call<std::int32_t>(cx, inst->func_inst(0), std::int32_t(33), std::int32_t(44)),
+		std::make_tuple(77));
+
+	unlink(artifact.c_str());
+	rmdir(dir);
+}
+
+TEST_F(TestAot, MutableGlobalsAreInterpreted) {
+	if (!have_cc()) {
+		GTEST_SKIP() << "no C compiler available";
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	char dir[] = "/tmp/ab-core-test-aot-XXXXXX";
+	ASSERT_NE(mkdtemp(dir), nullptr);
+	std::string artifact = std::string(dir) + "/globals.so";
+
+	build_aot_artifact(*compile(cx, make_globals_module(true)), artifact, AotConfig());
+
+	auto module = compile(cx, artifact);
+	ASSERT_EQ(module->func_table().size(), 3);
+	EXPECT_NE(module->func_table()[1].native(), nullptr);
+	EXPECT_EQ(module->func_table()[2].native(), nullptr);
+
+	ModuleInst* inst = instantiate(cx, module);
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0), std::make_tuple(42));
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst, 1), std::make_tuple(0x123456789));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2), std::make_tuple(7));
+
+	unlink(artifact.c_str());
+	rmdir(dir);
+}
+
+TEST_F(TestAot, CallsAndMemory) {
+	if (!have_cc()) {
+		GTEST_SKIP() << "no C compiler available";
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	char dir[] = "/tmp/ab-core-test-aot-XXXXXX";
+	ASSERT_NE(mkdtemp(dir), nullptr);
+	std::string artifact = std::string(dir) + "/memory.so";
+
+	// A module with one memory of one page, and the functions:
+	//   0: store (addr i32, val i32) -> ()
+	//   1: load  (addr i32) -> i32
+	//   2: store_and_load (addr i32, val i32) -> i32, calls store, then load.
+	//   3: size () -> i32, which has no translation.
+	//   4: size_and_load (addr i32) -> i32, returns the size plus the load of addr.
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 1});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {}});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{}, {ValType::I32}});
+
+	FuncNode& store = push_func(mod, 0, 0);
+	store.push<I32StoreInsnNode>(0, 1);
+	store.push<ReturnInsnNode>();
+
+	FuncNode& load = push_func(mod, 1, 0);
+	load.push<I32LoadInsnNode>(0, 0);
+	load.push<X32ReturnInsnNode>(0);
+
+	FuncNode& store_and_load = push_func(mod, 2, 0);
+	store_and_load.push<CallInsnNode>(0, 0);
+	store_and_load.push<CallInsnNode>(1, 0);
+	store_and_load.push<X32ReturnInsnNode>(0);
+
+	FuncNode& size = push_func(mod, 3, 1);
+	size.push<MemorySizeInsnNode>(0);
+	size.push<X32ReturnInsnNode>(0);
+
+	FuncNode& size_and_load = push_func(mod, 1, 1);
+	size_and_load.push<CallInsnNode>(3, 1);
+	size_and_load.push<CallInsnNode>(1, 0);
+	size_and_load.push<I32AddInsnNode>(0, 0, 1);
+	size_and_load.push<X32ReturnInsnNode>(0);
+
+	build_aot_artifact(*compile(cx, mod.write()), artifact, AotConfig());
+
+	auto module = compile(cx, artifact);
+	ASSERT_EQ(module->func_table().size(), 5);
+	EXPECT_NE(module->func_table()[2].native(), nullptr);
+	EXPECT_EQ(module->func_table()[3].native(), nullptr);
+
+	ModuleInst* inst = instantiate(cx, module);
+	auto page        = std::int32_t(LinearMemory::page_size());
+
+	// Unaligned, and at the very end of the memory.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2, std::int32_t(1), std::int32_t(0x1234)),
+			  std::make_tuple(0x1234));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2, page - 4, std::int32_t(-7)),
+			  std::make_tuple(-7));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(1)), std::make_tuple(0x1234));
+
+	// Translated code calls interpreted code, and the other way around.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 4, std::int32_t(1)), std::make_tuple(0x1235));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 3), std::make_tuple(1));
+
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 1, page - 3), Trap);
+	EXPECT_THROW(static_call<>(cx, inst, 0, page, std::int32_t(0)), Trap);
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 2, std::int32_t(-1), std::int32_t(0)), Trap);
+
+	unlink(artifact.c_str());
+	rmdir(dir);
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,206 @@
+#include <Ab/Config.hpp>
+#include <Ab/AtomicWait.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestAtomics : public BasicTest {};
+
+/// A module of atomic functions, over one memory, which is shared if the module is to be called
+/// from many threads:
+///   0: rmw_add  (addr i32, val i32) -> i32
+///   1: cmpxchg  (addr i32, expected i32, replacement i32) -> i32
+///   2: copy64   (src i32, dst i32) -> ()
+///   3: wait32   (addr i32, expected i32, timeout i64) -> i32
+///   4: notify   (addr i32, count i32) -> i32
+///
+absl::Span<Byte> make_atomics_module(bool shared = false) {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 4, shared});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32, ValType::I64}, {ValType::I32}});
+
+	FuncNode& rmw_add = push_func(mod, 0, 3);
+	rmw_add.push<I32AtomicRmwAddInsnNode>(2, 0, 1, 0);
+	rmw_add.push<X32ReturnInsnNode>(2);
+
+	FuncNode& cmpxchg = push_func(mod, 1, 4);
+	cmpxchg.push<I32AtomicRmwCmpxchgInsnNode>(3, 0, 1, 2, 0);
+	cmpxchg.push<X32ReturnInsnNode>(3);
+
+	FuncNode& copy64 = push_func(mod, 2, 4);
+	copy64.push<I64AtomicLoadInsnNode>(2, 0, 0);
+	copy64.push<I64AtomicStoreInsnNode>(1, 2, 0);
+	copy64.push<ReturnInsnNode>();
+
+	FuncNode& wait32 = push_func(mod, 3, 5);
+	wait32.push<MemoryAtomicWait32InsnNode>(4, 0, 1, 2, 0);
+	wait32.push<X32ReturnInsnNode>(4);
+
+	FuncNode& notify = push_func(mod, 0, 3);
+	notify.push<MemoryAtomicNotifyInsnNode>(2, 0, 1, 0);
+	notify.push<X32ReturnInsnNode>(2);
+
+	return mod.write();
+}
+
+TEST_F(TestAtomics, RmwAdd) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module());
+
+	memory_at<std::int32_t>(*inst->memory(0), 8) = 40;
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(8), std::int32_t(2)),
+			  std::make_tuple(40));
+	EXPECT_EQ(memory_at<std::int32_t>(*inst->memory(0), 8), 42);
+}
+
+TEST_F(TestAtomics, Cmpxchg) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module());
+
+	memory_at<std::int32_t>(*inst->memory(0), 4) = 1;
+
+	// Mismatch: memory is unchanged.
+	EXPECT_EQ(
+		static_call<std::int32_t>(cx, inst, 1, std::int32_t(4), std::int32_t(0), std::int32_t(7)),
+		std::make_tuple(1));
+	EXPECT_EQ(memory_at<std::int32_t>(*inst->memory(0), 4), 1);
+
+	// Match: the replacement is stored.
+	EXPECT_EQ(
+		static_call<std::int32_t>(cx, inst, 1, std::int32_t(4), std::int32_t(1), std::int32_t(7)),
+		std::make_tuple(1));
+	EXPECT_EQ(memory_at<std::int32_t>(*inst->memory(0), 4), 7);
+}
+
+TEST_F(TestAtomics, LoadStore64) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module());
+
+	memory_at<std::uint64_t>(*inst->memory(0), 16) = 0x0123456789abcdef;
+	static_call<>(cx, inst, 2, std::int32_t(16), std::int32_t(32));
+	EXPECT_EQ(memory_at<std::uint64_t>(*inst->memory(0), 32), 0x0123456789abcdef);
+}
+
+TEST_F(TestAtomics, OutOfBoundsTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module());
+
+	auto end = std::int32_t(inst->memory(0)->size());
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, end, std::int32_t(1)), Trap);
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, std::int32_t(-4), std::int32_t(1)), Trap);
+
+	// The context is usable after a trap.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(0), std::int32_t(1)),
+			  std::make_tuple(0));
+}
+
+TEST_F(TestAtomics, MisalignedTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module());
+
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, std::int32_t(2), std::int32_t(1)), Trap);
+	EXPECT_THROW(static_call<>(cx, inst, 2, std::int32_t(4), std::int32_t(0)), Trap);
+}
+
+TEST_F(TestAtomics, ConcurrentRmwAdd) {
+	constexpr std::size_t THREAD_COUNT = 4;
+	constexpr std::int32_t ITERATIONS  = 1000;
+
+	VirtualMachine vm(runtime());
+	ModuleInst* inst = nullptr;
+	{
+		Context cx(&vm);
+		inst = instantiate(cx, make_atomics_module(true));
+	}
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < THREAD_COUNT; ++i) {
+		threads.emplace_back([&] {
+			Context cx(&vm);
+			for (std::int32_t j = 0; j < ITERATIONS; ++j) {
+				static_call<std::int32_t>(cx, inst, 0, std::int32_t(0), std::int32_t(1));
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(memory_at<std::int32_t>(*inst->memory(0), 0), THREAD_COUNT * ITERATIONS);
+}
+
+TEST_F(TestAtomics, WaitNotEqual) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module(true));
+
+	memory_at<std::int32_t>(*inst->memory(0), 0) = 1;
+	EXPECT_EQ(static_call<std::int32_t>(
+				  cx, inst, 3, std::int32_t(0), std::int32_t(0), std::int64_t(-1)),
+			  std::make_tuple(std::int32_t(WaitResult::NOT_EQUAL)));
+}
+
+TEST_F(TestAtomics, WaitTimesOut) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module(true));
+
+	EXPECT_EQ(static_call<std::int32_t>(
+				  cx, inst, 3, std::int32_t(0), std::int32_t(0), std::int64_t(1000)),
+			  std::make_tuple(std::int32_t(WaitResult::TIMED_OUT)));
+}
+
+TEST_F(TestAtomics, WaitNotify) {
+	VirtualMachine vm(runtime());
+	ModuleInst* inst = nullptr;
+	{
+		Context cx(&vm);
+		inst = instantiate(cx, make_atomics_module(true));
+	}
+
+	std::int32_t result = -1;
+	std::thread waiter([&] {
+		Context cx(&vm);
+		std::tie(result) = static_call<std::int32_t>(
+			cx, inst, 3, std::int32_t(0), std::int32_t(0), std::int64_t(-1));
+	});
+
+	// Notifies before the waiter has parked wake nothing, so keep trying.
+	Context cx(&vm);
+	while (std::get<0>(static_call<std::int32_t>(
+			   cx, inst, 4, std::int32_t(0), std::int32_t(1))) == 0) {
+		std::this_thread::yield();
+	}
+
+	waiter.join();
+	EXPECT_EQ(result, std::int32_t(WaitResult::OK));
+}
+
+TEST_F(TestAtomics, WaitOnUnsharedMemoryTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_atomics_module());
+
+	EXPECT_THROW(static_call<std::int32_t>(
+					 cx, inst, 3, std::int32_t(0), std::int32_t(0), std::int64_t(0)),
+				 Trap);
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,325 @@
+#include <Ab/Config.hpp>
+#include <Ab/BoundsCheck.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Opcode.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestBoundsCheck : public BasicTest {};
+
+/// Append a memory-0 load or store, with it's two registers and offset.
+///
+void emit_access(
+	std::vector<Byte>& body, Opcode opcode, std::uint8_t a, std::uint8_t b, std::uint32_t offset) {
+	body.push_back(Byte(opcode));
+	body.push_back(a);
+	body.push_back(b);
+	auto at = body.size();
+	body.resize(at + sizeof(offset));
+	std::memcpy(&body[at], &offset, sizeof(offset));
+}
+
+/// Append a load or store on a memory64, with it's two registers, offset and memory.
+///
+void emit_access64(
+	std::vector<Byte>& body, Opcode opcode, std::uint8_t a, std::uint8_t b, std::uint64_t offset,
+	std::uint32_t memory = 0) {
+	body.push_back(Byte(opcode));
+	body.push_back(a);
+	body.push_back(b);
+	auto at = body.size();
+	body.resize(at + sizeof(offset) + sizeof(memory));
+	std::memcpy(&body[at], &offset, sizeof(offset));
+	std::memcpy(&body[at + sizeof(offset)], &memory, sizeof(memory));
+}
+
+std::vector<Opcode> opcodes_at(absl::Span<const Byte> body, std::vector<std::size_t> offsets) {
+	std::vector<Opcode> opcodes;
+	for (auto offset : offsets) {
+		opcodes.push_back(Opcode(body[offset]));
+	}
+	return opcodes;
+}
+
+/// A module with one memory of one page, and the functions:
+///   0: fill (addr i32) -> i32, stores addr at addr+8, loads the words at addr+4 and addr+12, and
+///      the double word at addr+8, then returns the word at addr+12.
+///   1: shift (addr i32) -> i32, loads the word at addr, doubles addr, and loads the word there.
+///
+absl::Span<Byte> make_bounds_check_module() {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 1});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+
+	FuncNode& fill = push_func(mod, 0, 3);
+	fill.push<I32StoreInsnNode>(0, 0, 8);
+	fill.push<I32LoadInsnNode>(1, 0, 4);
+	fill.push<I32LoadInsnNode>(1, 0, 12);
+	fill.push<I64LoadInsnNode>(2, 0, 8);
+	fill.push<X32ReturnInsnNode>(1);
+
+	FuncNode& shift = push_func(mod, 0, 1);
+	shift.push<I32LoadInsnNode>(1, 0, 0);
+	shift.push<I32AddInsnNode>(0, 0, 0);
+	shift.push<I32LoadInsnNode>(1, 0, 0);
+	shift.push<X32ReturnInsnNode>(1);
+
+	return mod.write();
+}
+
+TEST_F(TestBoundsCheck, CoveredAccessesAreUnchecked) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_bounds_check_module());
+
+	auto fill = module->func_table()[0].body_bytes();
+	EXPECT_EQ(
+		opcodes_at(fill, {0, 7, 14, 21}),
+		(std::vector<Opcode>{
+			Opcode::I32_STORE, Opcode::I32_LOAD_UNCHECKED, Opcode::I32_LOAD,
+			Opcode::I64_LOAD_UNCHECKED}));
+
+	// The add redefines the address, so the second load is checked.
+	auto shift = module->func_table()[1].body_bytes();
+	EXPECT_EQ(
+		opcodes_at(shift, {0, 11}), (std::vector<Opcode>{Opcode::I32_LOAD, Opcode::I32_LOAD}));
+
+	// Running the pass again changes nothing.
+	EXPECT_EQ(eliminate_bounds_checks(fill), 2);
+	EXPECT_EQ(eliminate_bounds_checks(shift), 0);
+}
+
+TEST_F(TestBoundsCheck, TrapsStayPrecise) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst     = instantiate(cx, make_bounds_check_module());
+	LinearMemory* memory = inst->memory(0);
+	auto size            = std::int32_t(memory->size());
+
+	std::int32_t value = 0x1234;
+	std::memcpy(memory->address() + 12, &value, sizeof(value));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(0)), std::make_tuple(value));
+
+	// The load at addr+12 traps, after the store at addr+8 is done.
+	std::int32_t addr = size - 12;
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, addr), Trap);
+	std::memcpy(&value, memory->address() + addr + 8, sizeof(value));
+	EXPECT_EQ(value, addr);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, size / 2 - 4), std::make_tuple(0));
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 1, size / 2), Trap);
+}
+
+TEST_F(TestBoundsCheck, ProofsEndAtBranchTargetsAndCalls) {
+	std::vector<Byte> body;
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	// A branch to the next instruction.
+	body.insert(body.end(), {Byte(Opcode::GOTO_IF), 1, 0});
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	body.insert(body.end(), {Byte(Opcode::CALL), 0, 0, 0, 0, 2});
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	body.push_back(Byte(Opcode::RETURN));
+
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 2);
+	EXPECT_EQ(
+		opcodes_at(body, {0, 7, 17, 24, 37}),
+		(std::vector<Opcode>{
+			Opcode::I32_LOAD, Opcode::I32_LOAD_UNCHECKED, Opcode::I32_LOAD,
+			Opcode::I32_LOAD_UNCHECKED, Opcode::I32_LOAD}));
+}
+
+TEST_F(TestBoundsCheck, UnprovenUncheckedAccessesAreChecked) {
+	std::vector<Byte> body;
+	emit_access(body, Opcode::I32_STORE_UNCHECKED, 0, 1, 0);
+	emit_access(body, Opcode::I64_LOAD_UNCHECKED, 1, 0, 0);
+	body.push_back(Byte(Opcode::RETURN));
+
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 0);
+	EXPECT_EQ(
+		opcodes_at(body, {0, 7}), (std::vector<Opcode>{Opcode::I32_STORE, Opcode::I64_LOAD}));
+}
+
+TEST_F(TestBoundsCheck, WideWritesEndProofs) {
+	// A 64-bit load into r0 also writes r1.
+	std::vector<Byte> body;
+	emit_access(body, Opcode::I32_LOAD, 2, 1, 0);
+	emit_access(body, Opcode::I64_LOAD, 0, 3, 0);
+	emit_access(body, Opcode::I32_LOAD, 2, 1, 0);
+	body.push_back(Byte(Opcode::RETURN));
+
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 0);
+	EXPECT_EQ(
+		opcodes_at(body, {0, 7, 14}),
+		(std::vector<Opcode>{Opcode::I32_LOAD, Opcode::I64_LOAD, Opcode::I32_LOAD}));
+
+	// A 64-bit address in r0 is read from r0 and r1, so a write to r1 ends it's proof. A write to
+	// r2 doesn't.
+	body.clear();
+	emit_access64(body, Opcode::I64_LOAD_A64, 4, 0, 0);
+	body.insert(body.end(), {Byte(Opcode::I32_ADD), 1, 2, 3});
+	emit_access64(body, Opcode::I64_LOAD_A64, 4, 0, 0);
+	body.insert(body.end(), {Byte(Opcode::I32_ADD), 2, 2, 3});
+	emit_access64(body, Opcode::I64_LOAD_A64, 4, 0, 0);
+	body.push_back(Byte(Opcode::RETURN));
+
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 1);
+	EXPECT_EQ(
+		opcodes_at(body, {0, 19, 38}),
+		(std::vector<Opcode>{
+			Opcode::I64_LOAD_A64, Opcode::I64_LOAD_A64, Opcode::I64_LOAD_A64_UNCHECKED}));
+}
+
+TEST_F(TestBoundsCheck, AscendingLoadsAreWidened) {
+	std::vector<Byte> body;
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	emit_access(body, Opcode::I32_LOAD, 2, 0, 4);
+	emit_access(body, Opcode::I64_LOAD, 2, 0, 8);
+	body.push_back(Byte(Opcode::RETURN));
+
+	// The first load checks the 16 bytes of all three.
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 2);
+	EXPECT_EQ(
+		opcodes_at(body, {0, 7, 14}),
+		(std::vector<Opcode>{
+			Opcode::I32_LOAD_WIDE, Opcode::I32_LOAD_UNCHECKED, Opcode::I64_LOAD_UNCHECKED}));
+	std::uint32_t immediate;
+	std::memcpy(&immediate, &body[I32_LOAD_WIDE_OFFSET_OFFSET], sizeof(immediate));
+	EXPECT_EQ(immediate, 16u << WIDE_LENGTH_SHIFT);
+
+	// Running the pass again changes nothing.
+	auto rewritten = body;
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 2);
+	EXPECT_EQ(body, rewritten);
+
+	// A widened load in the input is widened again, from it's offset alone.
+	body.clear();
+	emit_access(body, Opcode::I32_LOAD_WIDE, 1, 0, 0xff000000);
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 8);
+	body.push_back(Byte(Opcode::RETURN));
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 1);
+	std::memcpy(&immediate, &body[I32_LOAD_WIDE_OFFSET_OFFSET], sizeof(immediate));
+	EXPECT_EQ(immediate, 12u << WIDE_LENGTH_SHIFT);
+}
+
+TEST_F(TestBoundsCheck, WideningEndsAtStoresAndBranches) {
+	std::vector<Byte> body;
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	emit_access(body, Opcode::I32_STORE, 0, 1, 4);
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 8);
+	// A branch to the return.
+	body.insert(body.end(), {Byte(Opcode::GOTO_UNLESS), 1, 20});
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 12);
+	body.insert(body.end(), {Byte(Opcode::SET_GLOBAL_X32), 1, 0, 0, 0, 0});
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 16);
+	body.push_back(Byte(Opcode::RETURN));
+
+	// The store is covered, but no load after it.
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 1);
+	EXPECT_EQ(
+		opcodes_at(body, {0, 7, 14, 24, 37}),
+		(std::vector<Opcode>{
+			Opcode::I32_LOAD_WIDE, Opcode::I32_STORE_UNCHECKED, Opcode::I32_LOAD, Opcode::I32_LOAD,
+			Opcode::I32_LOAD}));
+
+	// A store is never widened.
+	body.clear();
+	emit_access(body, Opcode::I32_STORE, 0, 1, 0);
+	emit_access(body, Opcode::I32_STORE, 0, 1, 4);
+	body.push_back(Byte(Opcode::RETURN));
+	EXPECT_EQ(eliminate_bounds_checks(absl::MakeSpan(body)), 0);
+}
+
+TEST_F(TestBoundsCheck, WidenedChecksTrap) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 1});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	FuncNode& sum = push_func(mod, 0, 4);
+	sum.push<I32LoadInsnNode>(1, 0, 0);
+	sum.push<I32LoadInsnNode>(2, 0, 4);
+	sum.push<I32LoadInsnNode>(3, 0, 8);
+	sum.push<I32AddInsnNode>(1, 1, 2);
+	sum.push<I32AddInsnNode>(1, 1, 3);
+	sum.push<X32ReturnInsnNode>(1);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	auto body = inst->shared_module()->func_table()[0].body_bytes();
+	EXPECT_EQ(Opcode(body[0]), Opcode::I32_LOAD_WIDE);
+
+	LinearMemory* memory  = inst->memory(0);
+	auto size             = std::int32_t(memory->size());
+	std::int32_t values[] = {1, 2, 3};
+	std::memcpy(memory->address() + size - 12, values, sizeof(values));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, size - 12), std::make_tuple(6));
+
+	// The first word is in bounds, but the run isn't, so the widened check traps.
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, size - 8), Trap);
+}
+
+TEST_F(TestBoundsCheck, UndecodableBodiesAreRejected) {
+	// An unchecked access hidden behind an unknown opcode, in dead code.
+	std::vector<Byte> body;
+	body.push_back(Byte(Opcode::RETURN));
+	body.insert(body.end(), {Byte(Opcode::MOVE_X32), 0, 1});
+	emit_access(body, Opcode::I32_LOAD_UNCHECKED, 1, 0, 0);
+	EXPECT_THROW(eliminate_bounds_checks(absl::MakeSpan(body)), DecodeError);
+
+	// A truncated instruction.
+	body.clear();
+	emit_access(body, Opcode::I32_LOAD_UNCHECKED, 1, 0, 0);
+	body.pop_back();
+	EXPECT_THROW(eliminate_bounds_checks(absl::MakeSpan(body)), DecodeError);
+
+	// A branch into the middle of an instruction.
+	body.clear();
+	body.insert(body.end(), {Byte(Opcode::GOTO), 1});
+	emit_access(body, Opcode::I32_LOAD, 1, 0, 0);
+	EXPECT_THROW(eliminate_bounds_checks(absl::MakeSpan(body)), DecodeError);
+
+	// A module with such a body is rejected.
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_bounds_check_module());
+	auto shift  = module->func_table()[1].body_bytes();
+	shift[0]    = Byte(Opcode::MOVE_X32);
+	EXPECT_THROW(eliminate_bounds_checks(*module), DecodeError);
+}
+
+TEST_F(TestBoundsCheck, Memory64) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 1, false, true});
+	mod.types.push_back(FuncType{{ValType::I64}, {ValType::I64}});
+	FuncNode& load = push_func(mod, 0, 2);
+	load.push<I64LoadInsnNode>(2, 0, 8);
+	load.push<I32LoadInsnNode>(2, 0, 12);
+	load.push<I64LoadInsnNode>(2, 0, 16);
+	load.push<X64ReturnInsnNode>(2);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	auto body = inst->shared_module()->func_table()[0].body_bytes();
+	EXPECT_EQ(
+		opcodes_at(body, {0, 15, 30}),
+		(std::vector<Opcode>{
+			Opcode::I64_LOAD_A64, Opcode::I32_LOAD_A64_UNCHECKED, Opcode::I64_LOAD_A64}));
+
+	auto size = std::int64_t(inst->memory(0)->size());
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst, 0, size - 24), std::make_tuple(0));
+	EXPECT_THROW(static_call<std::int64_t>(cx, inst, 0, size - 16), Trap);
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,197 @@
+#include <Ab/Config.hpp>
+#include <Ab/InstancePool.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstring>
+#include <string>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestBulkMemory : public BasicTest {};
+
+const std::string GREETING = "hello, world";
+
+/// A module with one memory, one passive data segment, holding GREETING, and four functions:
+///   0: copy(dst, src, len),
+///   1: fill(dst, val, len),
+///   2: init(dst, src, len), from segment 0,
+///   3: drop(), of segment 0.
+///
+absl::Span<Byte> make_bulk_module() {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 4});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32, ValType::I32}, {}});
+	mod.types.push_back(FuncType{{}, {}});
+	mod.data.emplace_back(GREETING.begin(), GREETING.end());
+
+	FuncNode& copy = push_func(mod, 0, 3);
+	copy.push<MemoryCopyInsnNode>(0, 1, 2);
+	copy.push<ReturnInsnNode>();
+
+	FuncNode& fill = push_func(mod, 0, 3);
+	fill.push<MemoryFillInsnNode>(0, 1, 2);
+	fill.push<ReturnInsnNode>();
+
+	FuncNode& init = push_func(mod, 0, 3);
+	init.push<MemoryInitInsnNode>(0, 1, 2, 0);
+	init.push<ReturnInsnNode>();
+
+	FuncNode& drop = push_func(mod, 1, 0);
+	drop.push<DataDropInsnNode>(0);
+	drop.push<ReturnInsnNode>();
+
+	return mod.write();
+}
+
+void call3(Context& cx, ModuleInst* inst, std::size_t index, std::uint32_t a, std::uint32_t b,
+		   std::uint32_t c) {
+	static_call<>(cx, inst, index, std::int32_t(a), std::int32_t(b), std::int32_t(c));
+}
+
+std::string read(LinearMemory& memory, std::size_t address, std::size_t n) {
+	return std::string(reinterpret_cast<const char*>(memory.address() + address), n);
+}
+
+void write(LinearMemory& memory, std::size_t address, const std::string& s) {
+	std::memcpy(memory.address() + address, s.data(), s.size());
+}
+
+TEST_F(TestBulkMemory, DecodeDataSection) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_bulk_module());
+
+	ASSERT_EQ(module->data_table().size(), 1);
+	auto segment = module->data_table()[0];
+	EXPECT_EQ(std::string(reinterpret_cast<const char*>(segment.data()), segment.size()), GREETING);
+}
+
+TEST_F(TestBulkMemory, Copy) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst     = instantiate(cx, make_bulk_module());
+	LinearMemory& memory = *inst->memory(0);
+
+	write(memory, 0, "abcdefghij");
+	call3(cx, inst, 0, 100, 0, 10);
+	EXPECT_EQ(read(memory, 100, 10), "abcdefghij");
+
+	// Overlapping, in both directions.
+	call3(cx, inst, 0, 2, 0, 8);
+	EXPECT_EQ(read(memory, 0, 10), "ababcdefgh");
+	call3(cx, inst, 0, 100, 102, 8);
+	EXPECT_EQ(read(memory, 100, 10), "cdefghijij");
+}
+
+TEST_F(TestBulkMemory, Fill) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst     = instantiate(cx, make_bulk_module());
+	LinearMemory& memory = *inst->memory(0);
+
+	// Only the low byte of the value is stored.
+	call3(cx, inst, 1, 8, 0x178, 300);
+	EXPECT_EQ(read(memory, 7, 302), std::string(1, '\0') + std::string(300, 'x') + '\0');
+}
+
+TEST_F(TestBulkMemory, OutOfBoundsTrapsWithoutWriting) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst     = instantiate(cx, make_bulk_module());
+	LinearMemory& memory = *inst->memory(0);
+	std::uint32_t size   = memory.size();
+
+	write(memory, 0, "abcd");
+	EXPECT_THROW(call3(cx, inst, 0, size - 2, 0, 4), Trap);
+	EXPECT_THROW(call3(cx, inst, 0, 0, size - 2, 4), Trap);
+	EXPECT_THROW(call3(cx, inst, 1, size - 2, 'z', 4), Trap);
+	EXPECT_THROW(call3(cx, inst, 1, 0xffffffff, 'z', 2), Trap);
+	EXPECT_EQ(read(memory, size - 2, 2), std::string(2, '\0'));
+
+	// An empty range at the end of memory is in bounds.
+	call3(cx, inst, 0, size, 0, 0);
+	call3(cx, inst, 1, size, 'z', 0);
+}
+
+TEST_F(TestBulkMemory, InitAndDrop) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst     = instantiate(cx, make_bulk_module());
+	LinearMemory& memory = *inst->memory(0);
+
+	call3(cx, inst, 2, 16, 7, 5);
+	EXPECT_EQ(read(memory, 16, 5), "world");
+
+	// Reading past the end of the segment traps.
+	EXPECT_THROW(call3(cx, inst, 2, 16, 7, 6), Trap);
+
+	EXPECT_FALSE(inst->data_dropped(0));
+	static_call<>(cx, inst, 3);
+	EXPECT_TRUE(inst->data_dropped(0));
+
+	// A dropped segment is empty.
+	EXPECT_THROW(call3(cx, inst, 2, 16, 0, 1), Trap);
+	call3(cx, inst, 2, 16, 0, 0);
+
+	// Dropping is idempotent.
+	static_call<>(cx, inst, 3);
+}
+
+TEST_F(TestBulkMemory, MissingSegmentsAreRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode init;
+	init.memories.push_back(MemoryEntry{1, 1});
+	init.types.push_back(FuncType{{ValType::I32, ValType::I32, ValType::I32}, {}});
+	init.data.emplace_back(GREETING.begin(), GREETING.end());
+	FuncNode& init_func = push_func(init, 0, 3);
+	init_func.push<MemoryInitInsnNode>(0, 1, 2, 1);
+	init_func.push<ReturnInsnNode>();
+	EXPECT_THROW(compile(cx, init.write()), DecodeError);
+
+	ModuleNode drop;
+	drop.memories.push_back(MemoryEntry{1, 1});
+	drop.types.push_back(FuncType{{}, {}});
+	FuncNode& drop_func = push_func(drop, 0, 0);
+	drop_func.push<DataDropInsnNode>(0);
+	drop_func.push<ReturnInsnNode>();
+	EXPECT_THROW(compile(cx, drop.write()), DecodeError);
+}
+
+TEST_F(TestBulkMemory, DropIsPerInstance) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module   = compile(cx, make_bulk_module());
+	ModuleInst* a = instantiate(cx, module);
+	ModuleInst* b = instantiate(cx, module);
+
+	static_call<>(cx, a, 3);
+	EXPECT_TRUE(a->data_dropped(0));
+	EXPECT_FALSE(b->data_dropped(0));
+	call3(cx, b, 2, 0, 0, 5);
+	EXPECT_EQ(read(*b->memory(0), 0, 5), "hello");
+}
+
+TEST_F(TestBulkMemory, PoolResetRestoresSegments) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_bulk_module());
+	InstancePool pool(*prototype);
+
+	{
+		auto lease = pool.acquire();
+		static_call<>(cx, lease->inst(), 3);
+		EXPECT_TRUE(lease->inst()->data_dropped(0));
+	}
+
+	auto lease = pool.acquire();
+	EXPECT_FALSE(lease->inst()->data_dropped(0));
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,136 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+namespace Ab::Test {
+
+class TestDataSegments : public BasicTest {};
+
+/// The offset of the large segment, which doesn't start on a page.
+///
+const std::uint64_t LARGE_OFFSET = DATA_ALIGNMENT + 12;
+
+std::vector<Byte> make_large_segment() {
+	std::vector<Byte> bytes(2 * DATA_ALIGNMENT + 100);
+	for (std::size_t i = 0; i < bytes.size(); ++i) {
+		bytes[i] = Byte(i % 251);
+	}
+	return bytes;
+}
+
+/// A module with one memory of 4 * DATA_ALIGNMENT bytes, and three data segments:
+///   0: passive, "hello",
+///   1: active, "hi", at offset 8,
+///   2: active, a large segment, at LARGE_OFFSET.
+///
+absl::Span<Byte> make_data_module() {
+	std::uint64_t page_count = 4 * DATA_ALIGNMENT / LinearMemory::page_size();
+
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{page_count, page_count});
+	mod.data.push_back({'h', 'e', 'l', 'l', 'o'});
+	mod.active_data.push_back(ActiveDataNode{0, 8, {'h', 'i'}});
+	mod.active_data.push_back(ActiveDataNode{0, LARGE_OFFSET, make_large_segment()});
+	return mod.write();
+}
+
+/// Write a module to a new temporary file, and return the file's name.
+///
+std::string write_module_file(absl::Span<Byte> bytes) {
+	char name[] = "/tmp/ab-core-test-data-XXXXXX";
+	int fd      = mkstemp(name);
+	EXPECT_GE(fd, 0);
+	EXPECT_EQ(::write(fd, bytes.data(), bytes.size()), ssize_t(bytes.size()));
+	close(fd);
+	std::free(bytes.data());
+	return name;
+}
+
+void expect_initialized(const LinearMemory& memory) {
+	auto large = make_large_segment();
+	EXPECT_EQ(std::memcmp(memory.address() + 8, "hi", 2), 0);
+	EXPECT_EQ(std::memcmp(memory.address() + LARGE_OFFSET, large.data(), large.size()), 0);
+	EXPECT_EQ(memory.address()[LARGE_OFFSET - 1], Byte(0));
+	EXPECT_EQ(memory.address()[LARGE_OFFSET + large.size()], Byte(0));
+}
+
+TEST_F(TestDataSegments, DecodeActiveSegments) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_data_module());
+
+	ASSERT_EQ(module->data_table().size(), 3);
+	ASSERT_EQ(module->active_data_table().size(), 2);
+	EXPECT_EQ(module->active_data_table()[0].segment, 1);
+	EXPECT_EQ(module->active_data_table()[1].segment, 2);
+	EXPECT_EQ(module->active_data_table()[1].offset, LARGE_OFFSET);
+
+	// The large segment's bytes line up with it's memory offset.
+	auto segment         = module->data_table()[2];
+	std::size_t position = segment.data() - module->bytes().data();
+	EXPECT_EQ(position % DATA_ALIGNMENT, LARGE_OFFSET % DATA_ALIGNMENT);
+}
+
+TEST_F(TestDataSegments, InvalidSegments) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	auto make = [](std::uint32_t memory, std::uint64_t offset) {
+		ModuleNode mod;
+		mod.memories.push_back(MemoryEntry{1, 1});
+		mod.active_data.push_back(ActiveDataNode{memory, offset, {1, 2, 3, 4}});
+		return mod.write();
+	};
+
+	std::uint64_t size = LinearMemory::page_size();
+	EXPECT_NO_THROW(compile(cx, make(0, size - 4)));
+	EXPECT_THROW(compile(cx, make(0, size - 3)), std::runtime_error);
+	EXPECT_THROW(compile(cx, make(0, ~std::uint64_t(0))), std::runtime_error);
+	EXPECT_THROW(compile(cx, make(1, 0)), std::runtime_error);
+}
+
+TEST_F(TestDataSegments, InstantiationCopiesAndDrops) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_data_module());
+
+	expect_initialized(*inst->memory(0));
+	EXPECT_FALSE(inst->data_dropped(0));
+	EXPECT_TRUE(inst->data_dropped(1));
+	EXPECT_TRUE(inst->data_dropped(2));
+}
+
+TEST_F(TestDataSegments, MapFromModuleFile) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	std::string filename = write_module_file(make_data_module());
+	auto module          = compile(cx, filename);
+	unlink(filename.c_str());
+	ASSERT_GE(module->storage().fd(), 0);
+
+	ModuleInst* a = instantiate(cx, module);
+	ModuleInst* b = instantiate(cx, module);
+	expect_initialized(*a->memory(0));
+	expect_initialized(*b->memory(0));
+
+	// Writes are private to the instance, and never reach the module.
+	a->memory(0)->address()[DATA_ALIGNMENT * 2] = Byte(0xff);
+	expect_initialized(*b->memory(0));
+	auto large = make_large_segment();
+	EXPECT_EQ(std::memcmp(module->data_table()[2].data(), large.data(), large.size()), 0);
+
+	// Copies of an instance start with it's memory.
+	ModuleInst copy(*b);
+	expect_initialized(*copy.memory(0));
+}
+
+}  // namespace Ab::Test
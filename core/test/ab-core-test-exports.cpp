@@ -0,0 +1,93 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestExports : public BasicTest {};
+
+/// A module with `count` functions, (i32 i32) -> i32, each exported as "f<n>".
+/// Every function adds it's arguments.
+///
+absl::Span<Byte> make_exports_module(std::size_t count) {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	for (std::size_t i = 0; i < count; ++i) {
+		FuncNode& func = push_func(mod, 0, 3);
+		func.push<I32AddInsnNode>(2, 0, 1);
+		func.push<X32ReturnInsnNode>(2);
+		mod.exports.push_back({fmt::format("f{}", i), i});
+	}
+	return mod.write();
+}
+
+TEST_F(TestExports, FindFunction) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_exports_module(100));
+
+	for (std::size_t i = 0; i < 100; ++i) {
+		EXPECT_EQ(inst->find_function(fmt::format("f{}", i)), inst->func_inst(i));
+	}
+	EXPECT_EQ(inst->find_function("f100"), nullptr);
+	EXPECT_EQ(inst->find_function(""), nullptr);
+}
+
+TEST_F(TestExports, EmptyExportSection) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_exports_module(0));
+
+	EXPECT_EQ(inst->find_function("main"), nullptr);
+	EXPECT_FALSE(inst->resolve_func("main"));
+}
+
+TEST_F(TestExports, CallThroughHandle) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_exports_module(4));
+
+	FuncHandle handle = module->resolve_func("f3");
+	ASSERT_TRUE(handle);
+	EXPECT_EQ(handle.index(), 3);
+
+	// A handle is valid in every instance of it's module.
+	ModuleInst* a = instantiate(cx, module);
+	ModuleInst* b = instantiate(cx, module);
+	EXPECT_EQ(static_call<std::int32_t>(cx, a, handle, std::int32_t(1), std::int32_t(2)),
+			  std::make_tuple(3));
+	EXPECT_EQ(static_call<std::int32_t>(cx, b, handle, std::int32_t(3), std::int32_t(4)),
+			  std::make_tuple(7));
+}
+
+TEST_F(TestExports, DuplicateNameIsRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{}, {}});
+	FuncNode& func = push_func(mod, 0, 0);
+	func.push<ReturnInsnNode>();
+	mod.exports.push_back({"main", 0});
+	mod.exports.push_back({"main", 0});
+
+	EXPECT_THROW(compile(cx, mod.write()), std::runtime_error);
+}
+
+TEST_F(TestExports, UndefinedFunctionIsRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.exports.push_back({"main", 0});
+
+	EXPECT_THROW(compile(cx, mod.write()), std::runtime_error);
+}
+
+}  // namespace Ab::Test
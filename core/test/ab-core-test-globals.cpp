@@ -0,0 +1,169 @@
+#include <Ab/Config.hpp>
+#include <Ab/InstancePool.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstring>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestGlobals : public BasicTest {};
+
+std::uint64_t f64_bits(double x) {
+	std::uint64_t bits;
+	std::memcpy(&bits, &x, sizeof(bits));
+	return bits;
+}
+
+/// A module with three globals:
+///   0: a mutable i32 counter, starting at 10,
+///   1: an immutable i64, 2^40,
+///   2: a mutable f64, starting at 1.5.
+/// And three functions:
+///   0: (i32) -> i32, adds it's argument to the counter, and returns the new count,
+///   1: () -> i64, returns global 1,
+///   2: (f64) -> f64, stores it's argument in global 2, and returns the old value.
+///
+absl::Span<Byte> make_globals_module() {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{}, {ValType::I64}});
+	mod.types.push_back(FuncType{{ValType::F64}, {ValType::F64}});
+
+	mod.globals.push_back({ValType::I32, true, 10});
+	mod.globals.push_back({ValType::I64, false, std::uint64_t(1) << 40});
+	mod.globals.push_back({ValType::F64, true, f64_bits(1.5)});
+
+	FuncNode& bump = push_func(mod, 0, 2);
+	bump.push<GetGlobalX32InsnNode>(1, 0);
+	bump.push<I32AddInsnNode>(1, 1, 0);
+	bump.push<SetGlobalX32InsnNode>(1, 0);
+	bump.push<X32ReturnInsnNode>(1);
+
+	FuncNode& wide = push_func(mod, 1, 2);
+	wide.push<GetGlobalX64InsnNode>(0, 1);
+	wide.push<X64ReturnInsnNode>(0);
+
+	FuncNode& swap = push_func(mod, 2, 4);
+	swap.push<GetGlobalX64InsnNode>(2, 2);
+	swap.push<SetGlobalX64InsnNode>(0, 2);
+	swap.push<X64ReturnInsnNode>(2);
+
+	return mod.write();
+}
+
+TEST_F(TestGlobals, Decode) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_globals_module());
+
+	const auto& globals = module->global_table();
+	ASSERT_EQ(globals.size(), 3);
+	EXPECT_EQ(globals[0].type, ValType::I32);
+	EXPECT_TRUE(globals[0].is_mutable);
+	EXPECT_EQ(globals[0].init, 10);
+	EXPECT_EQ(globals[1].type, ValType::I64);
+	EXPECT_FALSE(globals[1].is_mutable);
+	EXPECT_EQ(globals[1].init, std::uint64_t(1) << 40);
+	EXPECT_EQ(globals[2].init, f64_bits(1.5));
+}
+
+TEST_F(TestGlobals, GetAndSet) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_globals_module());
+
+	ASSERT_EQ(inst->global_count(), 3);
+	EXPECT_EQ(inst->global<std::int32_t>(0), 10);
+
+	// Globals persist across calls.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(5)), std::make_tuple(15));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(1)), std::make_tuple(16));
+	EXPECT_EQ(inst->global<std::int32_t>(0), 16);
+
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst, 1), std::make_tuple(std::int64_t(1) << 40));
+
+	EXPECT_EQ(static_call<double>(cx, inst, 2, 2.5), std::make_tuple(1.5));
+	EXPECT_EQ(static_call<double>(cx, inst, 2, 3.0), std::make_tuple(2.5));
+	EXPECT_EQ(inst->global<double>(2), 3.0);
+
+	// Writes from the host are seen by code.
+	inst->global<std::int32_t>(0, -4);
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(1)), std::make_tuple(-3));
+}
+
+TEST_F(TestGlobals, InvalidAccessesAreRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	// An immutable i32, and a mutable i64, each accessed by a single instruction.
+	auto compile_access = [&](auto insn) {
+		ModuleNode mod;
+		mod.types.push_back(FuncType{{}, {}});
+		mod.globals.push_back({ValType::I32, false, 1});
+		mod.globals.push_back({ValType::I64, true, 2});
+		FuncNode& func = push_func(mod, 0, 2);
+		func.push<decltype(insn)>(insn);
+		func.push<ReturnInsnNode>();
+		return compile(cx, mod.write());
+	};
+
+	EXPECT_NO_THROW(compile_access(GetGlobalX32InsnNode(0, 0)));
+	EXPECT_NO_THROW(compile_access(SetGlobalX64InsnNode(0, 1)));
+
+	EXPECT_THROW(compile_access(GetGlobalX32InsnNode(0, 2)), DecodeError);
+	EXPECT_THROW(compile_access(SetGlobalX64InsnNode(0, 0xffffffff)), DecodeError);
+	EXPECT_THROW(compile_access(SetGlobalX32InsnNode(0, 0)), DecodeError);
+	EXPECT_THROW(compile_access(GetGlobalX64InsnNode(0, 0)), DecodeError);
+	EXPECT_THROW(compile_access(GetGlobalX32InsnNode(0, 1)), DecodeError);
+}
+
+TEST_F(TestGlobals, InstancesAreIndependent) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_globals_module());
+	ModuleInst* a = instantiate(cx, module);
+	ModuleInst* b = instantiate(cx, module);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, a, 0, std::int32_t(1)), std::make_tuple(11));
+	EXPECT_EQ(static_call<std::int32_t>(cx, b, 0, std::int32_t(2)), std::make_tuple(12));
+	EXPECT_EQ(a->global<std::int32_t>(0), 11);
+	EXPECT_EQ(b->global<std::int32_t>(0), 12);
+}
+
+TEST_F(TestGlobals, CopyStartsWithPrototypeValues) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_globals_module());
+	static_call<std::int32_t>(cx, prototype, 0, std::int32_t(5));
+
+	ModuleInst copy(*prototype);
+	EXPECT_EQ(copy.global<std::int32_t>(0), 15);
+	EXPECT_EQ(static_call<std::int32_t>(cx, &copy, 0, std::int32_t(1)), std::make_tuple(16));
+	EXPECT_EQ(prototype->global<std::int32_t>(0), 15);
+}
+
+TEST_F(TestGlobals, PoolResetRestoresGlobals) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_globals_module());
+	InstancePool pool(*prototype);
+
+	PooledInstance* first = nullptr;
+	{
+		auto lease = pool.acquire();
+		first      = lease.get();
+		EXPECT_EQ(
+			static_call<std::int32_t>(cx, lease->inst(), 0, std::int32_t(7)), std::make_tuple(17));
+	}
+
+	auto lease = pool.acquire();
+	EXPECT_EQ(lease.get(), first);
+	EXPECT_EQ(lease->inst()->global<std::int32_t>(0), 10);
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,154 @@
+#include <Ab/Config.hpp>
+#include <Ab/HostFunc.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <algorithm>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestHostFunc : public BasicTest {};
+
+std::int32_t host_sub(std::int32_t x, std::int32_t y) { return x - y; }
+
+std::int64_t host_widen(std::int32_t x, std::int64_t y) { return x + y; }
+
+double host_half(double x) { return x / 2; }
+
+std::int32_t host_count = 0;
+
+void host_tick() { ++host_count; }
+
+std::int32_t host_trap(ExecState* state, std::int32_t x) {
+	state->st_b.flags.trap = true;
+	return x;
+}
+
+/// A module importing `env.<name>` with the given type, with one function of the same type,
+/// which forwards it's arguments to the import with `call_primitive`, or `call`.
+///
+absl::Span<Byte> make_forwarder(const char* name, const FuncType& type, bool primitive) {
+	ModuleNode mod;
+	mod.types.push_back(type);
+	mod.imports.push_back({"env", name, ExternalKind::FUNC, 0});
+
+	FuncNode& forward = push_func(mod, 0, std::max(type.arg_nregs(), type.ret_nregs()));
+	if (primitive) {
+		forward.push<CallPrimitiveInsnNode>(0, 0);
+	} else {
+		forward.push<CallInsnNode>(0, 0);
+	}
+	switch (type.ret_nregs()) {
+	case 0:
+		forward.push<ReturnInsnNode>();
+		break;
+	case 1:
+		forward.push<X32ReturnInsnNode>(0);
+		break;
+	default:
+		forward.push<X64ReturnInsnNode>(0);
+		break;
+	}
+	return mod.write();
+}
+
+TEST_F(TestHostFunc, SignatureIsDerivedFromFunction) {
+	auto sub = make_host_func<&host_sub>();
+	EXPECT_EQ(sub->type(), (FuncType{{ValType::I32, ValType::I32}, {ValType::I32}}));
+
+	auto tick = make_host_func<&host_tick>();
+	EXPECT_EQ(tick->type(), (FuncType{{}, {}}));
+
+	// The execution state is not a parameter of the VM function.
+	auto trap = make_host_func<&host_trap>();
+	EXPECT_EQ(trap->type(), (FuncType{{ValType::I32}, {ValType::I32}}));
+}
+
+TEST_F(TestHostFunc, StaticCall) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	FuncInst* sub = define_host<&host_sub>(vm, "env", "sub");
+	EXPECT_EQ(static_call<std::int32_t>(cx, sub, std::int32_t(5), std::int32_t(7)),
+			  std::make_tuple(-2));
+}
+
+TEST_F(TestHostFunc, CallPrimitive) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	auto sub_type   = FuncType{{ValType::I32, ValType::I32}, {ValType::I32}};
+	auto widen_type = FuncType{{ValType::I32, ValType::I64}, {ValType::I64}};
+	auto half_type  = FuncType{{ValType::F64}, {ValType::F64}};
+
+	define_host<&host_sub>(vm, "env", "sub");
+	define_host<&host_widen>(vm, "env", "widen");
+	define_host<&host_half>(vm, "env", "half");
+	define_host<&host_tick>(vm, "env", "tick");
+
+	for (bool primitive : {true, false}) {
+		ModuleInst* sub   = instantiate(cx, make_forwarder("sub", sub_type, primitive));
+		ModuleInst* widen = instantiate(cx, make_forwarder("widen", widen_type, primitive));
+		ModuleInst* half  = instantiate(cx, make_forwarder("half", half_type, primitive));
+		ModuleInst* tick  = instantiate(cx, make_forwarder("tick", FuncType{{}, {}}, primitive));
+
+		EXPECT_EQ(static_call<std::int32_t>(cx, sub, 0, std::int32_t(9), std::int32_t(4)),
+				  std::make_tuple(5));
+		EXPECT_EQ(static_call<std::int64_t>(cx, widen, 0, std::int32_t(-1), std::int64_t(1) << 40),
+				  std::make_tuple((std::int64_t(1) << 40) - 1));
+		EXPECT_EQ(static_call<double>(cx, half, 0, 5.0), std::make_tuple(2.5));
+
+		host_count = 0;
+		static_call<>(cx, tick, 0);
+		EXPECT_EQ(host_count, 1);
+	}
+}
+
+TEST_F(TestHostFunc, CallPrimitiveOfModuleFunctionTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{}, {}});
+	FuncNode& callee = push_func(mod, 0, 0);
+	callee.push<ReturnInsnNode>();
+	FuncNode& caller = push_func(mod, 0, 0);
+	caller.push<CallPrimitiveInsnNode>(0, 0);
+	caller.push<ReturnInsnNode>();
+
+	ModuleInst* inst = instantiate(cx, mod.write());
+	EXPECT_THROW(static_call<>(cx, inst, 1), Trap);
+}
+
+TEST_F(TestHostFunc, CallPrimitiveOfMissingFunctionIsRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{}, {}});
+	FuncNode& caller = push_func(mod, 0, 0);
+	caller.push<CallPrimitiveInsnNode>(1, 0);
+	caller.push<ReturnInsnNode>();
+
+	EXPECT_THROW(compile(cx, mod.write()), DecodeError);
+}
+
+TEST_F(TestHostFunc, HostTrap) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	define_host<&host_trap>(vm, "env", "trap");
+	auto type = FuncType{{ValType::I32}, {ValType::I32}};
+
+	ModuleInst* primitive = instantiate(cx, make_forwarder("trap", type, true));
+	EXPECT_THROW(static_call<std::int32_t>(cx, primitive, 0, std::int32_t(1)), Trap);
+
+	ModuleInst* call = instantiate(cx, make_forwarder("trap", type, false));
+	EXPECT_THROW(static_call<std::int32_t>(cx, call, 0, std::int32_t(1)), Trap);
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,103 @@
+#include <Ab/Config.hpp>
+#include <Ab/InstancePool.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestInstancePool : public BasicTest {};
+
+/// A module with one memory and a single function, (addr i32, val i32) -> i32, which atomically
+/// adds val to the memory at addr, and returns the old value.
+///
+absl::Span<Byte> make_counter() {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 4});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	FuncNode& func = push_func(mod, 0, 3);
+	func.push<I32AtomicRmwAddInsnNode>(2, 0, 1, 0);
+	func.push<X32ReturnInsnNode>(2);
+	return mod.write();
+}
+
+TEST_F(TestInstancePool, SnapshotIsCopyOnWrite) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_counter());
+
+	LinearMemory& memory = *prototype->memory(0);
+
+	memory_at<std::int32_t>(memory, 0) = 100;
+
+	InstancePool pool(*prototype);
+
+	// Later writes to the prototype's memory are not captured.
+	memory_at<std::int32_t>(memory, 0) = 7;
+
+	auto a = pool.acquire();
+	auto b = pool.acquire();
+	EXPECT_EQ(memory_at<std::int32_t>(a->memory(), 0), 100);
+	EXPECT_EQ(memory_at<std::int32_t>(b->memory(), 0), 100);
+
+	memory_at<std::int32_t>(a->memory(), 0) = 1;
+	EXPECT_EQ(memory_at<std::int32_t>(b->memory(), 0), 100);
+	EXPECT_EQ(pool.lease_count(), 2);
+}
+
+TEST_F(TestInstancePool, ReleaseResetsMemory) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_counter());
+
+	memory_at<std::int32_t>(*prototype->memory(0), 4) = 40;
+	InstancePool pool(*prototype);
+
+	PooledInstance* first = nullptr;
+	{
+		auto lease = pool.acquire();
+		first      = lease.get();
+		EXPECT_EQ(static_call<std::int32_t>(cx, lease->inst(), 0, std::int32_t(4), std::int32_t(2)),
+				  std::make_tuple(40));
+		EXPECT_EQ(memory_at<std::int32_t>(lease->memory(), 4), 42);
+		memory_at<std::int32_t>(lease->memory(), 8) = 9;
+		lease->memory().grow();
+	}
+
+	EXPECT_EQ(pool.idle_count(), 1);
+	EXPECT_EQ(pool.lease_count(), 0);
+
+	// The instance is reused, with it's memory back in the snapshot state.
+	auto lease = pool.acquire();
+	EXPECT_EQ(lease.get(), first);
+	EXPECT_EQ(memory_at<std::int32_t>(lease->memory(), 4), 40);
+	EXPECT_EQ(memory_at<std::int32_t>(lease->memory(), 8), 0);
+	EXPECT_EQ(lease->memory().page_count(), pool.snapshots()[0]->page_count());
+}
+
+TEST_F(TestInstancePool, Prewarm) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_counter());
+
+	InstancePool pool(*prototype, 2);
+	pool.prewarm(2);
+	EXPECT_EQ(pool.idle_count(), 2);
+
+	{
+		auto a = pool.acquire();
+		auto b = pool.acquire();
+		auto c = pool.acquire();
+		EXPECT_EQ(pool.idle_count(), 0);
+		EXPECT_EQ(a->inst()->shared_module(), prototype->shared_module());
+	}
+
+	// Idle instances beyond the pool's capacity are freed.
+	EXPECT_EQ(pool.idle_count(), 2);
+}
+
+}  // namespace Ab::Test
@@ -1,6 +1,11 @@
 #include <Ab/Config.hpp>
 #include <Ab/LinearMemory.hpp>
+#include <algorithm>
+#include <cstring>
 #include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
 
 namespace Ab::Test {
 
@@ -31,4 +36,231 @@ TEST(LinearMemoryTest, AssignToMemory) {
 	EXPECT_EQ(*ptr, 123);
 }
 
+/// Write to the first and last byte of every page, then check that a reset clears them.
+///
+void check_usable(LinearMemory& m) {
+	for (std::size_t offset = 0; offset < m.size(); offset += LinearMemory::page_size()) {
+		m.address()[offset]                                  = Byte(1);
+		m.address()[offset + LinearMemory::page_size() - 1] = Byte(2);
+	}
+	m.reset();
+	for (std::size_t offset = 0; offset < m.size(); offset += LinearMemory::page_size()) {
+		EXPECT_EQ(m.address()[offset], Byte(0));
+	}
+}
+
+TEST(LinearMemoryTest, TransparentHugePages) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 2 * Page::HUGE_SIZE / LinearMemory::page_size();
+	cfg.huge_pages     = HugePagePolicy::TRANSPARENT;
+
+	LinearMemory m(cfg);
+	EXPECT_NE(m.huge_pages(), HugePagePolicy::EXPLICIT);
+	if (m.huge_pages() == HugePagePolicy::TRANSPARENT) {
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(m.address()) % Page::HUGE_SIZE, 0);
+	}
+
+	m.grow(cfg.page_count_max - 1);
+	check_usable(m);
+}
+
+TEST(LinearMemoryTest, ExplicitHugePagesFallBack) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 3;
+	cfg.page_count_max = 2 * Page::HUGE_SIZE / LinearMemory::page_size() + 1;
+	cfg.huge_pages     = HugePagePolicy::EXPLICIT;
+
+	// Without a huge page pool, the memory falls back to transparent, or regular, pages.
+	LinearMemory m(cfg);
+	m.address()[m.size() - 1] = Byte(1);
+	m.grow(cfg.page_count_max - cfg.page_count_min);
+	EXPECT_EQ(m.size(), cfg.page_count_max * LinearMemory::page_size());
+	check_usable(m);
+	EXPECT_EQ(m.page_count(), cfg.page_count_min);
+}
+
+TEST(LinearMemoryTest, SnapshotDowngradesExplicitHugePages) {
+	LinearMemory source;
+	source.address()[0] = Byte(7);
+	auto snapshot       = MemorySnapshot::capture(source);
+
+	LinearMemoryConfig cfg;
+	cfg.huge_pages = HugePagePolicy::EXPLICIT;
+	LinearMemory m(cfg, snapshot);
+	EXPECT_NE(m.huge_pages(), HugePagePolicy::EXPLICIT);
+	EXPECT_EQ(m.address()[0], Byte(7));
+}
+
+TEST(LinearMemoryTest, NumaLocal) {
+	LinearMemoryConfig cfg;
+	cfg.numa = NumaPolicy::LOCAL;
+
+	LinearMemory m(cfg);
+	if (m.numa_node() == -1) {
+		GTEST_SKIP() << "NUMA placement is not supported";
+	}
+
+	m.address()[0] = Byte(1);
+	EXPECT_TRUE(m.bind_to_node(0));
+	EXPECT_EQ(m.numa_node(), 0);
+	EXPECT_EQ(m.address()[0], Byte(1));
+}
+
+/// Fill every active page with `value`.
+///
+void touch(LinearMemory& m, int value) { std::memset(m.address(), value, m.size()); }
+
+TEST(LinearMemoryTest, ShrinkReleasesPages) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 8;
+	cfg.page_count_max = 8;
+
+	LinearMemory m(cfg);
+	touch(m, 0xab);
+	EXPECT_EQ(m.committed_size(), 8 * LinearMemory::page_size());
+	EXPECT_EQ(m.resident_size(), 8 * LinearMemory::page_size());
+
+	m.shrink(6);
+	EXPECT_EQ(m.page_count(), 2);
+	EXPECT_EQ(m.committed_size(), 2 * LinearMemory::page_size());
+	EXPECT_EQ(m.resident_size(), 2 * LinearMemory::page_size());
+
+	// Regrown pages read as zero.
+	m.grow(6);
+	EXPECT_EQ(m.address()[LinearMemory::page_size() - 1], Byte(0xab));
+	EXPECT_EQ(m.address()[2 * LinearMemory::page_size()], Byte(0));
+	EXPECT_EQ(m.address()[m.size() - 1], Byte(0));
+}
+
+TEST(LinearMemoryTest, ShrinkLazily) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 8;
+	cfg.page_count_max = 8;
+
+	LinearMemory m(cfg);
+	touch(m, 0xab);
+	m.shrink(4, PageRelease::LAZY);
+	EXPECT_EQ(m.committed_size(), 4 * LinearMemory::page_size());
+
+	// Lazily released pages are cleared when they are reused, even if they were not reclaimed.
+	m.grow(2);
+	m.grow(2);
+	for (std::size_t i = 4; i < 8; ++i) {
+		EXPECT_EQ(m.address()[i * LinearMemory::page_size()], Byte(0));
+	}
+	EXPECT_EQ(m.address()[0], Byte(0xab));
+}
+
+TEST(LinearMemoryTest, ShrinkBounds) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 2;
+	cfg.page_count_max = 4;
+
+	LinearMemory m(cfg);
+	EXPECT_THROW(m.shrink(3), LinearMemoryError);
+	m.shrink(0);
+	m.shrink(2);
+	EXPECT_EQ(m.size(), 0);
+	EXPECT_EQ(m.resident_size(), 0);
+
+	LinearMemory copy(cfg, MemorySnapshot::capture(LinearMemory(cfg)));
+	EXPECT_THROW(copy.shrink(1), LinearMemoryError);
+}
+
+TEST(LinearMemoryTest, EpochCountsResizes) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 4;
+
+	LinearMemory m(cfg);
+	auto epoch = m.epoch();
+	EXPECT_EQ(m.grow(2), 1);
+	EXPECT_EQ(m.epoch(), epoch + 1);
+	m.shrink(1);
+	EXPECT_EQ(m.epoch(), epoch + 2);
+	m.reset();
+	EXPECT_EQ(m.epoch(), epoch + 3);
+	EXPECT_EQ(m.page_count(), 1);
+
+	// A failed grow leaves the epoch alone.
+	EXPECT_THROW(m.grow(4), LinearMemoryError);
+	EXPECT_EQ(m.epoch(), epoch + 3);
+}
+
+/// An anonymous file of `n` pages, where every byte of page i is i + 1.
+///
+int make_page_file(std::size_t n) {
+	int fd = memfd_create("ab-core-test-pages", MFD_CLOEXEC);
+	std::vector<Byte> page(LinearMemory::page_size());
+	for (std::size_t i = 0; i < n; ++i) {
+		std::fill(page.begin(), page.end(), Byte(i + 1));
+		EXPECT_EQ(::write(fd, page.data(), page.size()), ssize_t(page.size()));
+	}
+	return fd;
+}
+
+/// Read a whole file into memory.
+///
+std::vector<Byte> read_file(int fd, std::size_t size) {
+	std::vector<Byte> bytes(size);
+	EXPECT_EQ(pread(fd, bytes.data(), size, 0), ssize_t(size));
+	return bytes;
+}
+
+TEST(LinearMemoryTest, LoadMapsWholePages) {
+	std::size_t page = LinearMemory::page_size();
+	int fd           = make_page_file(4);
+	auto bytes       = read_file(fd, 4 * page);
+
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 8;
+	cfg.page_count_max = 8;
+	LinearMemory m(cfg);
+
+	// The range covers half of page 2, pages 3 and 4, and half of page 5. Only the whole pages are
+	// mapped.
+	std::size_t offset = 2 * page + page / 2;
+	EXPECT_EQ(m.load(offset, bytes.data() + page / 2, 3 * page, fd, page / 2), 2 * page);
+	EXPECT_EQ(m.address()[offset - 1], Byte(0));
+	EXPECT_EQ(m.address()[offset], Byte(1));
+	EXPECT_EQ(m.address()[3 * page], Byte(2));
+	EXPECT_EQ(m.address()[5 * page + page / 2 - 1], Byte(4));
+	EXPECT_EQ(m.address()[5 * page + page / 2], Byte(0));
+
+	// Writes are private to the memory.
+	m.address()[3 * page] = Byte(0xab);
+	EXPECT_EQ(read_file(fd, 4 * page)[page], Byte(2));
+
+	// Ranges that don't line up with the file's pages are copied.
+	EXPECT_EQ(m.load(page + 1, bytes.data(), 2 * page, fd, 0), 0);
+	EXPECT_EQ(m.address()[page + 1], Byte(1));
+
+	EXPECT_THROW(m.load(7 * page, bytes.data(), 2 * page, fd, 0), LinearMemoryError);
+	close(fd);
+}
+
+TEST(LinearMemoryTest, ReleasedFilePagesReadAsZero) {
+	std::size_t page = LinearMemory::page_size();
+	int fd           = make_page_file(4);
+	auto bytes       = read_file(fd, 4 * page);
+
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 4;
+	cfg.page_count_max = 4;
+	LinearMemory m(cfg);
+	EXPECT_EQ(m.load(0, bytes.data(), 4 * page, fd, 0), 4 * page);
+
+	m.shrink(2);
+	m.grow(2);
+	EXPECT_EQ(m.address()[page], Byte(2));
+	EXPECT_EQ(m.address()[2 * page], Byte(0));
+	EXPECT_EQ(m.address()[4 * page - 1], Byte(0));
+
+	m.reset();
+	EXPECT_EQ(m.address()[0], Byte(0));
+	EXPECT_EQ(m.address()[page], Byte(0));
+	close(fd);
+}
+
 }  // namespace Ab::Test
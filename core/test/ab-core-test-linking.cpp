@@ -0,0 +1,189 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Resolver.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstring>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestLinking : public BasicTest {};
+
+/// A module exporting `dbl`, (i32) -> i32, which doubles it's argument.
+///
+absl::Span<Byte> make_dbl_module() {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	FuncNode& dbl = push_func(mod, 0, 1);
+	dbl.push<I32AddInsnNode>(0, 0, 0);
+	dbl.push<X32ReturnInsnNode>(0);
+	mod.exports.push_back({"dbl", 0});
+	return mod.write();
+}
+
+/// A module importing `dbl` from `module`, with functions (i32) -> i32:
+///   1: call_import  calls the import once.
+///   2: call_local   calls function 1 twice.
+///
+absl::Span<Byte> make_importer_module(const std::string& module) {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.imports.push_back({module, "dbl", ExternalKind::FUNC, 0});
+
+	FuncNode& call_import = push_func(mod, 0, 1);
+	call_import.push<CallInsnNode>(0, 0);
+	call_import.push<X32ReturnInsnNode>(0);
+
+	FuncNode& call_local = push_func(mod, 0, 1);
+	call_local.push<CallInsnNode>(1, 0);
+	call_local.push<CallInsnNode>(1, 0);
+	call_local.push<X32ReturnInsnNode>(0);
+
+	return mod.write();
+}
+
+/// Host implementation of `dbl`.
+///
+Byte* host_dbl(ExecState*, Byte* regs) {
+	std::int32_t x;
+	std::memcpy(&x, regs, sizeof(x));
+	x += x;
+	std::memcpy(regs, &x, sizeof(x));
+	return regs;
+}
+
+TEST_F(TestLinking, LocalCall) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	FuncNode& add = push_func(mod, 0, 3);
+	add.push<I32AddInsnNode>(2, 0, 1);
+	add.push<X32ReturnInsnNode>(2);
+
+	// (x, y) -> add(2x, 2y) + x. The call's arguments and result are in registers 2 and 3.
+	FuncNode& caller = push_func(mod, 0, 4);
+	caller.push<I32AddInsnNode>(2, 0, 0);
+	caller.push<I32AddInsnNode>(3, 1, 1);
+	caller.push<CallInsnNode>(0, 2);
+	caller.push<I32AddInsnNode>(1, 2, 0);
+	caller.push<X32ReturnInsnNode>(1);
+
+	ModuleInst* inst = instantiate(cx, mod.write());
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(3), std::int32_t(4)),
+			  std::make_tuple(17));
+}
+
+TEST_F(TestLinking, ImportFromModule) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleInst* exporter = instantiate(cx, make_dbl_module());
+	vm.resolver().define_module("math", exporter);
+
+	ModuleInst* importer = instantiate(cx, make_importer_module("math"));
+	EXPECT_TRUE(importer->linked());
+	EXPECT_EQ(importer->func(0), exporter->find_function("dbl"));
+
+	// The import is bound directly into the function table.
+	EXPECT_EQ(importer->func_inst(0)->func_const(0), exporter->func_inst(0));
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, importer, 0, std::int32_t(21)), std::make_tuple(42));
+	EXPECT_EQ(static_call<std::int32_t>(cx, importer, 1, std::int32_t(5)), std::make_tuple(20));
+}
+
+TEST_F(TestLinking, ImportHostFunction) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	FuncType type{{ValType::I32}, {ValType::I32}};
+	Func func(&type, absl::Span<Byte>(), 0);
+	func.native(&host_dbl);
+	FuncInst dbl(&func);
+	vm.resolver().define("env", "dbl", &dbl);
+
+	ModuleInst* inst = instantiate(cx, make_importer_module("env"));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(1)), std::make_tuple(2));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(3)), std::make_tuple(12));
+}
+
+TEST_F(TestLinking, SharedConstPool) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	vm.resolver().define_module("math", instantiate(cx, make_dbl_module()));
+	ModuleInst* inst = instantiate(cx, make_importer_module("math"));
+
+	// Every function in an instance shares the instance's pool.
+	for (const FuncInst& func : inst->func_inst_table()) {
+		EXPECT_EQ(func.const_pool(), &inst->const_pool());
+	}
+	EXPECT_EQ(inst->const_pool().func_table.size(), 3);
+
+	// A copy has it's own pool, pointing at it's own functions.
+	ModuleInst copy(*inst);
+	EXPECT_EQ(copy.func_inst(0)->const_pool(), &copy.const_pool());
+	EXPECT_EQ(copy.func_inst(1)->func_const(1), copy.func_inst(0));
+	EXPECT_EQ(copy.func_inst(1)->func_const(0), inst->func(0));
+	EXPECT_EQ(static_call<std::int32_t>(cx, &copy, 1, std::int32_t(5)), std::make_tuple(20));
+}
+
+TEST_F(TestLinking, UnresolvedImport) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(instantiate(cx, make_importer_module("env")), LinkError);
+}
+
+TEST_F(TestLinking, MismatchedImportType) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	FuncType type{{ValType::I64}, {ValType::I32}};
+	Func func(&type, absl::Span<Byte>(), 0);
+	func.native(&host_dbl);
+	FuncInst dbl(&func);
+	vm.resolver().define("env", "dbl", &dbl);
+
+	EXPECT_THROW(instantiate(cx, make_importer_module("env")), LinkError);
+}
+
+TEST_F(TestLinking, MissingCallTargetsAreRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	for (std::uint32_t target : {2u, 0xffffffffu}) {
+		ModuleNode mod;
+		mod.types.push_back(FuncType{{}, {}});
+		mod.imports.push_back({"env", "tick", ExternalKind::FUNC, 0});
+		FuncNode& func = push_func(mod, 0, 0);
+		func.push<CallInsnNode>(target, 0);
+		func.push<ReturnInsnNode>();
+		EXPECT_THROW(compile(cx, mod.write()), DecodeError);
+	}
+}
+
+TEST_F(TestLinking, UnboundedRecursionTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	FuncNode& loop = push_func(mod, 0, 1);
+	loop.push<CallInsnNode>(0, 0);
+	loop.push<X32ReturnInsnNode>(0);
+
+	ModuleInst* inst = instantiate(cx, mod.write());
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, std::int32_t(0)), Trap);
+
+	// The context is usable after a trap.
+	ModuleInst* dbl = instantiate(cx, make_dbl_module());
+	EXPECT_EQ(static_call<std::int32_t>(cx, dbl, 0, std::int32_t(2)), std::make_tuple(4));
+}
+
+}  // namespace Ab::Test
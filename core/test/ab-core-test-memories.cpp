@@ -0,0 +1,340 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <cstring>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestMemories : public BasicTest {};
+
+/// A module with two memories, of 1-4 and 1-2 pages, and the functions:
+///   0: load0   (addr i32) -> i32, from memory 0,
+///   1: store0  (addr i32, val i32) -> (), to memory 0,
+///   2: load1   (addr i32) -> i32, from memory 1,
+///   3: store1  (addr i32, val i32) -> (), to memory 1,
+///   4: load64  (addr i32) -> i64, from memory 0, at offset 8,
+///   5: store64 (addr i32, val i64) -> (), to memory 0, at offset 8,
+///   6: load9   (addr i32) -> i32, from memory 9, which does not exist.
+///
+absl::Span<Byte> make_memories_module() {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 4});
+	mod.memories.push_back(MemoryEntry{1, 2});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {}});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I64}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I64}, {}});
+
+	for (std::uint32_t memory : {0, 1}) {
+		FuncNode& load = push_func(mod, 0, 1);
+		load.push<I32LoadInsnNode>(0, 0, 0, memory);
+		load.push<X32ReturnInsnNode>(0);
+
+		FuncNode& store = push_func(mod, 1, 0);
+		store.push<I32StoreInsnNode>(0, 1, 0, memory);
+		store.push<ReturnInsnNode>();
+	}
+
+	FuncNode& load64 = push_func(mod, 2, 3);
+	load64.push<I64LoadInsnNode>(2, 0, 8);
+	load64.push<X64ReturnInsnNode>(2);
+
+	FuncNode& store64 = push_func(mod, 3, 0);
+	store64.push<I64StoreInsnNode>(0, 1, 8);
+	store64.push<ReturnInsnNode>();
+
+	FuncNode& load9 = push_func(mod, 0, 1);
+	load9.push<I32LoadInsnNode>(0, 0, 0, 9);
+	load9.push<X32ReturnInsnNode>(0);
+
+	mod.exports.push_back({"load0", 0});
+	return mod.write();
+}
+
+/// 8 GiB, in LinearMemory pages. The page size is only known once the runtime is up.
+///
+std::uint64_t page_count_8g() { return (std::uint64_t(8) << 30) / LinearMemory::page_size(); }
+
+/// A module with one memory64 memory, of 1 page, growing to 8 GiB, and the functions:
+///   0: load    (addr i64) -> i32,
+///   1: store   (addr i64, val i32) -> (),
+///   2: load64  (addr i64) -> i64, at offset 8,
+///   3: store64 (addr i64, val i64) -> (), at offset 8.
+///
+absl::Span<Byte> make_memory64_module() {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, page_count_8g(), false, true});
+	mod.types.push_back(FuncType{{ValType::I64}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I64, ValType::I32}, {}});
+	mod.types.push_back(FuncType{{ValType::I64}, {ValType::I64}});
+	mod.types.push_back(FuncType{{ValType::I64, ValType::I64}, {}});
+
+	FuncNode& load = push_func(mod, 0, 0);
+	load.push<I32LoadInsnNode>(0, 0);
+	load.push<X32ReturnInsnNode>(0);
+
+	FuncNode& store = push_func(mod, 1, 0);
+	store.push<I32StoreInsnNode>(0, 2);
+	store.push<ReturnInsnNode>();
+
+	FuncNode& load64 = push_func(mod, 2, 0);
+	load64.push<I64LoadInsnNode>(0, 0, 8);
+	load64.push<X64ReturnInsnNode>(0);
+
+	FuncNode& store64 = push_func(mod, 3, 0);
+	store64.push<I64StoreInsnNode>(0, 2, 8);
+	store64.push<ReturnInsnNode>();
+
+	return mod.write();
+}
+
+template <typename T>
+T read(LinearMemory* memory, std::size_t address) {
+	T value;
+	std::memcpy(&value, memory->address() + address, sizeof(T));
+	return value;
+}
+
+template <typename T>
+void write(LinearMemory* memory, std::size_t address, T value) {
+	std::memcpy(memory->address() + address, &value, sizeof(T));
+}
+
+TEST_F(TestMemories, DecodeMemorySection) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{0, 0});
+	mod.memories.push_back(MemoryEntry{2, 300, true});
+	auto module = compile(cx, mod.write());
+
+	ASSERT_EQ(module->memory_table().size(), 2);
+	EXPECT_EQ(module->memory_table()[0].page_count_max, 0);
+	EXPECT_FALSE(module->memory_table()[0].shared);
+	EXPECT_EQ(module->memory_table()[1].page_count_min, 2);
+	EXPECT_EQ(module->memory_table()[1].page_count_max, 300);
+	EXPECT_TRUE(module->memory_table()[1].shared);
+
+	ModuleInst* inst = instantiate(cx, module);
+	ASSERT_EQ(inst->memory_count(), 2);
+	EXPECT_EQ(inst->memory(0)->size(), 0);
+	EXPECT_EQ(inst->memory(1)->page_count(), 2);
+	EXPECT_EQ(inst->memory(1)->max_size(), 300);
+	EXPECT_TRUE(inst->memory(1)->shared());
+}
+
+TEST_F(TestMemories, InvalidMemorySection) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{2, 1});
+	EXPECT_THROW(compile(cx, mod.write()), std::runtime_error);
+}
+
+TEST_F(TestMemories, WriterSpecializesMemoryZero) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_memories_module());
+
+	EXPECT_EQ(Opcode(module->func_table()[0].body()[0]), Opcode::I32_LOAD);
+	EXPECT_EQ(Opcode(module->func_table()[1].body()[0]), Opcode::I32_STORE);
+	EXPECT_EQ(Opcode(module->func_table()[2].body()[0]), Opcode::I32_LOAD_MEM);
+	EXPECT_EQ(Opcode(module->func_table()[3].body()[0]), Opcode::I32_STORE_MEM);
+	EXPECT_EQ(Opcode(module->func_table()[4].body()[0]), Opcode::I64_LOAD);
+	EXPECT_EQ(Opcode(module->func_table()[5].body()[0]), Opcode::I64_STORE);
+}
+
+TEST_F(TestMemories, LoadStore) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_memories_module());
+	LinearMemory* m0 = inst->memory(0);
+	LinearMemory* m1 = inst->memory(1);
+
+	// Plain accesses may be unaligned.
+	static_call<>(cx, inst, 1, std::int32_t(3), std::int32_t(0x01020304));
+	EXPECT_EQ(read<std::int32_t>(m0, 3), 0x01020304);
+	EXPECT_EQ(
+		static_call<std::int32_t>(cx, inst, 0, std::int32_t(3)), std::make_tuple(0x01020304));
+
+	// Memory 1 is distinct from memory 0.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2, std::int32_t(3)), std::make_tuple(0));
+	static_call<>(cx, inst, 3, std::int32_t(3), std::int32_t(7));
+	EXPECT_EQ(read<std::int32_t>(m1, 3), 7);
+	EXPECT_EQ(read<std::int32_t>(m0, 3), 0x01020304);
+
+	static_call<>(cx, inst, 5, std::int32_t(1), std::int64_t(0x0123456789abcdef));
+	EXPECT_EQ(read<std::int64_t>(m0, 9), 0x0123456789abcdef);
+	write<std::int64_t>(m0, 24, -2);
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst, 4, std::int32_t(16)), std::make_tuple(-2));
+}
+
+TEST_F(TestMemories, InstancesDoNotShareMemory) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module   = compile(cx, make_memories_module());
+	ModuleInst* a = instantiate(cx, module);
+	ModuleInst* b = instantiate(cx, module);
+
+	EXPECT_NE(a->memory(0), b->memory(0));
+	static_call<>(cx, a, 1, std::int32_t(0), std::int32_t(1));
+	static_call<>(cx, b, 1, std::int32_t(0), std::int32_t(2));
+	EXPECT_EQ(static_call<std::int32_t>(cx, a, 0, std::int32_t(0)), std::make_tuple(1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, b, 0, std::int32_t(0)), std::make_tuple(2));
+}
+
+TEST_F(TestMemories, CallsSwitchMemory) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* exporter = instantiate(cx, make_memories_module());
+	vm.resolver().define_module("memories", exporter);
+
+	// An importer of load0, with the function sum (a i32, b i32) -> i32, which returns the
+	// import's load of a, plus the load of b from it's own memory.
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 1});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.imports.push_back({"memories", "load0", ExternalKind::FUNC, 0});
+	FuncNode& sum = push_func(mod, 1, 0);
+	sum.push<CallInsnNode>(0, 0);
+	sum.push<I32LoadInsnNode>(1, 1);
+	sum.push<I32AddInsnNode>(0, 0, 1);
+	sum.push<X32ReturnInsnNode>(0);
+	ModuleInst* importer = instantiate(cx, mod.write());
+
+	write<std::int32_t>(exporter->memory(0), 0, 40);
+	write<std::int32_t>(importer->memory(0), 4, 2);
+
+	// The import reads it's own instance's memory, and the caller's memory is restored on return.
+	EXPECT_EQ(static_call<std::int32_t>(cx, importer, 0, std::int32_t(0), std::int32_t(4)),
+			  std::make_tuple(42));
+}
+
+TEST_F(TestMemories, OutOfBoundsTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_memories_module());
+	auto end         = std::int32_t(inst->memory(0)->size());
+
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, end - 3), Trap);
+	EXPECT_THROW(static_call<>(cx, inst, 1, end - 2, std::int32_t(1)), Trap);
+	EXPECT_THROW(static_call<std::int64_t>(cx, inst, 4, end - 15), Trap);
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, std::int32_t(-1)), Trap);
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 6, std::int32_t(0)), Trap);
+
+	// The last word is in bounds.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, end - 4), std::make_tuple(0));
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst, 4, end - 16), std::make_tuple(0));
+}
+
+TEST_F(TestMemories, NoMemoryTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	FuncNode& load = push_func(mod, 0, 0);
+	load.push<I32LoadInsnNode>(0, 0);
+	load.push<X32ReturnInsnNode>(0);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_EQ(inst->memory_count(), 0);
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, std::int32_t(0)), Trap);
+}
+
+TEST_F(TestMemories, DecodeMemory64) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_memory64_module());
+
+	ASSERT_EQ(module->memory_table().size(), 1);
+	EXPECT_TRUE(module->memory_table()[0].memory64);
+	EXPECT_EQ(module->memory_table()[0].page_count_max, page_count_8g());
+
+	// The address space is only reserved, so a large maximum is cheap.
+	ModuleInst* inst = instantiate(cx, module);
+	EXPECT_TRUE(inst->memory(0)->memory64());
+	EXPECT_EQ(inst->memory(0)->max_size(), page_count_8g());
+
+	EXPECT_EQ(Opcode(module->func_table()[0].body()[0]), Opcode::I32_LOAD_A64);
+	EXPECT_EQ(Opcode(module->func_table()[1].body()[0]), Opcode::I32_STORE_A64);
+	EXPECT_EQ(Opcode(module->func_table()[2].body()[0]), Opcode::I64_LOAD_A64);
+	EXPECT_EQ(Opcode(module->func_table()[3].body()[0]), Opcode::I64_STORE_A64);
+}
+
+TEST_F(TestMemories, Memory32IsLimitedTo4G) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, page_count_8g()});
+	EXPECT_THROW(instantiate(cx, mod.write()), LinearMemoryError);
+}
+
+TEST_F(TestMemories, Memory64IsLimited) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	// 2^52 + 1 pages would wrap to a single page reservation.
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, (std::uint64_t(1) << 52) + 1, false, true});
+	EXPECT_THROW(compile(cx, mod.write()), DecodeError);
+
+	LinearMemoryConfig cfg;
+	cfg.memory64       = true;
+	cfg.page_count_max = LinearMemoryConfig::max_page_count(true) + 1;
+	EXPECT_THROW(LinearMemory memory(cfg), LinearMemoryError);
+	cfg.page_count_max = (std::uint64_t(1) << 52) + 1;
+	EXPECT_THROW(LinearMemory memory(cfg), LinearMemoryError);
+}
+
+TEST_F(TestMemories, Memory64LoadStore) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_memory64_module());
+	LinearMemory* m0 = inst->memory(0);
+
+	static_call<>(cx, inst, 1, std::int64_t(3), std::int32_t(0x01020304));
+	EXPECT_EQ(read<std::int32_t>(m0, 3), 0x01020304);
+	EXPECT_EQ(
+		static_call<std::int32_t>(cx, inst, 0, std::int64_t(3)), std::make_tuple(0x01020304));
+
+	static_call<>(cx, inst, 3, std::int64_t(1), std::int64_t(0x0123456789abcdef));
+	EXPECT_EQ(read<std::int64_t>(m0, 9), 0x0123456789abcdef);
+	EXPECT_EQ(
+		static_call<std::int64_t>(cx, inst, 2, std::int64_t(1)),
+		std::make_tuple(0x0123456789abcdef));
+}
+
+TEST_F(TestMemories, Memory64OutOfBoundsTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_memory64_module());
+	auto end         = std::int64_t(inst->memory(0)->size());
+
+	// High addresses don't wrap around to the start of memory.
+	write<std::int32_t>(inst->memory(0), 8, 1);
+	EXPECT_THROW(
+		static_call<std::int32_t>(cx, inst, 0, (std::int64_t(1) << 32) + 8), Trap);
+
+	// Nor does the sum of the address and offset.
+	EXPECT_THROW(static_call<std::int64_t>(cx, inst, 2, std::int64_t(-4)), Trap);
+	EXPECT_THROW(static_call<>(cx, inst, 3, std::int64_t(-8), std::int64_t(1)), Trap);
+
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, end - 3), Trap);
+	EXPECT_THROW(static_call<std::int64_t>(cx, inst, 2, end - 15), Trap);
+
+	// The last word is in bounds.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, end - 4), std::make_tuple(0));
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst, 2, end - 16), std::make_tuple(0));
+}
+
+}  // namespace Ab::Test
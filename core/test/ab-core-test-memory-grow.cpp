@@ -0,0 +1,132 @@
+#include <Ab/Config.hpp>
+#include <Ab/HostFunc.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestMemoryGrow : public BasicTest {};
+
+void host_grow(ExecState* state) { state->st_b.memory->grow(); }
+
+/// A module with one memory of one to three pages, importing `env.grow`, and the functions:
+///   0: size () -> i32
+///   1: grow (delta i32) -> i32
+///   2: load (addr i32) -> i32
+///   3: grow_and_store (delta i32, addr i32) -> i32, grows the memory, then stores addr at addr and
+///      returns the result of the grow.
+///   4: host_grow_and_load (addr i32) -> i32, calls env.grow, then loads the word at addr.
+///
+absl::Span<Byte> make_grow_module() {
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 3});
+	mod.types.push_back(FuncType{{}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{}, {}});
+	mod.imports.push_back({"env", "grow", ExternalKind::FUNC, 3});
+
+	FuncNode& size = push_func(mod, 0, 1);
+	size.push<MemorySizeInsnNode>(0);
+	size.push<X32ReturnInsnNode>(0);
+
+	FuncNode& grow = push_func(mod, 1, 1);
+	grow.push<MemoryGrowInsnNode>(0, 0);
+	grow.push<X32ReturnInsnNode>(0);
+
+	FuncNode& load = push_func(mod, 1, 1);
+	load.push<I32LoadInsnNode>(0, 0);
+	load.push<X32ReturnInsnNode>(0);
+
+	FuncNode& grow_and_store = push_func(mod, 2, 2);
+	grow_and_store.push<MemoryGrowInsnNode>(0, 0);
+	grow_and_store.push<I32StoreInsnNode>(1, 1);
+	grow_and_store.push<X32ReturnInsnNode>(0);
+
+	FuncNode& host_grow_and_load = push_func(mod, 1, 2);
+	host_grow_and_load.push<CallInsnNode>(0, 1);
+	host_grow_and_load.push<I32LoadInsnNode>(0, 0);
+	host_grow_and_load.push<X32ReturnInsnNode>(0);
+
+	return mod.write();
+}
+
+TEST_F(TestMemoryGrow, GrowReturnsOldSize) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	define_host<&host_grow>(vm, "env", "grow");
+	ModuleInst* inst = instantiate(cx, make_grow_module());
+	auto page        = std::int32_t(LinearMemory::page_size());
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0), std::make_tuple(1));
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 2, page), Trap);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(1)), std::make_tuple(1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0), std::make_tuple(2));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2, page), std::make_tuple(0));
+
+	// Growing past the maximum fails, and leaves the memory as it was.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(2)), std::make_tuple(-1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(-1)), std::make_tuple(-1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 1, std::int32_t(0)), std::make_tuple(2));
+	EXPECT_EQ(inst->memory(0)->page_count(), 2);
+}
+
+TEST_F(TestMemoryGrow, GrowUpdatesTheCache) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	define_host<&host_grow>(vm, "env", "grow");
+	ModuleInst* inst = instantiate(cx, make_grow_module());
+	auto page        = std::int32_t(LinearMemory::page_size());
+
+	// The store lands in the page grown by the same call.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 3, std::int32_t(1), page + 4),
+			  std::make_tuple(1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2, page + 4), std::make_tuple(page + 4));
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 3, std::int32_t(0), 2 * page), Trap);
+}
+
+TEST_F(TestMemoryGrow, HostResizesAreSeen) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	define_host<&host_grow>(vm, "env", "grow");
+	ModuleInst* inst     = instantiate(cx, make_grow_module());
+	LinearMemory* memory = inst->memory(0);
+	auto page            = std::int32_t(LinearMemory::page_size());
+
+	// A grow by a host function, in the middle of a call.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 4, page), std::make_tuple(0));
+	EXPECT_EQ(memory->page_count(), 2);
+
+	// A shrink by the host, between calls.
+	memory->shrink(1);
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0), std::make_tuple(1));
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 2, page), Trap);
+	memory->grow(2);
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 2, 2 * page), std::make_tuple(0));
+}
+
+TEST_F(TestMemoryGrow, NoMemoryTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	FuncNode& size = push_func(mod, 0, 0);
+	size.push<MemorySizeInsnNode>(0);
+	size.push<X32ReturnInsnNode>(0);
+	FuncNode& grow = push_func(mod, 0, 0);
+	grow.push<MemoryGrowInsnNode>(0, 0);
+	grow.push<X32ReturnInsnNode>(0);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 0, std::int32_t(0)), Trap);
+	EXPECT_THROW(static_call<std::int32_t>(cx, inst, 1, std::int32_t(1)), Trap);
+}
+
+}  // namespace Ab::Test
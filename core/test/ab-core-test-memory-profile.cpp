@@ -0,0 +1,107 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/MemoryProfile.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Page.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestMemoryProfile : public BasicTest {};
+
+TEST_F(TestMemoryProfile, HeatMapCountsPages) {
+	std::size_t page = LinearMemory::page_size();
+	HeatMap map;
+	map.add(0, MemoryAccess::LOAD);
+	map.add(3 * page + 5, MemoryAccess::STORE);
+	map.add(3 * page, MemoryAccess::LOAD);
+	map.add(3 * page + page - 1, MemoryAccess::LOAD);
+
+	EXPECT_EQ(map.page_count(), 4);
+	EXPECT_EQ(map.loads(3), 2);
+	EXPECT_EQ(map.stores(3), 1);
+	EXPECT_EQ(map.count(0), 1);
+	EXPECT_EQ(map.count(1), 0);
+	EXPECT_EQ(map.count(100), 0);
+	EXPECT_EQ(map.total(), 4);
+	EXPECT_EQ(map.hottest(8), (std::vector<std::size_t>{3, 0}));
+	EXPECT_EQ(map.hottest(1), (std::vector<std::size_t>{3}));
+	EXPECT_EQ(map.regions(2 * page), (std::vector<std::uint64_t>{1, 3}));
+}
+
+TEST_F(TestMemoryProfile, SamplesEveryPeriod) {
+	LinearMemory memory;
+	MemoryProfile profile(4, 8);
+
+	for (std::uint64_t i = 0; i < 12; ++i) {
+		profile.record(&memory, i, 4, MemoryAccess::LOAD);
+	}
+	ASSERT_EQ(profile.samples().size(), 3);
+	EXPECT_EQ(profile.samples()[0].address, 3);
+	EXPECT_EQ(profile.samples()[2].address, 11);
+	EXPECT_EQ(profile.sample_count(), 3);
+
+	// The heat map takes in the samples still in the ring.
+	const HeatMap* map = profile.heat_map(&memory);
+	ASSERT_NE(map, nullptr);
+	EXPECT_EQ(map->total(), 3);
+	EXPECT_TRUE(profile.samples().empty());
+	EXPECT_EQ(profile.heat_map(nullptr), nullptr);
+
+	profile.clear();
+	EXPECT_EQ(profile.sample_count(), 0);
+	EXPECT_EQ(profile.heat_map(&memory), nullptr);
+}
+
+TEST_F(TestMemoryProfile, FullRingIsFlushed) {
+	LinearMemory memory;
+	MemoryProfile profile(1, 4);
+
+	for (std::uint64_t i = 0; i < 10; ++i) {
+		profile.record(&memory, 0, 4, MemoryAccess::STORE);
+	}
+	EXPECT_EQ(profile.samples().size(), 2);
+	EXPECT_EQ(profile.sample_count(), 10);
+	EXPECT_EQ(profile.heat_map(&memory)->stores(0), 10);
+}
+
+#ifdef AB_MEMORY_PROFILE
+
+TEST_F(TestMemoryProfile, InterpreterSamplesAccesses) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	// fill(addr): store then load a word on each of 4 pages, starting at addr.
+	std::uint32_t page = LinearMemory::page_size();
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{8, 8});
+	mod.types.push_back(FuncType{{ValType::I32}, {}});
+	FuncNode& fill = push_func(mod, 0, 1);
+	for (std::uint32_t i = 0; i < 4; ++i) {
+		fill.push<I32StoreInsnNode>(0, 0, i * page);
+		fill.push<I32LoadInsnNode>(1, 0, i * page);
+	}
+	fill.push<ReturnInsnNode>();
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	cx.memory_profile().clear();
+	cx.memory_profile().period(1);
+	static_call<>(cx, inst, 0, std::int32_t(2 * page));
+
+	const HeatMap* map = cx.memory_profile().heat_map(inst->memory(0));
+	ASSERT_NE(map, nullptr);
+	EXPECT_EQ(map->total(), 8);
+	EXPECT_EQ(map->count(1), 0);
+	for (std::size_t i = 2; i < 6; ++i) {
+		EXPECT_EQ(map->loads(i), 1);
+		EXPECT_EQ(map->stores(i), 1);
+	}
+}
+
+#endif  // AB_MEMORY_PROFILE
+
+}  // namespace Ab::Test
@@ -0,0 +1,142 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Store.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestStore : public BasicTest {};
+
+/// Counts live instances of itself.
+///
+struct Counted {
+	explicit Counted(int value) : value(value) { ++count; }
+
+	~Counted() { --count; }
+
+	static inline int count = 0;
+
+	int value;
+};
+
+TEST_F(TestStore, CreateAndGet) {
+	Arena<Counted> arena;
+	auto a = arena.create(1);
+	auto b = arena.create(2);
+
+	EXPECT_NE(a, b);
+	EXPECT_EQ(arena.get(a)->value, 1);
+	EXPECT_EQ(arena.get(b)->value, 2);
+	EXPECT_EQ(arena.size(), 2);
+	EXPECT_EQ(arena.get(Handle<Counted>()), nullptr);
+}
+
+TEST_F(TestStore, StaleHandle) {
+	Arena<Counted> arena;
+	auto a = arena.create(1);
+	arena.destroy(a);
+	EXPECT_EQ(arena.get(a), nullptr);
+	EXPECT_EQ(Counted::count, 0);
+
+	// The slot is reused, but the old handle does not see the new object.
+	auto b = arena.create(2);
+	EXPECT_EQ(b.index(), a.index());
+	EXPECT_NE(b.generation(), a.generation());
+	EXPECT_EQ(arena.get(a), nullptr);
+	EXPECT_EQ(arena.get(b)->value, 2);
+}
+
+TEST_F(TestStore, ObjectsDoNotMove) {
+	Arena<Counted> arena;
+	std::vector<std::pair<Handle<Counted>, Counted*>> objects;
+	for (int i = 0; i < 1000; ++i) {
+		auto handle = arena.create(i);
+		objects.emplace_back(handle, arena.get(handle));
+	}
+	EXPECT_GE(arena.capacity(), 1000);
+	for (int i = 0; i < 1000; ++i) {
+		EXPECT_EQ(arena.get(objects[i].first), objects[i].second);
+		EXPECT_EQ(objects[i].second->value, i);
+	}
+}
+
+TEST_F(TestStore, Clear) {
+	Arena<Counted> arena;
+	std::vector<Handle<Counted>> handles;
+	for (int i = 0; i < 100; ++i) {
+		handles.push_back(arena.create(i));
+	}
+	EXPECT_EQ(Counted::count, 100);
+
+	std::size_t capacity = arena.capacity();
+	arena.clear();
+	EXPECT_EQ(Counted::count, 0);
+	EXPECT_EQ(arena.size(), 0);
+	EXPECT_EQ(arena.capacity(), capacity);
+	for (auto handle : handles) {
+		EXPECT_EQ(arena.get(handle), nullptr);
+	}
+}
+
+TEST_F(TestStore, VirtualMachineOwnsInstances) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{}, {}});
+	FuncNode& func = push_func(mod, 0, 0);
+	func.push<ReturnInsnNode>();
+	auto module = compile(cx, mod.write());
+
+	for (std::size_t i = 0; i < 100; ++i) {
+		static_call<>(cx, instantiate(cx, module), 0);
+	}
+	EXPECT_EQ(vm.modules()->size(), 100);
+
+	// Each instance holds the module, but there is no per-instance reference count.
+	EXPECT_EQ(module.use_count(), 101);
+}
+
+TEST_F(TestStore, DestroyInstance) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{}, {}});
+	FuncNode& func = push_func(mod, 0, 0);
+	func.push<ReturnInsnNode>();
+	auto module = compile(cx, mod.write());
+
+	auto kept       = vm.instantiate(module);
+	auto handle     = vm.instantiate(module);
+	ModuleInst* ptr = vm.instance(handle);
+	ASSERT_NE(ptr, nullptr);
+	static_call<>(cx, ptr, 0);
+	EXPECT_EQ(vm.modules()->size(), 2);
+
+	// The instance leaves the snapshot, and it's handle goes stale.
+	vm.destroy(handle);
+	EXPECT_EQ(vm.instance(handle), nullptr);
+	ASSERT_EQ(vm.modules()->size(), 1);
+	EXPECT_EQ(vm.modules()->front(), vm.instance(kept));
+	EXPECT_EQ(module.use_count(), 2);
+
+	// Churn reuses the slot, without reviving the old handle.
+	for (std::size_t i = 0; i < 100; ++i) {
+		auto next = vm.instantiate(module);
+		EXPECT_EQ(next.index(), handle.index());
+		static_call<>(cx, vm.instance(next), 0);
+		vm.destroy(next);
+	}
+	EXPECT_EQ(vm.instance(handle), nullptr);
+	EXPECT_EQ(vm.modules()->size(), 1);
+	EXPECT_EQ(module.use_count(), 2);
+}
+
+}  // namespace Ab::Test
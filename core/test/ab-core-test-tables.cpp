@@ -0,0 +1,221 @@
+#include <Ab/Config.hpp>
+#include <Ab/HostFunc.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/TypeRegistry.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestTables : public BasicTest {};
+
+std::int32_t host_negate(std::int32_t x) { return -x; }
+
+/// A module with two tables, and the functions:
+///   0: identity   (x i32) -> i32,
+///   1: twice      (x i32) -> i32,
+///   2: nothing    () -> (),
+///   3: dispatch0  (slot i32, x i32) -> i32, calls slot of table 0 with x,
+///   4: dispatch1  (slot i32, x i32) -> i32, calls slot of table 1 with x.
+///
+/// Table 0 has 4 slots, holding identity, twice and nothing, then an empty slot. Table 1 has 2
+/// slots, holding nothing, then twice.
+///
+absl::Span<Byte> make_tables_module() {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{}, {}});
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.tables.push_back(TableEntry{4, 4});
+	mod.tables.push_back(TableEntry{2, 8});
+	mod.elements.push_back(ElementSegment{0, 0, {0, 1, 2}});
+	mod.elements.push_back(ElementSegment{1, 1, {1}});
+
+	FuncNode& identity = push_func(mod, 0, 0);
+	identity.push<X32ReturnInsnNode>(0);
+
+	FuncNode& twice = push_func(mod, 0, 0);
+	twice.push<I32AddInsnNode>(0, 0, 0);
+	twice.push<X32ReturnInsnNode>(0);
+
+	FuncNode& nothing = push_func(mod, 1, 0);
+	nothing.push<ReturnInsnNode>();
+
+	for (std::uint32_t table : {0, 1}) {
+		FuncNode& dispatch = push_func(mod, 2, 0);
+		dispatch.push<CallIndirectInsnNode>(0, 1, 0, table);
+		dispatch.push<X32ReturnInsnNode>(1);
+	}
+
+	return mod.write();
+}
+
+/// A module importing `env.negate`, with one table holding the import, and the function:
+///   0: dispatch (slot i32, x i32) -> i32, calls slot of table 0 with x.
+///
+absl::Span<Byte> make_table_importer_module() {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	mod.imports.push_back({"env", "negate", ExternalKind::FUNC, 1});
+	mod.tables.push_back(TableEntry{1, 1});
+	mod.elements.push_back(ElementSegment{0, 0, {0}});
+
+	FuncNode& dispatch = push_func(mod, 0, 0);
+	dispatch.push<CallIndirectInsnNode>(1, 1, 0);
+	dispatch.push<X32ReturnInsnNode>(1);
+
+	return mod.write();
+}
+
+std::int32_t dispatch(Context& cx, ModuleInst* inst, std::size_t index, std::int32_t slot,
+					  std::int32_t x) {
+	return std::get<0>(static_call<std::int32_t>(cx, inst, index, slot, x));
+}
+
+TEST_F(TestTables, DecodeTablesAndElements) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, make_tables_module());
+
+	ASSERT_EQ(module->table_table().size(), 2);
+	EXPECT_EQ(module->table_table()[0].size_min, 4);
+	EXPECT_EQ(module->table_table()[1].size_max, 8);
+
+	ASSERT_EQ(module->element_table().size(), 2);
+	EXPECT_EQ(module->element_table()[0].funcs, (std::vector<std::uint32_t>{0, 1, 2}));
+	EXPECT_EQ(module->element_table()[1].table, 1);
+	EXPECT_EQ(module->element_table()[1].offset, 1);
+
+	EXPECT_EQ(Opcode(module->func_table()[3].body()[0]), Opcode::CALL_INDIRECT);
+}
+
+TEST_F(TestTables, InvalidElementSegments) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	auto make = [](std::uint32_t table, std::uint32_t offset, std::uint32_t func) {
+		ModuleNode mod;
+		mod.types.push_back(FuncType{{}, {}});
+		mod.tables.push_back(TableEntry{2, 2});
+		mod.elements.push_back(ElementSegment{table, offset, {func}});
+		FuncNode& nothing = push_func(mod, 0, 0);
+		nothing.push<ReturnInsnNode>();
+		return mod.write();
+	};
+
+	EXPECT_NO_THROW(compile(cx, make(0, 1, 0)));
+	EXPECT_THROW(compile(cx, make(1, 0, 0)), std::runtime_error);
+	EXPECT_THROW(compile(cx, make(0, 2, 0)), std::runtime_error);
+	EXPECT_THROW(compile(cx, make(0, 0, 1)), std::runtime_error);
+
+	ModuleNode mod;
+	mod.tables.push_back(TableEntry{2, 1});
+	EXPECT_THROW(compile(cx, mod.write()), std::runtime_error);
+}
+
+TEST_F(TestTables, MissingCallIndirectTypesAreRejected) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32}, {}});
+	mod.tables.push_back(TableEntry{1, 1});
+	FuncNode& caller = push_func(mod, 0, 0);
+	caller.push<CallIndirectInsnNode>(1, 0, 0);
+	caller.push<ReturnInsnNode>();
+
+	EXPECT_THROW(compile(cx, mod.write()), DecodeError);
+}
+
+TEST_F(TestTables, TypeIdsAreCanonical) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto a = compile(cx, make_tables_module());
+	auto b = compile(cx, make_table_importer_module());
+
+	// Equal types get equal ids, whatever their index, and distinct types get distinct ids.
+	EXPECT_EQ(a->type_ids()[0], b->type_ids()[1]);
+	EXPECT_EQ(a->type_ids()[2], b->type_ids()[0]);
+	EXPECT_NE(a->type_ids()[0], a->type_ids()[1]);
+	EXPECT_NE(a->type_ids()[0], NULL_TYPE_ID);
+	EXPECT_EQ(TypeRegistry::intern(FuncType{{ValType::I32}, {ValType::I32}}), a->type_ids()[0]);
+
+	// Imports take the id of their declared type.
+	EXPECT_EQ(b->func_type_id(0), b->type_ids()[1]);
+	EXPECT_EQ(b->func_type_id(1), b->type_ids()[0]);
+}
+
+TEST_F(TestTables, LinkingFillsTables) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_tables_module());
+
+	ASSERT_EQ(inst->table_count(), 2);
+	const RefTable& table = inst->table(0);
+	ASSERT_EQ(table.size(), 4);
+	EXPECT_EQ(table[0].func, inst->func_inst(0));
+	EXPECT_EQ(table[1].func, inst->func_inst(1));
+	EXPECT_EQ(table[1].type_id, inst->shared_module()->type_ids()[0]);
+	EXPECT_EQ(table[2].type_id, inst->shared_module()->type_ids()[1]);
+	EXPECT_EQ(table[3].func, nullptr);
+	EXPECT_EQ(table[3].type_id, NULL_TYPE_ID);
+}
+
+TEST_F(TestTables, CallIndirect) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_tables_module());
+
+	EXPECT_EQ(dispatch(cx, inst, 3, 0, 7), 7);
+	EXPECT_EQ(dispatch(cx, inst, 3, 1, 7), 14);
+	EXPECT_EQ(dispatch(cx, inst, 4, 1, 5), 10);
+}
+
+TEST_F(TestTables, CallIndirectTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_tables_module());
+
+	// The wrong signature.
+	EXPECT_THROW(dispatch(cx, inst, 3, 2, 7), Trap);
+
+	// An empty slot.
+	EXPECT_THROW(dispatch(cx, inst, 3, 3, 7), Trap);
+	EXPECT_THROW(dispatch(cx, inst, 4, 0, 7), Trap);
+
+	// Out of bounds.
+	EXPECT_THROW(dispatch(cx, inst, 3, 4, 7), Trap);
+	EXPECT_THROW(dispatch(cx, inst, 4, 2, 7), Trap);
+	EXPECT_THROW(dispatch(cx, inst, 3, -1, 7), Trap);
+
+	// The instance is still usable.
+	EXPECT_EQ(dispatch(cx, inst, 3, 1, 3), 6);
+}
+
+TEST_F(TestTables, CallIndirectImport) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	FuncInst* negate = define_host<&host_negate>(vm, "env", "negate");
+	ModuleInst* inst = instantiate(cx, make_table_importer_module());
+
+	EXPECT_EQ(inst->table(0)[0].func, negate);
+	EXPECT_EQ(dispatch(cx, inst, 0, 0, 5), -5);
+}
+
+TEST_F(TestTables, CopiesCallTheirOwnFunctions) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* prototype = instantiate(cx, make_tables_module());
+	ModuleInst copy(*prototype);
+
+	EXPECT_EQ(copy.table(0)[1].func, copy.func_inst(1));
+	EXPECT_EQ(copy.table(1)[1].func, copy.func_inst(1));
+	EXPECT_EQ(dispatch(cx, &copy, 3, 1, 4), 8);
+}
+
+}  // namespace Ab::Test
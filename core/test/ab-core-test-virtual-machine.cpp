@@ -0,0 +1,147 @@
+#include <Ab/Config.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/Modules.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestVirtualMachine : public BasicTest {};
+
+/// A module with a single function, (i32 i32) -> i32, which adds it's arguments.
+///
+absl::Span<Byte> make_adder() {
+	ModuleNode mod;
+	mod.types.push_back(FuncType{{ValType::I32, ValType::I32}, {ValType::I32}});
+	FuncNode& func = push_func(mod, 0, 3);
+	func.push<I32AddInsnNode>(2, 0, 1);
+	func.push<X32ReturnInsnNode>(2);
+	return mod.write();
+}
+
+TEST_F(TestVirtualMachine, CurrentContext) {
+	VirtualMachine vm(runtime());
+	EXPECT_EQ(Context::current(), nullptr);
+	EXPECT_EQ(VirtualMachine::current(), nullptr);
+	{
+		Context cx1(&vm);
+		EXPECT_EQ(Context::current(), &cx1);
+		EXPECT_EQ(VirtualMachine::current(), &vm);
+		{
+			Context cx2(&vm);
+			EXPECT_EQ(Context::current(), &cx2);
+			EXPECT_EQ(vm.context_count(), 2);
+		}
+		EXPECT_EQ(Context::current(), &cx1);
+		EXPECT_EQ(vm.context_count(), 1);
+	}
+	EXPECT_EQ(Context::current(), nullptr);
+	EXPECT_EQ(vm.context_count(), 0);
+}
+
+TEST_F(TestVirtualMachine, ModuleSnapshot) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	auto before = vm.modules();
+	EXPECT_TRUE(before->empty());
+
+	ModuleInst* inst = instantiate(cx, make_adder());
+	auto after       = vm.modules();
+
+	// Old snapshots are never modified.
+	EXPECT_TRUE(before->empty());
+	ASSERT_EQ(after->size(), 1);
+	EXPECT_EQ(after->at(0), inst);
+}
+
+TEST_F(TestVirtualMachine, ConcurrentContexts) {
+	constexpr std::size_t NTHREADS = 8;
+	constexpr std::size_t NINSTS   = 16;
+
+	VirtualMachine vm(runtime());
+	std::vector<std::thread> threads;
+	std::vector<int> failures(NTHREADS, 0);
+
+	for (std::size_t t = 0; t < NTHREADS; ++t) {
+		threads.emplace_back([&vm, &failures, t] {
+			for (std::size_t i = 0; i < NINSTS; ++i) {
+				Context cx(&vm);
+				ModuleInst* inst = instantiate(cx, make_adder());
+				auto result      = static_call<std::int32_t>(
+					cx, inst->func_inst(0), std::int32_t(t), std::int32_t(i));
+				if (std::get<0>(result) != std::int32_t(t + i)) {
+					++failures[t];
+				}
+				if (vm.modules()->empty()) {
+					++failures[t];
+				}
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (auto f : failures) {
+		EXPECT_EQ(f, 0);
+	}
+	EXPECT_EQ(vm.context_count(), 0);
+	EXPECT_EQ(vm.modules()->size(), NTHREADS * NINSTS);
+}
+
+TEST_F(TestVirtualMachine, BatchCall) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, make_adder());
+
+	std::vector<std::tuple<std::int32_t, std::int32_t>> args;
+	for (std::int32_t i = 0; i < 1000; ++i) {
+		args.emplace_back(i, i * 2);
+	}
+	std::vector<std::tuple<std::int32_t>> results(args.size());
+
+	batch_call<std::int32_t>(cx, inst, 0, absl::MakeConstSpan(args), absl::MakeSpan(results));
+	for (std::int32_t i = 0; i < 1000; ++i) {
+		EXPECT_EQ(results[i], std::make_tuple(i * 3));
+	}
+
+	// The frame is gone, and the context is reusable.
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(1), std::int32_t(2)),
+			  std::make_tuple(3));
+}
+
+TEST_F(TestVirtualMachine, BatchCallTrap) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	// (addr i32) -> i32, loads from memory.
+	ModuleNode mod;
+	mod.memories.push_back(MemoryEntry{1, 1});
+	mod.types.push_back(FuncType{{ValType::I32}, {ValType::I32}});
+	FuncNode& load = push_func(mod, 0, 1);
+	load.push<I32AtomicLoadInsnNode>(0, 0, 0);
+	load.push<X32ReturnInsnNode>(0);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	auto end = std::int32_t(inst->memory(0)->size());
+	std::vector<std::tuple<std::int32_t>> args = {{0}, {4}, {end}, {8}};
+	std::vector<std::tuple<std::int32_t>> results(args.size(), {-1});
+
+	EXPECT_THROW(
+		batch_call<std::int32_t>(cx, inst, 0, absl::MakeConstSpan(args), absl::MakeSpan(results)),
+		Trap);
+	EXPECT_EQ(results[0], std::make_tuple(0));
+	EXPECT_EQ(results[1], std::make_tuple(0));
+	EXPECT_EQ(results[3], std::make_tuple(-1));
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst, 0, std::int32_t(0)), std::make_tuple(0));
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,32 @@
+#ifndef AB_TEST_MODULES_HPP_
+#define AB_TEST_MODULES_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/VectorUtilities.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Ab::Test {
+
+/// Push a function of the type at `type_idx`, with `nregs` registers, onto a module. It's
+/// instructions are pushed onto the returned node.
+///
+inline FuncNode& push_func(ModuleNode& mod, std::uint32_t type_idx, std::uint32_t nregs) {
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = type_idx;
+	func.nregs     = nregs;
+	return func;
+}
+
+/// The T at an address of a memory. The address must be aligned for T.
+///
+template <typename T>
+T& memory_at(LinearMemory& memory, std::size_t address) {
+	return *reinterpret_cast<T*>(memory.address() + address);
+}
+
+}  // namespace Ab::Test
+
+#endif  // AB_TEST_MODULES_HPP_
@@ -11,6 +11,7 @@ const char* const USAGE_STRING =
 const char* const HELP_STRING =
 	"subcommands:\n"
 	"  ab run <abx>             Execute an abx module.\n"
+	"  ab aot <abx> [<out>]     Compile an abx module to a native shared object.\n"
 	"  ab asm <abt> [<out>]     Assemble an abt module into abx.\n"
 	"  ab disasm <abx> [<out>]  Disassemble an abx module into abt.\n"
 	"  ab help                  Print this help message.\n"
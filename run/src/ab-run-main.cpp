@@ -27,20 +27,31 @@ int run_file(const char* module_filename, std::string_view fn_name) {
 
 	AB_ASSERT(module != nullptr);
 
-#if 0
-
-	auto function = module->find_function(fn_name);
+	Ab::FuncInst* function = module->find_function(fn_name);
 
 	if (function == nullptr) {
-		fmt::print(
-			stderr, "Failed to find function '{}' in '{}'\n", fn_name, module_filename);
+		fmt::print(stderr, "Failed to find function '{}' in '{}'\n", fn_name, module_filename);
+		return 1;
 	}
 
-	Ab::run_function(cx, function);
-
-#endif // 0
+	// The entry point takes no arguments, and may return an i32 exit code.
+	const Ab::FuncType& type = *function->type();
+	try {
+		if (type.args.empty() && type.rets.empty()) {
+			Ab::static_call<>(cx, function);
+			return 0;
+		}
+		if (type.args.empty() && type.rets.size() == 1 && type.rets[0] == Ab::ValType::I32) {
+			return std::get<0>(Ab::static_call<std::int32_t>(cx, function));
+		}
+	} catch (const Ab::Trap& e) {
+		fmt::print(stderr, "Trap in '{}': {}\n", fn_name, e.what());
+		return 1;
+	}
 
-	return 0;
+	fmt::print(stderr, "Function '{}' must take no arguments, and return nothing or an i32\n",
+			   fn_name);
+	return 1;
 }
 
 int run_file(const char* file) { return run_file(file, "main"); }
@@ -82,8 +93,7 @@ extern "C" int main(int argc, char* argv[]) {
 		break;
 	case 1:
 		fmt::print(stderr, "executing: {}\n", argv[i]);
-		run_file(argv[i]);
-		break;
+		return run_file(argv[i]);
 	default:
 		fmt::print(stderr, "Error: unexpected argument '{}'\n", argv[i + 1]);
 		print_usage();
@@ -0,0 +1,57 @@
+#include <Ab/Config.hpp>
+#include <Ab/MemoryOps.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <vector>
+
+/// Copy and fill buffers of several sizes with each available kernel. The generic kernels are the
+/// C library's memmove and memset. Report the throughput of each, in GB/s.
+///
+/// Usage: BenchMemoryOps [<bytes per size>]
+///
+
+using namespace Ab;
+
+namespace {
+
+const std::size_t SIZES[] = {16, 64, 256, 1024, 4096, 65536, 1 << 20};
+
+template <typename F>
+double gigabytes_per_second(std::size_t size, std::size_t total, F&& f) {
+	std::size_t iterations = total / size;
+	auto start             = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < iterations; ++i) {
+		f(i);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return double(iterations * size) / elapsed.count() / 1e9;
+}
+
+void bench(const MemoryKernels& kernel, std::size_t total) {
+	// Copies overlap by half, so both directions are exercised.
+	std::vector<std::uint8_t> buffer(2 * SIZES[std::size(SIZES) - 1] + 64);
+	for (auto size : SIZES) {
+		auto copy = gigabytes_per_second(size, total, [&](std::size_t i) {
+			auto offset = i % 2 == 0 ? size / 2 : 0;
+			kernel.copy(buffer.data() + offset + 1, buffer.data() + size / 2 - offset, size);
+		});
+		auto fill = gigabytes_per_second(size, total, [&](std::size_t i) {
+			kernel.fill(buffer.data() + 3, std::uint8_t(i), size);
+		});
+		fmt::print("{:<8} {:>8} {:>10.2f} {:>10.2f}\n", kernel.name, size, copy, fill);
+	}
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	std::size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 30;
+
+	fmt::print("{:<8} {:>8} {:>10} {:>10}\n", "kernel", "size", "copy GB/s", "fill GB/s");
+	bench(generic_memory_kernels(), total);
+	if (avx2_memory_kernels() != nullptr) {
+		bench(*avx2_memory_kernels(), total);
+	}
+	return EXIT_SUCCESS;
+}
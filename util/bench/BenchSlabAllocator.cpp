@@ -0,0 +1,136 @@
+#include <Ab/Config.hpp>
+#include <Ab/SlabAllocator.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+/// Allocate a batch of small objects of mixed sizes, touch them, and free the whole batch, with
+/// malloc and with a SlabAllocator. malloc frees object by object, the slab frees with one reset.
+/// Report the mean time per allocation, on one thread and on several.
+///
+/// Usage: BenchSlabAllocator [<rounds>] [<threads>]
+///
+
+using namespace Ab;
+
+namespace {
+
+constexpr std::size_t BATCH_SIZE = 4096;
+
+/// Sizes typical of IR nodes and parse trees.
+///
+std::size_t size_at(std::size_t i) { return 16 + (i * 24) % 240; }
+
+struct Malloc {
+	void run(long rounds) {
+		std::vector<void*> objects(BATCH_SIZE);
+		for (long r = 0; r < rounds; ++r) {
+			for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+				objects[i] = std::malloc(size_at(i));
+				*static_cast<char*>(objects[i]) = char(i);
+			}
+			for (auto object : objects) {
+				std::free(object);
+			}
+		}
+	}
+};
+
+struct Slab {
+	void run(long rounds) {
+		for (long r = 0; r < rounds; ++r) {
+			for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+				*static_cast<char*>(slab.allocate(size_at(i))) = char(i);
+			}
+			slab.reset();
+		}
+	}
+
+	SlabAllocator slab;
+};
+
+struct SlabFree {
+	void run(long rounds) {
+		std::vector<void*> objects(BATCH_SIZE);
+		for (long r = 0; r < rounds; ++r) {
+			for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+				objects[i] = slab.allocate(size_at(i));
+				*static_cast<char*>(objects[i]) = char(i);
+			}
+			for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+				slab.deallocate(objects[i], size_at(i));
+			}
+		}
+	}
+
+	SlabAllocator slab;
+};
+
+/// Build a vector of vectors, then free it.
+///
+void fill_vectors(std::pmr::memory_resource* resource) {
+	std::pmr::vector<std::pmr::vector<int>> v(resource);
+	for (std::size_t i = 0; i < BATCH_SIZE / 4; ++i) {
+		v.emplace_back(size_at(i) / sizeof(int), int(i));
+	}
+}
+
+struct PmrNewDelete {
+	void run(long rounds) {
+		for (long r = 0; r < rounds; ++r) {
+			fill_vectors(std::pmr::new_delete_resource());
+		}
+	}
+};
+
+struct PmrSlab {
+	void run(long rounds) {
+		for (long r = 0; r < rounds; ++r) {
+			fill_vectors(&resource);
+			slab.reset();
+		}
+	}
+
+	SlabAllocator slab;
+	SlabResource resource{&slab};
+};
+
+/// Run a benchmark on `threads` threads at once. A shared allocator is shared between threads.
+///
+template <typename Bench>
+void bench(const char* name, long rounds, std::size_t threads, std::size_t allocs_per_round) {
+	Bench shared;
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (std::size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&] { shared.run(rounds); });
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+	fmt::print("{:<24} {:>3} threads {:>10.2f} ns/alloc\n", name, threads,
+			   ns / (double(rounds) * allocs_per_round * threads));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	long rounds         = argc > 1 ? std::atol(argv[1]) : 1000;
+	std::size_t threads = argc > 2 ? std::atol(argv[2]) : 4;
+
+	bench<Malloc>("malloc/free", rounds, 1, BATCH_SIZE);
+	bench<Slab>("slab/reset", rounds, 1, BATCH_SIZE);
+	bench<SlabFree>("slab/free", rounds, 1, BATCH_SIZE);
+	bench<PmrNewDelete>("pmr new/delete", rounds, 1, BATCH_SIZE / 4);
+	bench<PmrSlab>("pmr slab", rounds, 1, BATCH_SIZE / 4);
+
+	bench<Malloc>("malloc/free", rounds, threads, BATCH_SIZE);
+	bench<SlabFree>("slab/free", rounds, threads, BATCH_SIZE);
+	return 0;
+}
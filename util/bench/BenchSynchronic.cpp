@@ -0,0 +1,65 @@
+#include <Ab/Config.hpp>
+#include <Ab/Synchronic.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <sys/resource.h>
+#include <thread>
+
+/// Ping-pong a token between two threads through a pair of Synchronics, and report the mean
+/// round-trip latency and the CPU time burned per round trip.
+///
+/// Usage: BenchSynchronic [<rounds>]
+///
+
+using namespace Ab;
+
+namespace {
+
+double cpu_seconds() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	auto seconds = [](const timeval& t) { return double(t.tv_sec) + double(t.tv_usec) * 1e-6; };
+	return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+void bench(const char* name, WaitHint hint, long rounds) {
+	Synchronic<long> ping(0);
+	Synchronic<long> pong(0);
+
+	std::thread other([&] {
+		for (long i = 1; i <= rounds; ++i) {
+			ping.wait(i - 1, hint);
+			pong.store(i);
+			pong.notify_one();
+		}
+	});
+
+	auto cpu_start  = cpu_seconds();
+	auto wall_start = std::chrono::steady_clock::now();
+
+	for (long i = 1; i <= rounds; ++i) {
+		ping.store(i);
+		ping.notify_one();
+		pong.wait(i - 1, hint);
+	}
+
+	auto wall_end = std::chrono::steady_clock::now();
+	auto cpu_end  = cpu_seconds();
+	other.join();
+
+	auto wall_ns = std::chrono::duration<double, std::nano>(wall_end - wall_start).count();
+	auto cpu_ns  = (cpu_end - cpu_start) * 1e9;
+
+	fmt::print("{:<24} {:>12.1f} ns/round-trip {:>12.1f} cpu-ns/round-trip\n", name,
+			   wall_ns / rounds, cpu_ns / rounds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	long rounds = argc > 1 ? std::atol(argv[1]) : 100000;
+	bench("OPTIMIZE_LATENCY", WaitHint::OPTIMIZE_LATENCY, rounds);
+	bench("OPTIMIZE_UTILIZATION", WaitHint::OPTIMIZE_UTILIZATION, rounds);
+	return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef AB_FUTEX_HPP_
+#define AB_FUTEX_HPP_
+
+#include <Ab/Config.hpp>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Ab {
+
+/// The size of a cache line. Data written by different threads should be at least this far apart.
+///
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/// Hint to the processor that we are in a spin-wait loop.
+///
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+
+/// True if the machine has more than one CPU. On a uniprocessor, spin-waiting can never observe
+/// progress, because the thread we are waiting on can't run while we spin.
+///
+inline bool is_multiprocessor() noexcept {
+	static const bool result = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+	return result;
+}
+
+/// Block the calling thread while `*word == expected`, or until woken by futex_wake.
+/// Spurious wakeups are possible: callers must re-check their condition in a loop.
+///
+inline void futex_wait(std::atomic<std::uint32_t>* word, std::uint32_t expected) noexcept {
+	static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+	syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected,
+			nullptr, nullptr, 0);
+}
+
+/// Block the calling thread while `*word == expected`, until woken by futex_wake or until `timeout`
+/// has passed. Spurious wakeups are possible: callers must re-check their condition in a loop.
+///
+inline void futex_wait(std::atomic<std::uint32_t>* word, std::uint32_t expected,
+					   std::chrono::nanoseconds timeout) noexcept {
+	timespec ts;
+	ts.tv_sec  = std::time_t(timeout.count() / 1000000000);
+	ts.tv_nsec = long(timeout.count() % 1000000000);
+	syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected, &ts,
+			nullptr, 0);
+}
+
+/// Wake up to `count` threads blocked in futex_wait on `word`.
+/// @returns the number of threads woken.
+///
+inline int futex_wake(std::atomic<std::uint32_t>* word, int count) noexcept {
+	return int(syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE_PRIVATE,
+					   count, nullptr, nullptr, 0));
+}
+
+/// Wake every thread blocked in futex_wait on `word`.
+///
+inline int futex_wake_all(std::atomic<std::uint32_t>* word) noexcept {
+	return futex_wake(word, INT_MAX);
+}
+
+}  // namespace Ab
+
+#endif  // AB_FUTEX_HPP_
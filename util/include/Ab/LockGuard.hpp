@@ -5,6 +5,7 @@
 #include <Ab/Access.hpp>
 #include <Ab/Maybe.hpp>
 #include <Ab/SharedLock.hpp>
+#include <mutex>
 
 namespace Ab {
 
@@ -25,8 +26,17 @@ public:
 	/// Obtain shared access on the lock. Cannot fail, but will block.
 	inline explicit LockGuard(LockType & lock);
 
+	/// Take ownership of shared access that the caller already holds.
+	inline LockGuard(LockType & lock, std::adopt_lock_t);
+
+	/// Not copyable.
+	LockGuard(const LockGuard& other) = delete;
+
+	/// Move ownership of the lock. The moved-from guard releases nothing.
+	inline LockGuard(LockGuard&& other) noexcept;
+
 	/// Release shared access to the SharedLock.
-	inline ~LockGuard<LockType, Access::SHARED>();
+	inline ~LockGuard();
 
 	/// Not copy assignable.
 	LockGuard& operator=(const LockGuard& other) = delete;
@@ -44,7 +54,7 @@ protected:
 	inline void engage();
 
 private:
-	LockType& lock_;
+	LockType* lock_;
 };
 
 /// RAII: Holds a lock exclusively for lifetime.
@@ -56,6 +66,15 @@ public:
 	/// Obtain exclusive access. Cannot fail, but will block.
 	explicit LockGuard(LockType & lock);
 
+	/// Take ownership of exclusive access that the caller already holds.
+	LockGuard(LockType & lock, std::adopt_lock_t);
+
+	/// Not copyable.
+	LockGuard(const LockGuard& other) = delete;
+
+	/// Move ownership of the lock. The moved-from guard releases nothing.
+	LockGuard(LockGuard&& other) noexcept;
+
 	/// release exclusive access
 	~LockGuard();
 
@@ -75,7 +94,7 @@ protected:
 	void engage();
 
 private:
-	LockType& lock_;
+	LockType* lock_;
 };
 
 /// Readable alias to LockGuard<LockType, Access::exclusive>
@@ -2,53 +2,116 @@
 #define AB_LOCKGUARD_INL_HPP_
 
 #include <Ab/LockGuard.hpp>
+#include <thread>
 
 namespace Ab {
 
-/// TODO: implement
+/// Obtain shared access. Will block.
 template <typename LockType>
 inline SharedLockGuard<LockType> sharedLock(LockType& lock) {
 	return SharedLockGuard<LockType>(lock);
 }
 
-/// TODO: implement
+/// Obtain exclusive access. Will block.
 template <typename LockType>
 inline ExclusiveLockGuard<LockType> exclusiveLock(LockType& lock) {
 	return ExclusiveLockGuard<LockType>(lock);
 }
 
 /// Try to obtain shared access without blocking. Returns `nothing` on failure.
-/// TODO: implement
 template <typename LockType>
 inline Maybe<SharedLockGuard<LockType>> trySharedLock(LockType& lock) {
-	return SharedLockGuard<LockType>(lock);
+	if (!lock.template tryLock<Access::SHARED>()) {
+		return NOTHING;
+	}
+	return SharedLockGuard<LockType>(lock, std::adopt_lock);
 }
 
 /// Obtain exclusive access. Will not block. Can fail.
-/// TODO: implement
 template <typename LockType>
 inline Maybe<ExclusiveLockGuard<LockType>> tryExclusiveLock(LockType& lock) {
-	return ExclusiveLockGuard<LockType>(lock);
+	if (!lock.template tryLock<Access::EXCLUSIVE>()) {
+		return NOTHING;
+	}
+	return ExclusiveLockGuard<LockType>(lock, std::adopt_lock);
+}
+
+template <typename LockType>
+LockGuard<LockType, Access::SHARED>::LockGuard(LockType& lock) : lock_{&lock} {
+	engage();
 }
 
 template <typename LockType>
-LockGuard<LockType, Access::SHARED>::LockGuard(LockType& lock) : lock_{lock} {
-	// lock_.lock<Access::shared>();
+LockGuard<LockType, Access::SHARED>::LockGuard(LockType& lock, std::adopt_lock_t)
+	: lock_{&lock} {}
+
+template <typename LockType>
+LockGuard<LockType, Access::SHARED>::LockGuard(LockGuard&& other) noexcept
+	: lock_{other.lock_} {
+	other.lock_ = nullptr;
 }
 
 template <typename LockType>
 LockGuard<LockType, Access::SHARED>::~LockGuard() {
-	// lock_.unlock<Access::shared>();
+	if (lock_ != nullptr) {
+		disengage();
+	}
+}
+
+template <typename LockType>
+void LockGuard<LockType, Access::SHARED>::yield() {
+	disengage();
+	std::this_thread::yield();
+	engage();
+}
+
+template <typename LockType>
+void LockGuard<LockType, Access::SHARED>::disengage() {
+	lock_->template unlock<Access::SHARED>();
+}
+
+template <typename LockType>
+void LockGuard<LockType, Access::SHARED>::engage() {
+	lock_->template lock<Access::SHARED>();
+}
+
+template <typename LockType>
+LockGuard<LockType, Access::EXCLUSIVE>::LockGuard(LockType& lock) : lock_{&lock} {
+	engage();
 }
 
 template <typename LockType>
-LockGuard<LockType, Access::EXCLUSIVE>::LockGuard(LockType& lock) : lock_{lock} {
-	// lock_.lock<Access::EXCLUSIVE>();
+LockGuard<LockType, Access::EXCLUSIVE>::LockGuard(LockType& lock, std::adopt_lock_t)
+	: lock_{&lock} {}
+
+template <typename LockType>
+LockGuard<LockType, Access::EXCLUSIVE>::LockGuard(LockGuard&& other) noexcept
+	: lock_{other.lock_} {
+	other.lock_ = nullptr;
 }
 
 template <typename LockType>
 LockGuard<LockType, Access::EXCLUSIVE>::~LockGuard() {
-	// lock_.unlock<Access::EXCLUSIVE>();
+	if (lock_ != nullptr) {
+		disengage();
+	}
+}
+
+template <typename LockType>
+void LockGuard<LockType, Access::EXCLUSIVE>::yield() {
+	disengage();
+	std::this_thread::yield();
+	engage();
+}
+
+template <typename LockType>
+void LockGuard<LockType, Access::EXCLUSIVE>::disengage() {
+	lock_->template unlock<Access::EXCLUSIVE>();
+}
+
+template <typename LockType>
+void LockGuard<LockType, Access::EXCLUSIVE>::engage() {
+	lock_->template lock<Access::EXCLUSIVE>();
 }
 
 }  // namespace Ab
@@ -0,0 +1,48 @@
+#ifndef AB_MEMORYOPS_HPP_
+#define AB_MEMORYOPS_HPP_
+
+#include <Ab/Config.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Ab {
+
+/// A set of bulk memory kernels.
+///
+/// The copy kernel has the semantics of `memmove`: the ranges may overlap, and the result is as if
+/// the source were first copied to a temporary buffer. The fill kernel has the semantics of
+/// `memset`.
+///
+struct MemoryKernels {
+	void (*copy)(void* dst, const void* src, std::size_t n) noexcept;
+	void (*fill)(void* dst, std::uint8_t value, std::size_t n) noexcept;
+	const char* name;
+};
+
+/// Portable kernels, built on the C library. Always available.
+///
+const MemoryKernels& generic_memory_kernels() noexcept;
+
+/// Kernels vectorized with AVX2. Null if the target, or the running CPU, lacks AVX2.
+///
+const MemoryKernels* avx2_memory_kernels() noexcept;
+
+/// The best kernels for the running CPU. Selected once, on first use.
+///
+const MemoryKernels& memory_kernels() noexcept;
+
+/// Copy `n` bytes from `src` to `dst`. The ranges may overlap.
+///
+inline void copy_bytes(void* dst, const void* src, std::size_t n) noexcept {
+	memory_kernels().copy(dst, src, n);
+}
+
+/// Set `n` bytes at `dst` to `value`.
+///
+inline void fill_bytes(void* dst, std::uint8_t value, std::size_t n) noexcept {
+	memory_kernels().fill(dst, value, n);
+}
+
+}  // namespace Ab
+
+#endif  // AB_MEMORYOPS_HPP_
@@ -6,8 +6,12 @@
 #include <Ab/Bytes.hpp>
 #include <Ab/Process.hpp>
 #include <Ab/Result.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <errno.h>
+#include <iterator>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <system_error>
 #include <unistd.h>
 
@@ -31,11 +35,26 @@ public:
 	/// The size of a page. Must be determined at run time.
 	static std::size_t size() noexcept { return Process::properties().page_size(); }
 
+	/// The size of a huge page. This is the default huge page size on x86-64, and on aarch64 with
+	/// 4 KiB base pages.
+	static constexpr std::size_t HUGE_SIZE = std::size_t(2) << 20;
+
 	/// Will bring a page into memory, with no permissions.
 	static MutAddress
 	map(MutAddress address, std::size_t size, int permissions = PagePermission::NONE) {
 		auto p = mmap(to_mut_ptr(address), size, permissions, MAP_ANON | MAP_PRIVATE, 0, 0);
-		if (p == nullptr) {
+		if (p == MAP_FAILED) {
+			throw PageError{"Failed to map pages"};
+		}
+		return to_mut_address(p);
+	}
+
+	/// Map fresh anonymous pages over `address`. Replaces any existing mapping in the range.
+	static MutAddress
+	map_fixed(MutAddress address, std::size_t size, int permissions = PagePermission::NONE) {
+		auto p = mmap(
+			to_mut_ptr(address), size, permissions, MAP_ANON | MAP_PRIVATE | MAP_FIXED, -1, 0);
+		if (p == MAP_FAILED) {
 			throw PageError{"Failed to map pages"};
 		}
 		return to_mut_address(p);
@@ -46,6 +65,121 @@ public:
 		return map(nullptr, size, permissions);
 	}
 
+	/// Map `size` bytes, starting on a multiple of `alignment`. The alignment must be a power of
+	/// two multiple of the page size. `address` is a hint, and is ignored if it is not aligned.
+	static MutAddress map_aligned(
+		MutAddress address, std::size_t size, std::size_t alignment,
+		int permissions = PagePermission::NONE) {
+		if (address != nullptr && misalignment(address, alignment) == 0) {
+			auto p = map(address, size, permissions);
+			if (misalignment(p, alignment) == 0) {
+				return p;
+			}
+			unmap(p, size);
+		}
+
+		// Over-map by the alignment, then trim the excess on either side.
+		auto p    = map(nullptr, size + alignment, permissions);
+		auto head = (alignment - misalignment(p, alignment)) % alignment;
+		if (head != 0) {
+			unmap(p, head);
+		}
+		unmap(p + head + size, alignment - head);
+		return p + head;
+	}
+
+	/// Map `size` bytes of explicit huge pages, taken from the kernel's huge page pool. The size
+	/// must be a multiple of HUGE_SIZE. The pages are reserved when mapped, so a mapping never
+	/// faults for want of huge pages.
+	///
+	/// Returns null if the pool can't satisfy the request. Callers are expected to fall back to
+	/// regular pages.
+	static MutAddress map_huge(
+		MutAddress address, std::size_t size, int permissions = PagePermission::NONE) noexcept {
+		auto p = mmap(
+			to_mut_ptr(address), size, permissions, MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, 0, 0);
+		if (p == MAP_FAILED) {
+			return nullptr;
+		}
+		return to_mut_address(p);
+	}
+
+	/// Ask the kernel to back a range with transparent huge pages. The range should be aligned to
+	/// HUGE_SIZE. Returns false if transparent huge pages are not supported.
+	static bool advise_huge(const MutAddress address, const std::size_t size) noexcept {
+		return madvise(to_mut_ptr(address), size, MADV_HUGEPAGE) == 0;
+	}
+
+	/// Place a range on a NUMA node. Pages faulted in later are allocated on the node when it has
+	/// free memory, and on other nodes when it doesn't. With `move`, resident pages are migrated
+	/// to the node. Returns false if the system doesn't support NUMA policies.
+	static bool
+	bind(const MutAddress address, const std::size_t size, int node, bool move) noexcept {
+		// From <numaif.h>, to avoid a dependency on libnuma.
+		constexpr int MPOL_PREFERRED    = 1;
+		constexpr unsigned MPOL_MF_MOVE = 1 << 1;
+		constexpr std::size_t MASK_BITS = 8 * sizeof(unsigned long);
+
+		unsigned long mask[16] = {};
+		if (node < 0 || std::size_t(node) >= std::size(mask) * MASK_BITS) {
+			return false;
+		}
+		mask[node / MASK_BITS] = 1ul << (node % MASK_BITS);
+
+		// The kernel expects one more than the number of bits in the mask.
+		auto e = syscall(
+			SYS_mbind, to_mut_ptr(address), size, MPOL_PREFERRED, mask,
+			std::size(mask) * MASK_BITS + 1, move ? MPOL_MF_MOVE : 0);
+		return e == 0;
+	}
+
+	/// Map a range of a file over `address`, copy-on-write. Writes are private to the mapping, and
+	/// never reach the file. Replaces any existing mapping in the range.
+	static MutAddress map_file_private(
+		MutAddress address, std::size_t size, int permissions, int fd, off_t offset = 0) {
+		auto p = mmap(to_mut_ptr(address), size, permissions, MAP_PRIVATE | MAP_FIXED, fd, offset);
+		if (p == MAP_FAILED) {
+			throw PageError{"Failed to map file"};
+		}
+		return to_mut_address(p);
+	}
+
+	/// Drop the contents of a range of private pages, releasing the physical memory. Anonymous
+	/// pages read back as zero, and file-backed pages read back from the file.
+	static void discard(const MutAddress address, const std::size_t size) {
+		auto e = madvise(to_mut_ptr(address), size, MADV_DONTNEED);
+		if (e != 0) {
+			throw PageError{"Failed to discard pages"};
+		}
+	}
+
+	/// Drop the contents of a range of private anonymous pages, but leave the kernel to release
+	/// the physical memory when it runs short. Until then, the pages may read back with their old
+	/// contents. Returns false if lazy release is unsupported for the range, e.g. for file-backed
+	/// or huge pages.
+	static bool discard_lazily(const MutAddress address, const std::size_t size) noexcept {
+		return madvise(to_mut_ptr(address), size, MADV_FREE) == 0;
+	}
+
+	/// The number of bytes of a range that are resident in physical memory.
+	static std::size_t resident(const MutAddress address, const std::size_t size) {
+		constexpr std::size_t CHUNK = 4096;
+		unsigned char pages[CHUNK];
+
+		std::size_t count = 0;
+		std::size_t total = (size + Page::size() - 1) / Page::size();
+		for (std::size_t i = 0; i < total; i += CHUNK) {
+			std::size_t n = std::min(CHUNK, total - i);
+			if (mincore(to_mut_ptr(address + i * Page::size()), n * Page::size(), pages) != 0) {
+				throw PageError{"Failed to query resident pages"};
+			}
+			for (std::size_t j = 0; j < n; ++j) {
+				count += pages[j] & 1;
+			}
+		}
+		return count * Page::size();
+	}
+
 	/// Unmap a page from memory.
 	/// Returns 0 on success.
 	static void unmap(const MutAddress address, const std::size_t size) {
@@ -62,6 +196,11 @@ public:
 			throw PageError{"Failed to set page permissions"};
 		}
 	}
+
+private:
+	static std::size_t misalignment(const MutAddress address, std::size_t alignment) noexcept {
+		return reinterpret_cast<std::uintptr_t>(address) % alignment;
+	}
 };
 
 }  // namespace Ab
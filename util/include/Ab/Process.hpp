@@ -25,6 +25,9 @@ public:
 	/// Obtain the invariant properties of the process.
 	static const SystemProperties& properties() noexcept { return properties_; }
 
+	/// The NUMA node of the CPU the calling thread is running on. Zero if unknown. Thread safe.
+	static int numa_node() noexcept;
+
 private:
 	static SystemProperties properties_;
 };
@@ -3,6 +3,10 @@
 
 #include <Ab/Config.hpp>
 #include <Ab/Access.hpp>
+#include <Ab/Futex.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 namespace Ab {
 
@@ -12,70 +16,168 @@ enum class SharedLockError { SUCCESS = 0, FAIL };
 /// SharedLockGuard sharedHeapAccess(heap.lock()); // obtain shared access to the heap
 ///   heap.allocate(sharedHeapAccess());
 ///   ExclusiveLockGuard exclusiveHeapAccess(heapLock); // upgrade
+///
+/// The lock is built for read-mostly data. Readers are counted across a set of stripes, each on
+/// it's own cache line, and each thread always counts itself in the same stripe. Readers on
+/// different threads will usually touch different lines, so taking shared access does not
+/// serialize on a single counter. In exchange, a writer must scan every stripe.
+///
+/// Writers are preferred: once a writer is waiting, new readers back off until it has come and
+/// gone. Shared access is not reentrant, a thread taking shared access twice may deadlock
+/// against a waiting writer. Shared access must be released by the thread that took it.
+///
+/// Contended waits spin briefly, then block in the kernel on a futex.
+///
 class SharedLock {
 public:
+	/// The number of reader stripes. A power of two.
+	///
+	static constexpr std::size_t STRIPE_COUNT = 16;
+
+	/// The number of times a waiter polls before blocking.
+	///
+	static constexpr unsigned int SPIN_COUNT = 128;
+
 	SharedLock() noexcept;
 
 	~SharedLock() noexcept;
 
 	auto init() noexcept -> SharedLockError;
 
+	/// Fails if the lock is still held.
 	auto kill() noexcept -> SharedLockError;
 
 	template <Access access>
 	inline void lock() noexcept;
 
+	/// Obtain access without blocking. Returns false on failure.
+	template <Access access>
+	inline auto tryLock() noexcept -> bool;
+
 	template <Access access>
 	inline auto unlock() noexcept -> void;
 
+	/// Racy, suitable for assertions and tests.
 	template <Access access>
 	inline auto isLocked() const noexcept -> bool;
 
 private:
-	int sharedCount_    = 0;
-	int exclusiveCount_ = 0;
-	// std::mutex mutex_;
-	// atomic<int> sharedCount_;
+	enum : std::uint32_t { UNLOCKED = 0, LOCKED = 1, CONTENDED = 2 };
+
+	struct alignas(CACHE_LINE_SIZE) Stripe {
+		std::atomic<std::uint32_t> readers{0};
+	};
+
+	/// Assign a stripe to a new thread.
+	static auto nextStripeIndex() noexcept -> std::size_t;
+
+	/// The calling thread's reader stripe.
+	inline auto stripe() noexcept -> Stripe&;
+
+	/// Drop a reader count, and wake a writer waiting for the stripe to drain.
+	inline auto releaseReader(Stripe& stripe) noexcept -> void;
+
+	/// Back off from a waiting writer, and retake shared access once it has left.
+	auto lockSharedSlow(Stripe& stripe) noexcept -> void;
+
+	/// Take the writer word when another writer holds it.
+	auto lockExclusiveSlow() noexcept -> void;
+
+	/// Block until no writer holds or waits for the lock.
+	auto waitForWriter() noexcept -> void;
+
+	/// Block until every reader stripe has drained.
+	auto waitForReaders() noexcept -> void;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> writer_{UNLOCKED};
+	Stripe stripes_[STRIPE_COUNT];
 };
 
 ///
 /// Implementation
 ///
 
+inline auto SharedLock::stripe() noexcept -> Stripe& {
+	static thread_local const std::size_t index = nextStripeIndex();
+	return stripes_[index & (STRIPE_COUNT - 1)];
+}
+
+inline auto SharedLock::releaseReader(Stripe& stripe) noexcept -> void {
+	if (stripe.readers.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+		writer_.load(std::memory_order_seq_cst) != UNLOCKED) {
+		futex_wake(&stripe.readers, 1);
+	}
+}
+
 template <>
 inline auto SharedLock::lock<Access::SHARED>() noexcept -> void {
-	// TODO: Implement
-	sharedCount_ += 1;
-};
+	Stripe& s = stripe();
+	s.readers.fetch_add(1, std::memory_order_seq_cst);
+	if (writer_.load(std::memory_order_seq_cst) != UNLOCKED) {
+		lockSharedSlow(s);
+	}
+}
 
 template <>
 inline auto SharedLock::lock<Access::EXCLUSIVE>() noexcept -> void {
-	// TODO: Implement
-	exclusiveCount_ += 1;
+	std::uint32_t expected = UNLOCKED;
+	if (!writer_.compare_exchange_strong(expected, LOCKED, std::memory_order_seq_cst)) {
+		lockExclusiveSlow();
+	}
+	waitForReaders();
 }
 
 template <>
-inline auto SharedLock::unlock<Access::SHARED>() noexcept -> void {
-	// TODO: Implement
-	sharedCount_ -= 1;
+inline auto SharedLock::tryLock<Access::SHARED>() noexcept -> bool {
+	Stripe& s = stripe();
+	s.readers.fetch_add(1, std::memory_order_seq_cst);
+	if (writer_.load(std::memory_order_seq_cst) != UNLOCKED) {
+		releaseReader(s);
+		return false;
+	}
+	return true;
 }
 
 template <>
 inline auto SharedLock::unlock<Access::EXCLUSIVE>() noexcept -> void {
-	// TODO: Implement
-	exclusiveCount_ -= 1;
+	if (writer_.exchange(UNLOCKED, std::memory_order_seq_cst) == CONTENDED) {
+		futex_wake_all(&writer_);
+	}
+}
+
+template <>
+inline auto SharedLock::tryLock<Access::EXCLUSIVE>() noexcept -> bool {
+	std::uint32_t expected = UNLOCKED;
+	if (!writer_.compare_exchange_strong(expected, LOCKED, std::memory_order_seq_cst)) {
+		return false;
+	}
+	for (const auto& s : stripes_) {
+		if (s.readers.load(std::memory_order_seq_cst) != 0) {
+			unlock<Access::EXCLUSIVE>();
+			return false;
+		}
+	}
+	return true;
+}
+
+template <>
+inline auto SharedLock::unlock<Access::SHARED>() noexcept -> void {
+	releaseReader(stripe());
 }
 
 template <>
 inline auto SharedLock::isLocked<Access::SHARED>() const noexcept -> bool {
-	// TODO: Implement
+	for (const auto& s : stripes_) {
+		if (s.readers.load(std::memory_order_relaxed) != 0) {
+			return true;
+		}
+	}
 	return false;
 }
 
 template <>
 inline auto SharedLock::isLocked<Access::EXCLUSIVE>() const noexcept -> bool {
-	// TODO: Implement
-	return false;
+	return writer_.load(std::memory_order_relaxed) != UNLOCKED;
 }
 
 }  // namespace Ab
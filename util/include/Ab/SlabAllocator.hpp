@@ -1,16 +1,199 @@
 #ifndef AB_SLABALLOCATOR_HPP_
 #define AB_SLABALLOCATOR_HPP_
 
-#error "This file is unimplemented"
-
-#include <Core/Config.hpp>
+#include <Ab/Config.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Ab {
 
 /// C++ Allocator. Supports bulk-freeing.
 /// To support bulk freeing, the slab allocator can only allocate POD datastructures.
 /// There is no garuntee that a destructor will be called.
-class SlabAllocator {};
+///
+/// Memory is carved out of large slabs. Small requests are rounded up to a size class, and are
+/// served from the calling thread's cache for that class, so the common allocation is a
+/// thread-local pop or pointer bump, with no lock and no atomic read-modify-write. A thread
+/// refills a class by taking a run of objects from the shared slab, under a lock. Larger
+/// requests are bump allocated from the shared slab, and very large ones get their own block.
+///
+/// Freeing a small object returns it to the calling thread's cache, for reuse by that thread.
+/// Larger objects are only reclaimed by `reset`, which frees every allocation at once.
+///
+/// Example:
+///   ```
+///   SlabAllocator slab;
+///   auto node = slab.make<Node>(...);
+///   ...
+///   slab.reset();
+///   ```
+///
+/// Allocation and deallocation are thread safe. Reset, release and destruction are not: no other
+/// thread may be using the allocator, and every outstanding allocation is invalidated, and must
+/// not be freed afterwards.
+///
+class SlabAllocator {
+public:
+	static constexpr std::size_t DEFAULT_SLAB_SIZE = 64 * 1024;
+
+	/// The minimum alignment of every allocation. Size classes are multiples of the alignment.
+	///
+	static constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+	/// Requests up to the largest size class are served from thread caches.
+	///
+	static constexpr std::array<std::size_t, 12> SIZE_CLASSES = {
+		16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+	static constexpr std::size_t CLASS_COUNT = SIZE_CLASSES.size();
+
+	static constexpr std::size_t MAX_SMALL_SIZE = SIZE_CLASSES.back();
+
+	/// The number of bytes a thread takes from the shared slab, to refill a size class.
+	///
+	static constexpr std::size_t RUN_SIZE = 4096;
+
+	/// The number of allocators a thread caches objects for at once. A thread using more
+	/// allocators than this will evict a cache, and it's free objects are lost until reset.
+	///
+	static constexpr std::size_t THREAD_CACHE_COUNT = 4;
+
+	/// The size class of a small request.
+	///
+	static constexpr std::size_t size_class(std::size_t size) noexcept {
+		std::size_t cls = 0;
+		while (SIZE_CLASSES[cls] < size) {
+			++cls;
+		}
+		return cls;
+	}
+
+	explicit SlabAllocator(std::size_t slab_size = DEFAULT_SLAB_SIZE);
+
+	SlabAllocator(const SlabAllocator&) = delete;
+
+	~SlabAllocator() noexcept;
+
+	SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+	/// Allocate uninitialized memory. The alignment must be a power of two. Never returns null.
+	///
+	void* allocate(std::size_t size, std::size_t alignment = ALIGNMENT);
+
+	/// Free memory from `allocate`, with the same size and alignment. Optional.
+	///
+	void deallocate(void* p, std::size_t size, std::size_t alignment = ALIGNMENT) noexcept;
+
+	/// Allocate an uninitialized array of `n` Ts.
+	///
+	template <typename T>
+	T* allocate_array(std::size_t n) {
+		static_assert(std::is_trivially_destructible_v<T>, "Slab objects are never destroyed");
+		return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+	}
+
+	/// Allocate and construct a T.
+	///
+	template <typename T, typename... Args>
+	T* make(Args&&... args) {
+		static_assert(std::is_trivially_destructible_v<T>, "Slab objects are never destroyed");
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/// Free every allocation. Slabs are kept, and reused by later allocations.
+	///
+	void reset() noexcept;
+
+	/// Free every allocation, and return all memory to the system.
+	///
+	void release() noexcept;
+
+	/// The number of bytes held by the allocator, in slabs and large blocks.
+	///
+	std::size_t reserved_bytes() const noexcept;
+
+	std::size_t slab_size() const noexcept { return slab_size_; }
+
+private:
+	struct LargeBlock {
+		void* address;
+		std::size_t size;
+		std::size_t alignment;
+	};
+
+	struct ThreadCache;
+
+	/// The calling thread's cache for this allocator.
+	///
+	ThreadCache& cache() noexcept;
+
+	/// Take a run of objects for a size class from the shared slab.
+	///
+	void* refill(ThreadCache& cache, std::size_t cls);
+
+	void* allocate_large(std::size_t size, std::size_t alignment);
+
+	/// Bump allocate from the shared slab. Requires the lock.
+	///
+	std::byte* bump(std::size_t size, std::size_t alignment);
+
+	void free_large_blocks() noexcept;
+
+	const std::size_t slab_size_;
+
+	/// Identifies this allocator, between resets, to the thread caches. Never reused.
+	///
+	std::atomic<std::uint64_t> token_;
+
+	mutable std::mutex lock_;
+	std::vector<std::byte*> slabs_;
+	std::size_t next_slab_ = 0;
+	std::byte* cursor_     = nullptr;
+	std::byte* limit_      = nullptr;
+	std::vector<LargeBlock> large_blocks_;
+};
+
+/// A `std::pmr::memory_resource` backed by a SlabAllocator, for use with the standard
+/// containers.
+///
+/// Example:
+///   ```
+///   SlabResource resource(&slab);
+///   std::pmr::vector<int> v(&resource);
+///   ```
+///
+/// Containers must be destroyed before the allocator is reset.
+///
+class SlabResource : public std::pmr::memory_resource {
+public:
+	explicit SlabResource(SlabAllocator* allocator) noexcept : allocator_(allocator) {}
+
+	SlabAllocator* allocator() const noexcept { return allocator_; }
+
+private:
+	void* do_allocate(std::size_t size, std::size_t alignment) override {
+		return allocator_->allocate(size, alignment);
+	}
+
+	void do_deallocate(void* p, std::size_t size, std::size_t alignment) override {
+		allocator_->deallocate(p, size, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		auto resource = dynamic_cast<const SlabResource*>(&other);
+		return resource != nullptr && resource->allocator_ == allocator_;
+	}
+
+	SlabAllocator* allocator_;
+};
 
 }  // namespace Ab
 
@@ -1,17 +1,182 @@
 #ifndef AB_SYNCHRONIC_HPP_
 #define AB_SYNCHRONIC_HPP_
 
+#include <Ab/Config.hpp>
+#include <Ab/Futex.hpp>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
 namespace Ab {
 
+/// How a waiting thread should spend it's time.
+///
+///   * OPTIMIZE_LATENCY: Spin, then yield, then sleep. The waiter reacts to an update within
+///     nanoseconds, at the cost of burning a core while it spins. Uniprocessors skip the spin.
+///   * OPTIMIZE_UTILIZATION: Sleep in the kernel straight away. The core is free for other work,
+///     but each wakeup costs a round trip through the scheduler.
+///
 enum class WaitHint { OPTIMIZE_LATENCY, OPTIMIZE_UTILIZATION };
 
+/// An atomic value that threads can block on until it changes.
+///
+/// Waiters block on a 32-bit futex epoch, which every notify bumps. This lets a Synchronic hold
+/// any lock-free type, not just 32-bit words. Notifiers skip the wake syscall entirely when no
+/// thread is asleep.
+///
+/// Example:
+///   ```
+///   Synchronic<int> ready(0);
+///   // thread A
+///   ready.wait(0);  // block until ready != 0
+///   // thread B
+///   ready.store(1);
+///   ready.notify_all();
+///   ```
+///
 template <typename T>
 class Synchronic {
 public:
 	using Type = T;
 
-	Synchronic();
-	~Synchronic();
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	/// The number of times a latency-optimized waiter polls before yielding.
+	///
+	static constexpr unsigned int SPIN_COUNT = 1024;
+
+	/// The number of times a latency-optimized waiter yields before sleeping.
+	///
+	static constexpr unsigned int YIELD_COUNT = 64;
+
+	Synchronic() noexcept : value_{} {}
+
+	explicit Synchronic(T value) noexcept : value_{value} {}
+
+	Synchronic(const Synchronic&) = delete;
+
+	~Synchronic() noexcept = default;
+
+	Synchronic& operator=(const Synchronic&) = delete;
+
+	T load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+		return value_.load(order);
+	}
+
+	/// Store a value. Waiters are not woken until the caller notifies. A store which will be
+	/// followed by a notify must be sequentially-consistent.
+	///
+	void store(T value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		value_.store(value, order);
+	}
+
+	T exchange(T value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return value_.exchange(value, order);
+	}
+
+	/// Block the calling thread until the value is no longer `expected`.
+	///
+	void wait(T expected, WaitHint hint = WaitHint::OPTIMIZE_LATENCY) const noexcept {
+		if (!spin(expected, hint)) {
+			sleep(expected);
+		}
+	}
+
+	/// Block the calling thread until the value is no longer `expected`, or until `deadline`.
+	/// @returns false if the deadline passed first.
+	///
+	bool wait_until(T expected, std::chrono::steady_clock::time_point deadline,
+					WaitHint hint = WaitHint::OPTIMIZE_LATENCY) const noexcept {
+		return spin(expected, hint) || sleep_until(expected, deadline);
+	}
+
+	/// Wake one thread blocked in wait.
+	///
+	void notify_one() noexcept { notify(1); }
+
+	/// Wake every thread blocked in wait.
+	///
+	void notify_all() noexcept { notify(INT_MAX); }
+
+private:
+	bool changed(T expected) const noexcept {
+		T value = value_.load(std::memory_order_acquire);
+		return !bits_equal(value, expected);
+	}
+
+	static bool bits_equal(const T& lhs, const T& rhs) noexcept {
+		return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+	}
+
+	/// Poll, then yield, if the hint asks for it. Returns true if the value changed meanwhile.
+	///
+	bool spin(T expected, WaitHint hint) const noexcept {
+		if (hint != WaitHint::OPTIMIZE_LATENCY) {
+			return false;
+		}
+		unsigned int spins = is_multiprocessor() ? SPIN_COUNT : 0;
+		for (unsigned int i = 0; i < spins; ++i) {
+			if (changed(expected)) {
+				return true;
+			}
+			cpu_relax();
+		}
+		for (unsigned int i = 0; i < YIELD_COUNT; ++i) {
+			if (changed(expected)) {
+				return true;
+			}
+			std::this_thread::yield();
+		}
+		return false;
+	}
+
+	void sleep(T expected) const noexcept {
+		// The waiter count, epoch, and value are all accessed sequentially-consistent. Either the
+		// notifier sees our waiter count and wakes us, or we see it's epoch bump and don't sleep.
+		sleepers_.fetch_add(1, std::memory_order_seq_cst);
+		for (;;) {
+			auto epoch = epoch_.load(std::memory_order_seq_cst);
+			if (!bits_equal(value_.load(std::memory_order_seq_cst), expected)) {
+				break;
+			}
+			futex_wait(&epoch_, epoch);
+		}
+		sleepers_.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	bool sleep_until(T expected, std::chrono::steady_clock::time_point deadline) const noexcept {
+		bool result = true;
+		sleepers_.fetch_add(1, std::memory_order_seq_cst);
+		for (;;) {
+			auto epoch = epoch_.load(std::memory_order_seq_cst);
+			if (!bits_equal(value_.load(std::memory_order_seq_cst), expected)) {
+				break;
+			}
+			auto now = std::chrono::steady_clock::now();
+			if (now >= deadline) {
+				result = false;
+				break;
+			}
+			futex_wait(&epoch_, epoch, deadline - now);
+		}
+		sleepers_.fetch_sub(1, std::memory_order_relaxed);
+		return result;
+	}
+
+	void notify(int count) noexcept {
+		epoch_.fetch_add(1, std::memory_order_seq_cst);
+		if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+			futex_wake(&epoch_, count);
+		}
+	}
+
+	std::atomic<T> value_;
+	mutable std::atomic<std::uint32_t> epoch_{0};
+	mutable std::atomic<std::uint32_t> sleepers_{0};
 };
 
 }  // namespace Ab
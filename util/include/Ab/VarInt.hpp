@@ -35,6 +35,34 @@ inline void append_varuint(ByteBuffer& buffer, T value) {
 	} while (value != 0);
 }
 
+/// Append a uleb128 encoded number to the buffer, padded with redundant continuation bytes to
+/// exactly `width` bytes, so the size of the encoding doesn't depend on the value.
+///
+/// @tparam N the maximum number of bits the number allows.
+///
+template <std::size_t N, typename T>
+inline void append_padded_varuint(ByteBuffer& buffer, T value, std::size_t width) {
+	static_assert(std::is_integral_v<T>);
+	static_assert(std::is_unsigned_v<T>);
+	static_assert(N <= sizeof(T) * 8);
+
+	constexpr std::uint8_t data_mask = 0b0111'1111;
+	constexpr std::uint8_t flag_mask = 0b1000'0000;
+
+	if (width == 0 || (width * 7 < N && (value >> (width * 7)) != 0)) {
+		throw EncodingError("Number too large for padded width");
+	}
+
+	for (std::size_t i = 0; i < width; ++i) {
+		std::uint8_t byte = std::uint8_t(value) & data_mask;
+		value             = value >> 7;
+		if (i + 1 < width) {
+			byte = byte | flag_mask;
+		}
+		buffer.append(byte);
+	}
+}
+
 /// Append a 7-bit number encoded in uleb128 to the buffer.
 ///
 inline void append_varuint7(ByteBuffer& buffer, std::uint8_t value) {
@@ -47,6 +75,12 @@ inline void append_varuint32(ByteBuffer& buffer, std::uint32_t value) {
 	return append_varuint<32>(buffer, value);
 }
 
+/// Append a 64 bit number encoded in uleb128 to the buffer.
+///
+inline void append_varuint64(ByteBuffer& buffer, std::uint64_t value) {
+	return append_varuint<64>(buffer, value);
+}
+
 }  // namespace Ab
 
 #endif  // AB_VARUINT_HPP_
@@ -0,0 +1,256 @@
+#include <Ab/Config.hpp>
+#include <Ab/MemoryOps.hpp>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AB_MEMORYOPS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Ab {
+
+namespace {
+
+void generic_copy(void* dst, const void* src, std::size_t n) noexcept {
+	std::memmove(dst, src, n);
+}
+
+void generic_fill(void* dst, std::uint8_t value, std::size_t n) noexcept {
+	std::memset(dst, value, n);
+}
+
+constexpr MemoryKernels GENERIC_KERNELS = {&generic_copy, &generic_fill, "generic"};
+
+#ifdef AB_MEMORYOPS_AVX2
+
+#define AB_AVX2 __attribute__((target("avx2")))
+
+constexpr std::size_t VECTOR_SIZE = 32;
+
+/// Unroll factor of the main loops.
+///
+constexpr std::size_t BLOCK_SIZE = 4 * VECTOR_SIZE;
+
+std::size_t misalignment(const std::byte* p) noexcept {
+	return reinterpret_cast<std::uintptr_t>(p) % VECTOR_SIZE;
+}
+
+template <typename T>
+T load(const std::byte* p) noexcept {
+	T x;
+	std::memcpy(&x, p, sizeof(T));
+	return x;
+}
+
+template <typename T>
+void store(std::byte* p, T x) noexcept {
+	std::memcpy(p, &x, sizeof(T));
+}
+
+AB_AVX2 __m256i load_vector(const std::byte* p) noexcept {
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AB_AVX2 void store_vector(std::byte* p, __m256i x) noexcept {
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+}
+
+AB_AVX2 void store_aligned_vector(std::byte* p, __m256i x) noexcept {
+	_mm256_store_si256(reinterpret_cast<__m256i*>(p), x);
+}
+
+/// Copy the first and last T of a range, which together cover it. Both are loaded before
+/// either is stored, so the copy is correct for overlapping ranges.
+///
+template <typename T>
+void copy_ends(std::byte* d, const std::byte* s, std::size_t n) noexcept {
+	auto head = load<T>(s);
+	auto tail = load<T>(s + n - sizeof(T));
+	store<T>(d, head);
+	store<T>(d + n - sizeof(T), tail);
+}
+
+/// Copy fewer than 32 bytes.
+///
+AB_AVX2 void copy_small(std::byte* d, const std::byte* s, std::size_t n) noexcept {
+	if (n >= 16) {
+		auto head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+		auto tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + n - 16));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d), head);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + n - 16), tail);
+	} else if (n >= 8) {
+		copy_ends<std::uint64_t>(d, s, n);
+	} else if (n >= 4) {
+		copy_ends<std::uint32_t>(d, s, n);
+	} else if (n >= 2) {
+		copy_ends<std::uint16_t>(d, s, n);
+	} else if (n == 1) {
+		*d = *s;
+	}
+}
+
+/// Copy more than 64 bytes, front to back. Correct when the destination does not start inside
+/// the source. The unaligned first and last vectors are loaded up front, and stored last, so the
+/// loop only makes aligned stores.
+///
+AB_AVX2 void copy_forward(std::byte* d, const std::byte* s, std::size_t n) noexcept {
+	auto head = load_vector(s);
+	auto tail = load_vector(s + n - VECTOR_SIZE);
+
+	std::size_t skip   = VECTOR_SIZE - misalignment(d);
+	std::byte* p       = d + skip;
+	const std::byte* q = s + skip;
+	std::byte* end     = d + n - VECTOR_SIZE;
+
+	for (; p + BLOCK_SIZE <= end; p += BLOCK_SIZE, q += BLOCK_SIZE) {
+		auto x0 = load_vector(q);
+		auto x1 = load_vector(q + VECTOR_SIZE);
+		auto x2 = load_vector(q + 2 * VECTOR_SIZE);
+		auto x3 = load_vector(q + 3 * VECTOR_SIZE);
+		store_aligned_vector(p, x0);
+		store_aligned_vector(p + VECTOR_SIZE, x1);
+		store_aligned_vector(p + 2 * VECTOR_SIZE, x2);
+		store_aligned_vector(p + 3 * VECTOR_SIZE, x3);
+	}
+	for (; p < end; p += VECTOR_SIZE, q += VECTOR_SIZE) {
+		store_aligned_vector(p, load_vector(q));
+	}
+
+	store_vector(end, tail);
+	store_vector(d, head);
+}
+
+/// Copy more than 64 bytes, back to front. Correct when the destination starts inside the
+/// source.
+///
+AB_AVX2 void copy_backward(std::byte* d, const std::byte* s, std::size_t n) noexcept {
+	auto head = load_vector(s);
+	auto tail = load_vector(s + n - VECTOR_SIZE);
+
+	std::byte* e       = d + n;
+	std::size_t skip   = misalignment(e) != 0 ? misalignment(e) : VECTOR_SIZE;
+	std::byte* p       = e - skip;
+	const std::byte* q = s + n - skip;
+	std::byte* begin   = d + VECTOR_SIZE;
+
+	for (; p >= begin + BLOCK_SIZE; p -= BLOCK_SIZE, q -= BLOCK_SIZE) {
+		auto x0 = load_vector(q - VECTOR_SIZE);
+		auto x1 = load_vector(q - 2 * VECTOR_SIZE);
+		auto x2 = load_vector(q - 3 * VECTOR_SIZE);
+		auto x3 = load_vector(q - 4 * VECTOR_SIZE);
+		store_aligned_vector(p - VECTOR_SIZE, x0);
+		store_aligned_vector(p - 2 * VECTOR_SIZE, x1);
+		store_aligned_vector(p - 3 * VECTOR_SIZE, x2);
+		store_aligned_vector(p - 4 * VECTOR_SIZE, x3);
+	}
+	for (; p > begin; p -= VECTOR_SIZE, q -= VECTOR_SIZE) {
+		store_aligned_vector(p - VECTOR_SIZE, load_vector(q - VECTOR_SIZE));
+	}
+
+	store_vector(d, head);
+	store_vector(e - VECTOR_SIZE, tail);
+}
+
+AB_AVX2 void avx2_copy(void* dst, const void* src, std::size_t n) noexcept {
+	auto d = static_cast<std::byte*>(dst);
+	auto s = static_cast<const std::byte*>(src);
+
+	if (n < VECTOR_SIZE) {
+		copy_small(d, s, n);
+	} else if (n <= 2 * VECTOR_SIZE) {
+		auto head = load_vector(s);
+		auto tail = load_vector(s + n - VECTOR_SIZE);
+		store_vector(d, head);
+		store_vector(d + n - VECTOR_SIZE, tail);
+	} else if (std::uintptr_t(d) - std::uintptr_t(s) >= n) {
+		copy_forward(d, s, n);
+	} else {
+		copy_backward(d, s, n);
+	}
+}
+
+/// Fill the first and last T of a range, which together cover it.
+///
+template <typename T>
+void fill_ends(std::byte* d, std::uint8_t value, std::size_t n) noexcept {
+	T x = T(value * (std::numeric_limits<T>::max() / 0xff));
+	store<T>(d, x);
+	store<T>(d + n - sizeof(T), x);
+}
+
+/// Fill fewer than 32 bytes.
+///
+AB_AVX2 void fill_small(std::byte* d, std::uint8_t value, std::size_t n) noexcept {
+	if (n >= 16) {
+		auto x = _mm_set1_epi8(char(value));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d), x);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + n - 16), x);
+	} else if (n >= 8) {
+		fill_ends<std::uint64_t>(d, value, n);
+	} else if (n >= 4) {
+		fill_ends<std::uint32_t>(d, value, n);
+	} else if (n >= 2) {
+		fill_ends<std::uint16_t>(d, value, n);
+	} else if (n == 1) {
+		*d = std::byte(value);
+	}
+}
+
+AB_AVX2 void avx2_fill(void* dst, std::uint8_t value, std::size_t n) noexcept {
+	auto d = static_cast<std::byte*>(dst);
+
+	if (n < VECTOR_SIZE) {
+		fill_small(d, value, n);
+		return;
+	}
+
+	auto x         = _mm256_set1_epi8(char(value));
+	std::byte* end = d + n - VECTOR_SIZE;
+	store_vector(d, x);
+	store_vector(end, x);
+	if (n <= 2 * VECTOR_SIZE) {
+		return;
+	}
+
+	std::byte* p = d + VECTOR_SIZE - misalignment(d);
+	for (; p + BLOCK_SIZE <= end; p += BLOCK_SIZE) {
+		store_aligned_vector(p, x);
+		store_aligned_vector(p + VECTOR_SIZE, x);
+		store_aligned_vector(p + 2 * VECTOR_SIZE, x);
+		store_aligned_vector(p + 3 * VECTOR_SIZE, x);
+	}
+	for (; p < end; p += VECTOR_SIZE) {
+		store_aligned_vector(p, x);
+	}
+}
+
+constexpr MemoryKernels AVX2_KERNELS = {&avx2_copy, &avx2_fill, "avx2"};
+
+#endif  // AB_MEMORYOPS_AVX2
+
+}  // namespace
+
+const MemoryKernels& generic_memory_kernels() noexcept { return GENERIC_KERNELS; }
+
+const MemoryKernels* avx2_memory_kernels() noexcept {
+#ifdef AB_MEMORYOPS_AVX2
+	static const bool supported = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+	}();
+	return supported ? &AVX2_KERNELS : nullptr;
+#else
+	return nullptr;
+#endif
+}
+
+const MemoryKernels& memory_kernels() noexcept {
+	static const MemoryKernels& kernels = []() -> const MemoryKernels& {
+		auto avx2 = avx2_memory_kernels();
+		return avx2 != nullptr ? *avx2 : GENERIC_KERNELS;
+	}();
+	return kernels;
+}
+
+}  // namespace Ab
@@ -1,7 +1,17 @@
 #include <Ab/Process.hpp>
+#include <sys/syscall.h>
 
 namespace Ab {
 
 SystemProperties Process::properties_;
 
+int Process::numa_node() noexcept {
+	unsigned cpu  = 0;
+	unsigned node = 0;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+		return 0;
+	}
+	return int(node);
+}
+
 }  // namespace Ab
@@ -4,10 +4,8 @@
 
 namespace Ab {
 
-// TODO(rwy0717): Implement
 SharedLock::SharedLock() noexcept = default;
 
-// TODO(rwy0717): Implement
 SharedLock::~SharedLock() noexcept = default;
 
 auto SharedLock::init() noexcept -> SharedLockError {
@@ -17,7 +15,73 @@ auto SharedLock::init() noexcept -> SharedLockError {
 
 auto SharedLock::kill() noexcept -> SharedLockError {
 	AB_TRACE();
+	if (isLocked<Access::EXCLUSIVE>() || isLocked<Access::SHARED>()) {
+		return SharedLockError::FAIL;
+	}
 	return SharedLockError::SUCCESS;
 }
 
+auto SharedLock::nextStripeIndex() noexcept -> std::size_t {
+	static std::atomic<std::size_t> next{0};
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto SharedLock::lockSharedSlow(Stripe& stripe) noexcept -> void {
+	do {
+		releaseReader(stripe);
+		waitForWriter();
+		stripe.readers.fetch_add(1, std::memory_order_seq_cst);
+	} while (writer_.load(std::memory_order_seq_cst) != UNLOCKED);
+}
+
+auto SharedLock::lockExclusiveSlow() noexcept -> void {
+	for (unsigned int i = 0; i < SPIN_COUNT; ++i) {
+		std::uint32_t expected = UNLOCKED;
+		if (writer_.load(std::memory_order_relaxed) == UNLOCKED &&
+			writer_.compare_exchange_weak(expected, LOCKED, std::memory_order_seq_cst)) {
+			return;
+		}
+		cpu_relax();
+	}
+
+	// Mark the word as contended, so the holder wakes us on release. We may win the lock here,
+	// in which case the word is left CONTENDED, and the next release will wake anyone else.
+	while (writer_.exchange(CONTENDED, std::memory_order_seq_cst) != UNLOCKED) {
+		futex_wait(&writer_, CONTENDED);
+	}
+}
+
+auto SharedLock::waitForWriter() noexcept -> void {
+	for (unsigned int i = 0; i < SPIN_COUNT; ++i) {
+		if (writer_.load(std::memory_order_seq_cst) == UNLOCKED) {
+			return;
+		}
+		cpu_relax();
+	}
+
+	std::uint32_t w = writer_.load(std::memory_order_seq_cst);
+	while (w != UNLOCKED) {
+		if (w == CONTENDED ||
+			writer_.compare_exchange_weak(w, CONTENDED, std::memory_order_seq_cst)) {
+			futex_wait(&writer_, CONTENDED);
+		}
+		w = writer_.load(std::memory_order_seq_cst);
+	}
+}
+
+auto SharedLock::waitForReaders() noexcept -> void {
+	for (auto& s : stripes_) {
+		unsigned int spins = 0;
+		for (auto n = s.readers.load(std::memory_order_seq_cst); n != 0;
+			 n          = s.readers.load(std::memory_order_seq_cst)) {
+			if (spins < SPIN_COUNT) {
+				++spins;
+				cpu_relax();
+			} else {
+				futex_wait(&s.readers, n);
+			}
+		}
+	}
+}
+
 }  // namespace Ab
@@ -0,0 +1,192 @@
+#include <Ab/Config.hpp>
+#include <Ab/Assert.hpp>
+#include <Ab/SlabAllocator.hpp>
+
+namespace Ab {
+
+namespace {
+
+/// Size classes, indexed by size in units of the alignment, rounded up.
+///
+constexpr auto CLASS_TABLE = [] {
+	std::array<std::uint8_t, SlabAllocator::MAX_SMALL_SIZE / SlabAllocator::ALIGNMENT + 1> table{};
+	for (std::size_t i = 0; i < table.size(); ++i) {
+		table[i] = std::uint8_t(SlabAllocator::size_class(i * SlabAllocator::ALIGNMENT));
+	}
+	return table;
+}();
+
+/// Allocator tokens start at one, so a zeroed cache belongs to no allocator.
+///
+std::uint64_t next_token() noexcept {
+	static std::atomic<std::uint64_t> next{1};
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::byte* align_up(std::byte* p, std::size_t alignment) noexcept {
+	auto address = reinterpret_cast<std::uintptr_t>(p);
+	return p + ((alignment - (address % alignment)) % alignment);
+}
+
+bool is_pow2(std::size_t x) noexcept { return x != 0 && (x & (x - 1)) == 0; }
+
+}  // namespace
+
+/// The objects a thread holds for one allocator. A size class is served from the free list
+/// first, then by bumping through the remains of the last run.
+///
+struct SlabAllocator::ThreadCache {
+	struct FreeObject {
+		FreeObject* next;
+	};
+
+	struct SizeClass {
+		FreeObject* free  = nullptr;
+		std::byte* cursor = nullptr;
+		std::byte* limit  = nullptr;
+	};
+
+	std::uint64_t token = 0;
+	std::array<SizeClass, CLASS_COUNT> classes{};
+};
+
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= SlabAllocator::ALIGNMENT);
+
+SlabAllocator::SlabAllocator(std::size_t slab_size) : slab_size_(slab_size), token_(next_token()) {
+	AB_ASSERT(slab_size_ >= RUN_SIZE);
+}
+
+SlabAllocator::~SlabAllocator() noexcept { release(); }
+
+void* SlabAllocator::allocate(std::size_t size, std::size_t alignment) {
+	AB_ASSERT(is_pow2(alignment));
+	if (size > MAX_SMALL_SIZE || alignment > ALIGNMENT) {
+		return allocate_large(size, alignment);
+	}
+
+	auto cls    = CLASS_TABLE[(size + ALIGNMENT - 1) / ALIGNMENT];
+	auto& cache = this->cache();
+	auto& entry = cache.classes[cls];
+	if (entry.free != nullptr) {
+		auto object = entry.free;
+		entry.free  = object->next;
+		return object;
+	}
+	if (entry.cursor != entry.limit) {
+		auto object = entry.cursor;
+		entry.cursor += SIZE_CLASSES[cls];
+		return object;
+	}
+	return refill(cache, cls);
+}
+
+void SlabAllocator::deallocate(void* p, std::size_t size, std::size_t alignment) noexcept {
+	if (p == nullptr || size > MAX_SMALL_SIZE || alignment > ALIGNMENT) {
+		return;
+	}
+	auto cls     = CLASS_TABLE[(size + ALIGNMENT - 1) / ALIGNMENT];
+	auto& entry  = cache().classes[cls];
+	auto object  = static_cast<ThreadCache::FreeObject*>(p);
+	object->next = entry.free;
+	entry.free   = object;
+}
+
+void SlabAllocator::reset() noexcept {
+	std::lock_guard<std::mutex> guard(lock_);
+	free_large_blocks();
+	next_slab_ = 0;
+	cursor_    = nullptr;
+	limit_     = nullptr;
+	// Orphan every thread's cache. Stale caches are dropped on their thread's next use.
+	token_.store(next_token(), std::memory_order_relaxed);
+}
+
+void SlabAllocator::release() noexcept {
+	reset();
+	std::lock_guard<std::mutex> guard(lock_);
+	for (auto slab : slabs_) {
+		::operator delete(slab);
+	}
+	slabs_.clear();
+}
+
+std::size_t SlabAllocator::reserved_bytes() const noexcept {
+	std::lock_guard<std::mutex> guard(lock_);
+	std::size_t bytes = slabs_.size() * slab_size_;
+	for (const auto& block : large_blocks_) {
+		bytes += block.size;
+	}
+	return bytes;
+}
+
+auto SlabAllocator::cache() noexcept -> ThreadCache& {
+	// Constant initialized, so access needs no guard.
+	static thread_local std::array<ThreadCache, THREAD_CACHE_COUNT> thread_caches;
+	static thread_local std::size_t thread_cache_victim = 0;
+
+	auto token = token_.load(std::memory_order_relaxed);
+	for (auto& cache : thread_caches) {
+		if (cache.token == token) {
+			return cache;
+		}
+	}
+	auto& cache = thread_caches[thread_cache_victim++ % THREAD_CACHE_COUNT];
+	cache       = ThreadCache();
+	cache.token = token;
+	return cache;
+}
+
+void* SlabAllocator::refill(ThreadCache& cache, std::size_t cls) {
+	auto size  = SIZE_CLASSES[cls];
+	auto count = RUN_SIZE / size;
+	std::byte* run;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		run = bump(count * size, ALIGNMENT);
+	}
+	auto& entry  = cache.classes[cls];
+	entry.cursor = run + size;
+	entry.limit  = run + count * size;
+	return run;
+}
+
+void* SlabAllocator::allocate_large(std::size_t size, std::size_t alignment) {
+	AB_ASSERT(is_pow2(alignment));
+	if (size + alignment <= slab_size_ / 4) {
+		std::lock_guard<std::mutex> guard(lock_);
+		return bump(size, alignment);
+	}
+	auto address = ::operator new(size, std::align_val_t(alignment));
+	std::lock_guard<std::mutex> guard(lock_);
+	try {
+		large_blocks_.push_back({address, size, alignment});
+	} catch (...) {
+		::operator delete(address, std::align_val_t(alignment));
+		throw;
+	}
+	return address;
+}
+
+std::byte* SlabAllocator::bump(std::size_t size, std::size_t alignment) {
+	auto p = align_up(cursor_, alignment);
+	if (cursor_ == nullptr || p > limit_ || size > std::size_t(limit_ - p)) {
+		if (next_slab_ == slabs_.size()) {
+			slabs_.reserve(slabs_.size() + 1);
+			slabs_.push_back(static_cast<std::byte*>(::operator new(slab_size_)));
+		}
+		cursor_ = slabs_[next_slab_++];
+		limit_  = cursor_ + slab_size_;
+		p       = align_up(cursor_, alignment);
+	}
+	cursor_ = p + size;
+	return p;
+}
+
+void SlabAllocator::free_large_blocks() noexcept {
+	for (const auto& block : large_blocks_) {
+		::operator delete(block.address, std::align_val_t(block.alignment));
+	}
+	large_blocks_.clear();
+}
+
+}  // namespace Ab
@@ -0,0 +1,108 @@
+#include <Ab/Config.hpp>
+#include <Ab/MemoryOps.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace Ab;
+
+namespace {
+
+constexpr std::size_t BUFFER_SIZE = 16384;
+
+/// Every kernel available on this machine.
+///
+std::vector<const MemoryKernels*> kernels() {
+	std::vector<const MemoryKernels*> result = {&generic_memory_kernels()};
+	if (avx2_memory_kernels() != nullptr) {
+		result.push_back(avx2_memory_kernels());
+	}
+	return result;
+}
+
+std::vector<std::uint8_t> pattern() {
+	std::vector<std::uint8_t> buffer(BUFFER_SIZE);
+	for (std::size_t i = 0; i < buffer.size(); ++i) {
+		buffer[i] = std::uint8_t(i * 7 + i / 251);
+	}
+	return buffer;
+}
+
+const std::size_t SIZES[] = {0,  1,  2,  3,  4,   5,   7,   8,   9,   15,   16,  17,
+							 31, 32, 33, 63, 64,  65,  127, 128, 129, 200, 255, 256,
+							 257, 511, 1000, 4096, 4099};
+
+/// Copy `n` bytes between two offsets of one buffer, and check against memmove.
+///
+void check_copy(const MemoryKernels& kernel, std::size_t dst, std::size_t src, std::size_t n) {
+	auto expected = pattern();
+	auto actual   = expected;
+	std::memmove(expected.data() + dst, expected.data() + src, n);
+	kernel.copy(actual.data() + dst, actual.data() + src, n);
+	ASSERT_EQ(actual, expected) << kernel.name << ": dst=" << dst << " src=" << src
+								<< " n=" << n;
+}
+
+void check_fill(const MemoryKernels& kernel, std::size_t dst, std::uint8_t value, std::size_t n) {
+	auto expected = pattern();
+	auto actual   = expected;
+	std::memset(expected.data() + dst, value, n);
+	kernel.fill(actual.data() + dst, value, n);
+	ASSERT_EQ(actual, expected) << kernel.name << ": dst=" << dst << " n=" << n;
+}
+
+}  // namespace
+
+TEST(MemoryOps, SelectedKernelIsAvailable) {
+	auto& selected = memory_kernels();
+	if (avx2_memory_kernels() != nullptr) {
+		EXPECT_EQ(&selected, avx2_memory_kernels());
+	} else {
+		EXPECT_EQ(&selected, &generic_memory_kernels());
+	}
+}
+
+TEST(MemoryOps, CopyDisjoint) {
+	for (auto kernel : kernels()) {
+		for (auto n : SIZES) {
+			for (std::size_t misalign = 0; misalign < 33; misalign += 3) {
+				check_copy(*kernel, misalign, BUFFER_SIZE / 2 + 5, n);
+				check_copy(*kernel, BUFFER_SIZE / 2 + misalign, 1, n);
+			}
+		}
+	}
+}
+
+TEST(MemoryOps, CopyOverlapping) {
+	for (auto kernel : kernels()) {
+		for (auto n : SIZES) {
+			for (std::size_t distance : {1, 2, 7, 31, 32, 33, 64, 100}) {
+				check_copy(*kernel, 40 + distance, 40, n);
+				check_copy(*kernel, 40, 40 + distance, n);
+			}
+			check_copy(*kernel, 40, 40, n);
+		}
+	}
+}
+
+TEST(MemoryOps, Fill) {
+	for (auto kernel : kernels()) {
+		for (auto n : SIZES) {
+			for (std::size_t misalign = 0; misalign < 33; misalign += 5) {
+				check_fill(*kernel, misalign, 0xa5, n);
+			}
+			check_fill(*kernel, 3, 0, n);
+		}
+	}
+}
+
+TEST(MemoryOps, Helpers) {
+	std::uint8_t buffer[100] = {};
+	fill_bytes(buffer, 9, 50);
+	copy_bytes(buffer + 25, buffer, 50);
+	for (std::size_t i = 0; i < 75; ++i) {
+		EXPECT_EQ(buffer[i], 9);
+	}
+	EXPECT_EQ(buffer[75], 0);
+}
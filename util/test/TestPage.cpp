@@ -14,3 +14,11 @@ TEST(page, map_one_page) {
 	EXPECT_NE(addr, nullptr);
 	Page::unmap(addr, size);
 }
+
+TEST(page, map_aligned) {
+	auto size = 3 * Page::size();
+	auto addr = Page::map_aligned(nullptr, size, Page::HUGE_SIZE, PagePermission::READ);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(addr) % Page::HUGE_SIZE, 0);
+	EXPECT_EQ(*addr, Byte(0));
+	Page::unmap(addr, size);
+}
@@ -1,6 +1,8 @@
 #include <Ab/Config.hpp>
 #include <Ab/LockGuard.hpp>
 #include <Ab/SharedLock.hpp>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 
 using namespace Ab;
@@ -11,13 +13,20 @@ TEST(SharedLock, multipleShared) {
 	EXPECT_TRUE(trySharedLock(lock));
 }
 
-TEST(SharedLock, DISABLED_failToTakeExclusive) {
+TEST(SharedLock, failToTakeExclusive) {
 	SharedLock lock;
 	SharedLockGuard<SharedLock> shared(lock);
 	EXPECT_FALSE(tryExclusiveLock(lock));
 }
 
-TEST(SharedLock, DISABLED_exclusiveThenShared) {
+TEST(SharedLock, failToTakeShared) {
+	SharedLock lock;
+	ExclusiveLockGuard<SharedLock> exclusive(lock);
+	EXPECT_FALSE(trySharedLock(lock));
+	EXPECT_FALSE(tryExclusiveLock(lock));
+}
+
+TEST(SharedLock, exclusiveThenShared) {
 	SharedLock lock;
 	{
 		ExclusiveLockGuard<SharedLock> exclusive(lock);
@@ -29,4 +38,57 @@ TEST(SharedLock, DISABLED_exclusiveThenShared) {
 		EXPECT_TRUE(lock.isLocked<Access::SHARED>());
 	}
 	EXPECT_FALSE(lock.isLocked<Access::SHARED>());
+	EXPECT_EQ(lock.kill(), SharedLockError::SUCCESS);
+}
+
+TEST(SharedLock, moveGuard) {
+	SharedLock lock;
+	{
+		auto guard = exclusiveLock(lock);
+		auto moved = std::move(guard);
+		EXPECT_TRUE(lock.isLocked<Access::EXCLUSIVE>());
+	}
+	EXPECT_FALSE(lock.isLocked<Access::EXCLUSIVE>());
+}
+
+TEST(SharedLock, readersAndWriters) {
+	constexpr int NREADERS   = 8;
+	constexpr int NWRITERS   = 2;
+	constexpr int ITERATIONS = 5000;
+
+	SharedLock lock;
+	// Writers keep both values equal. Readers must never see them differ.
+	long a = 0;
+	long b = 0;
+	std::atomic<int> torn{0};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < NWRITERS; ++i) {
+		threads.emplace_back([&] {
+			for (int j = 0; j < ITERATIONS; ++j) {
+				ExclusiveLockGuard<SharedLock> guard(lock);
+				++a;
+				++b;
+			}
+		});
+	}
+	for (int i = 0; i < NREADERS; ++i) {
+		threads.emplace_back([&] {
+			for (int j = 0; j < ITERATIONS; ++j) {
+				SharedLockGuard<SharedLock> guard(lock);
+				if (a != b) {
+					++torn;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(torn, 0);
+	EXPECT_EQ(a, NWRITERS * ITERATIONS);
+	EXPECT_EQ(b, NWRITERS * ITERATIONS);
+	EXPECT_FALSE(lock.isLocked<Access::SHARED>());
+	EXPECT_FALSE(lock.isLocked<Access::EXCLUSIVE>());
 }
@@ -0,0 +1,161 @@
+#include <Ab/Config.hpp>
+#include <Ab/SlabAllocator.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace Ab;
+
+namespace {
+
+bool is_aligned(void* p, std::size_t alignment) {
+	return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+struct Point {
+	Point(int x, int y) : x(x), y(y) {}
+
+	int x;
+	int y;
+};
+
+}  // namespace
+
+TEST(SlabAllocator, sizeClasses) {
+	EXPECT_EQ(SlabAllocator::size_class(0), 0);
+	EXPECT_EQ(SlabAllocator::size_class(1), 0);
+	EXPECT_EQ(SlabAllocator::size_class(16), 0);
+	EXPECT_EQ(SlabAllocator::size_class(17), 1);
+	EXPECT_EQ(SlabAllocator::size_class(1024), SlabAllocator::CLASS_COUNT - 1);
+}
+
+TEST(SlabAllocator, allocateDistinctAlignedMemory) {
+	SlabAllocator slab;
+	std::set<void*> seen;
+	for (std::size_t size = 1; size <= 2048; size += 7) {
+		auto p = slab.allocate(size);
+		EXPECT_TRUE(is_aligned(p, SlabAllocator::ALIGNMENT));
+		EXPECT_TRUE(seen.insert(p).second);
+		std::memset(p, 0xAB, size);
+	}
+}
+
+TEST(SlabAllocator, overAligned) {
+	SlabAllocator slab;
+	for (std::size_t alignment : {32, 64, 4096}) {
+		auto p = slab.allocate(8, alignment);
+		EXPECT_TRUE(is_aligned(p, alignment));
+	}
+}
+
+TEST(SlabAllocator, reuseFreedObject) {
+	SlabAllocator slab;
+	auto a = slab.allocate(40);
+	slab.deallocate(a, 40);
+	// 40 and 48 bytes share a size class.
+	EXPECT_EQ(slab.allocate(48), a);
+	EXPECT_NE(slab.allocate(48), a);
+}
+
+TEST(SlabAllocator, largeBlocks) {
+	SlabAllocator slab;
+	auto p = slab.allocate(slab.slab_size() * 2);
+	std::memset(p, 0, slab.slab_size() * 2);
+	EXPECT_EQ(slab.reserved_bytes(), slab.slab_size() * 2);
+	slab.reset();
+	EXPECT_EQ(slab.reserved_bytes(), 0);
+}
+
+TEST(SlabAllocator, resetReusesSlabs) {
+	SlabAllocator slab;
+	for (int i = 0; i < 10000; ++i) {
+		slab.allocate(64);
+	}
+	auto reserved = slab.reserved_bytes();
+	EXPECT_GT(reserved, 0);
+
+	slab.reset();
+	for (int i = 0; i < 10000; ++i) {
+		slab.allocate(64);
+	}
+	EXPECT_EQ(slab.reserved_bytes(), reserved);
+
+	slab.release();
+	EXPECT_EQ(slab.reserved_bytes(), 0);
+}
+
+TEST(SlabAllocator, make) {
+	SlabAllocator slab;
+	auto p = slab.make<Point>(1, 2);
+	EXPECT_EQ(p->x, 1);
+	EXPECT_EQ(p->y, 2);
+
+	auto array = slab.allocate_array<std::uint64_t>(100);
+	EXPECT_TRUE(is_aligned(array, alignof(std::uint64_t)));
+	array[99] = 5;
+}
+
+TEST(SlabAllocator, manyAllocators) {
+	// More allocators than a thread caches at once.
+	std::vector<std::unique_ptr<SlabAllocator>> slabs;
+	for (std::size_t i = 0; i < SlabAllocator::THREAD_CACHE_COUNT * 2; ++i) {
+		slabs.push_back(std::make_unique<SlabAllocator>());
+	}
+	std::set<void*> seen;
+	for (int round = 0; round < 3; ++round) {
+		for (auto& slab : slabs) {
+			EXPECT_TRUE(seen.insert(slab->allocate(32)).second);
+		}
+	}
+}
+
+TEST(SlabAllocator, threads) {
+	constexpr std::size_t THREAD_COUNT = 4;
+	constexpr std::size_t OBJECT_COUNT = 10000;
+
+	SlabAllocator slab;
+	std::vector<std::vector<std::uint64_t*>> objects(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (std::size_t t = 0; t < THREAD_COUNT; ++t) {
+		threads.emplace_back([&, t] {
+			for (std::size_t i = 0; i < OBJECT_COUNT; ++i) {
+				auto p = slab.allocate_array<std::uint64_t>(1 + i % 16);
+				*p     = t * OBJECT_COUNT + i;
+				objects[t].push_back(p);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	for (std::size_t t = 0; t < THREAD_COUNT; ++t) {
+		for (std::size_t i = 0; i < OBJECT_COUNT; ++i) {
+			EXPECT_EQ(*objects[t][i], t * OBJECT_COUNT + i);
+		}
+	}
+}
+
+TEST(SlabResource, containers) {
+	SlabAllocator slab;
+	SlabResource resource(&slab);
+	{
+		std::pmr::vector<int> v(&resource);
+		for (int i = 0; i < 1000; ++i) {
+			v.push_back(i);
+		}
+		EXPECT_EQ(v[999], 999);
+
+		std::pmr::string s("a string which does not fit in the small buffer", &resource);
+		EXPECT_EQ(s.size(), 47);
+	}
+	EXPECT_GT(slab.reserved_bytes(), 0);
+
+	SlabResource other(&slab);
+	EXPECT_TRUE(resource.is_equal(other));
+	EXPECT_FALSE(resource.is_equal(*std::pmr::new_delete_resource()));
+}
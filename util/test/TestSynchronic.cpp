@@ -0,0 +1,76 @@
+#include <Ab/Config.hpp>
+#include <Ab/Synchronic.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace Ab;
+
+TEST(Synchronic, waitReturnsImmediately) {
+	Synchronic<int> s(1);
+	s.wait(0, WaitHint::OPTIMIZE_LATENCY);
+	s.wait(0, WaitHint::OPTIMIZE_UTILIZATION);
+	EXPECT_EQ(s.load(), 1);
+}
+
+TEST(Synchronic, notifyOne) {
+	for (auto hint : {WaitHint::OPTIMIZE_LATENCY, WaitHint::OPTIMIZE_UTILIZATION}) {
+		Synchronic<int> s(0);
+		std::thread waiter([&] { s.wait(0, hint); });
+		s.store(1);
+		s.notify_one();
+		waiter.join();
+		EXPECT_EQ(s.load(), 1);
+	}
+}
+
+TEST(Synchronic, waitUntil) {
+	for (auto hint : {WaitHint::OPTIMIZE_LATENCY, WaitHint::OPTIMIZE_UTILIZATION}) {
+		Synchronic<int> s(0);
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+		EXPECT_FALSE(s.wait_until(0, deadline, hint));
+		EXPECT_GE(std::chrono::steady_clock::now(), deadline);
+
+		std::thread waiter([&] {
+			EXPECT_TRUE(s.wait_until(0, deadline + std::chrono::hours(1), hint));
+		});
+		s.store(1);
+		s.notify_one();
+		waiter.join();
+	}
+}
+
+TEST(Synchronic, notifyAll) {
+	constexpr int NTHREADS = 8;
+	Synchronic<std::uint64_t> s(0);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < NTHREADS; ++i) {
+		threads.emplace_back([&] { s.wait(0, WaitHint::OPTIMIZE_UTILIZATION); });
+	}
+	s.store(0xFFFFFFFF00000000);
+	s.notify_all();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(s.load(), 0xFFFFFFFF00000000);
+}
+
+TEST(Synchronic, pingPong) {
+	constexpr int ROUNDS = 1000;
+	Synchronic<int> turn(0);
+	std::thread other([&] {
+		for (int i = 0; i < ROUNDS; ++i) {
+			turn.wait(0, WaitHint::OPTIMIZE_UTILIZATION);
+			turn.store(0);
+			turn.notify_one();
+		}
+	});
+	for (int i = 0; i < ROUNDS; ++i) {
+		turn.store(1);
+		turn.notify_one();
+		turn.wait(1, WaitHint::OPTIMIZE_UTILIZATION);
+	}
+	other.join();
+	EXPECT_EQ(turn.load(), 0);
+}